@@ -0,0 +1,177 @@
+"""
+Audio buffering for SONU
+Single-producer/single-consumer PCM ring buffer shared by the capture and inference threads
+"""
+
+import threading
+
+import numpy as np
+
+INT16_SCALE = 1.0 / 32768.0
+
+
+class PcmRingBuffer:
+    """Fixed-size float32 ring of captured audio with cheap tail views.
+
+    The capture thread is the only writer and the inference/command threads
+    only read, so sample writes need no lock: the writer fills the slots and
+    then publishes the new total, readers snapshot the total first.
+
+    Every sample is stored twice (at ``i`` and ``i + capacity``), which makes
+    any window of up to ``capacity`` samples a contiguous slice of the backing
+    array - tail views are numpy views, never copies.
+
+    With ``spill`` enabled, samples of the current recording that are about to
+    be overwritten are moved into a growable arena first, so the full
+    recording can still be reconstructed for long toggle-mode dictation. The
+    arena and the scratch buffer keep their capacity between recordings.
+
+    The ring may keep filling between recordings (pre-roll); a recording is
+    the window between ``mark_start`` and ``mark_stop``, and ``mark_start``
+    can reach back into the history captured before it was called.
+    """
+
+    def __init__(self, seconds, rate, spill=True, headroom_seconds=1.0):
+        self.rate = rate
+        self.capacity = int(seconds * rate)
+        self.spill = spill
+        # Never hand out views this close to the write head: the writer may be
+        # lapping them while a slow decode still reads the samples
+        self.headroom = min(int(headroom_seconds * rate), self.capacity // 2)
+        self._data = np.zeros(self.capacity * 2, dtype=np.float32)
+        self._written = 0  # absolute number of samples ever written
+        self._start = 0  # absolute index where the current recording begins
+        self._end = 0  # absolute index where it ended, None while recording
+        self._spilled = 0  # absolute index up to which the recording lives in the arena
+        self._arena = np.zeros(0, dtype=np.float32)
+        self._arena_len = 0
+        self._scratch = np.zeros(0, dtype=np.float32)
+        # Guards recording bookkeeping (start mark and arena) only; sample writes are lock-free
+        self._meta_lock = threading.Lock()
+
+    def write_int16(self, data):
+        """Append raw little-endian int16 PCM. Called from the capture thread only."""
+        samples = np.frombuffer(data, dtype=np.int16)
+        if samples.size > self.capacity:
+            samples = samples[-self.capacity:]
+        n = samples.size
+        if n == 0:
+            return
+        pos = self._written
+        overwrite_end = pos + n - self.capacity
+        end_mark = self._end
+        if self.spill and overwrite_end > self._spilled and (end_mark is None or self._spilled < end_mark):
+            with self._meta_lock:
+                begin = max(self._spilled, self._start)
+                stop = overwrite_end if self._end is None else min(overwrite_end, self._end)
+                if stop > begin:
+                    self._arena_append(self._span(begin, stop))
+                    self._spilled = stop
+
+        cap = self.capacity
+        idx = pos % cap
+        end = idx + n
+        np.multiply(samples, INT16_SCALE, out=self._data[idx:end], casting='unsafe')
+        if end <= cap:
+            self._data[idx + cap:end + cap] = self._data[idx:end]
+        else:
+            self._data[idx + cap:] = self._data[idx:cap]
+            self._data[:end - cap] = self._data[cap:end]
+        # Publish only after the samples are in place
+        self._written = pos + n
+
+    @property
+    def written(self):
+        return self._written
+
+    def mark_start(self, backfill=0):
+        """Begin a new recording at the write head, optionally reaching back ``backfill`` samples."""
+        with self._meta_lock:
+            written = self._written
+            backfill = max(0, min(int(backfill), written, self.capacity - self.headroom))
+            self._start = written - backfill
+            self._end = None
+            self._spilled = self._start
+            self._arena_len = 0
+
+    def mark_stop(self):
+        """End the current recording; later writes only feed the pre-roll history."""
+        with self._meta_lock:
+            if self._end is None:
+                self._end = self._written
+
+    def _limit(self):
+        end = self._end
+        return self._written if end is None else end
+
+    def recording_length(self):
+        return self._limit() - self._start
+
+    def tail(self, seconds):
+        """Contiguous view of the last ``seconds`` of the current recording."""
+        limit = self._limit()
+        count = min(int(seconds * self.rate), limit - self._start,
+                    self.capacity - self.headroom - (self._written - limit))
+        if count <= 0:
+            return self._data[:0]
+        return self._span(limit - count, limit)
+
+    @property
+    def recording_start(self):
+        return self._start
+
+    def span_since(self, begin):
+        """The current recording from absolute index ``begin`` on, and the index it really starts at.
+
+        A view while that part is still in the ring, otherwise sliced from ``recording()``.
+        """
+        begin = max(begin, self._start)
+        limit = self._limit()
+        if begin >= limit:
+            return self._data[:0], begin
+        if limit - begin <= self.capacity - self.headroom - (self._written - limit):
+            return self._span(begin, limit), begin
+        return self.recording()[begin - self._start:], begin
+
+    def recording(self):
+        """The whole current recording as one contiguous float32 array.
+
+        Recordings that use at most half the ring are returned as a view -
+        the other half is slack for pre-roll writes that continue while the
+        decoder reads it. Longer ones are assembled from the arena and the
+        ring into a reused scratch buffer (a single copy, at most once per
+        utterance). Meant to be called once capture for the utterance has
+        stopped.
+        """
+        with self._meta_lock:
+            limit = self._limit()
+            if not self.spill or self._spilled <= self._start:
+                begin = max(self._start, self._written - self.capacity)
+                if limit <= begin:
+                    return self._data[:0]
+                if limit - begin <= self.capacity // 2:
+                    return self._span(begin, limit)
+                ring_part = self._span(begin, limit)
+                arena_len = 0
+            else:
+                ring_part = self._span(self._spilled, limit)
+                arena_len = self._arena_len
+            total = arena_len + ring_part.size
+            if self._scratch.size < total:
+                self._scratch = np.zeros(max(total, self._scratch.size * 2), dtype=np.float32)
+            self._scratch[:arena_len] = self._arena[:arena_len]
+            self._scratch[arena_len:total] = ring_part
+            return self._scratch[:total]
+
+    def _span(self, begin, end):
+        i = begin % self.capacity
+        return self._data[i:i + (end - begin)]
+
+    def _arena_append(self, samples):
+        end = self._arena_len + samples.size
+        if end > self._arena.size:
+            grown = np.zeros(max(end, self._arena.size * 2, self.capacity), dtype=np.float32)
+            grown[:self._arena_len] = self._arena[:self._arena_len]
+            self._arena = grown
+        self._arena[self._arena_len:end] = samples
+        self._arena_len = end
@@ -0,0 +1,60 @@
+"""
+CPU budget for SONU
+Thread counts and CPU affinity that main.js assigns to each service (src/cpu_budget.js),
+applied by the service itself at startup
+"""
+
+import os
+import sys
+
+
+def parse_cpu_list(spec):
+    """``"1-3,6"`` -> ``{1, 2, 3, 6}``; empty or malformed specs give an empty set."""
+    cpus = set()
+    for part in (spec or "").split(","):
+        part = part.strip()
+        if not part:
+            continue
+        try:
+            if "-" in part:
+                first, last = (int(x) for x in part.split("-", 1))
+                cpus.update(range(first, last + 1))
+            else:
+                cpus.add(int(part))
+        except ValueError:
+            return set()
+    return cpus
+
+
+def thread_budget(var, default=0):
+    """Thread count from the environment; 0 means the library's own default."""
+    try:
+        return max(0, int(os.environ.get(var, default)))
+    except ValueError:
+        return default
+
+
+def capped_threads(requested, budget):
+    """``requested`` threads, but never more than a non-zero ``budget``."""
+    if not budget:
+        return requested
+    if not requested:
+        return budget
+    return min(requested, budget)
+
+
+def apply_affinity(var="SONU_CPU_AFFINITY"):
+    """Pin this process to the CPUs in ``var`` (Linux only); returns the set applied."""
+    cpus = parse_cpu_list(os.environ.get(var))
+    if not cpus or not hasattr(os, "sched_setaffinity"):
+        return set()
+    try:
+        available = os.sched_getaffinity(0)
+        cpus &= available
+        if cpus:
+            os.sched_setaffinity(0, cpus)
+        return cpus
+    except OSError as e:
+        sys.stderr.write(f"CPU affinity not applied: {e}\n")
+        sys.stderr.flush()
+        return set()
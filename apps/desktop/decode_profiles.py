@@ -0,0 +1,117 @@
+"""
+Decode profiles for SONU
+Named faster-whisper settings for partials and finals, plus a governor that sizes
+partial decodes to the real-time factor measured on this machine
+"""
+
+import threading
+
+DECODE_PROFILES = {
+    # Final text: full beam search, silence trimmed by VAD
+    "accurate": {
+        "beam_size": 5,
+        "best_of": 5,
+        "temperature": 0,
+        "vad_filter": True,
+        "vad_parameters": {"min_silence_duration_ms": 500},
+    },
+    "balanced": {
+        "beam_size": 3,
+        "best_of": 3,
+        "temperature": 0,
+        "vad_filter": True,
+        "vad_parameters": {"min_silence_duration_ms": 500},
+    },
+    # Live preview: greedy decode, no VAD pass
+    "fast": {
+        "beam_size": 1,
+        "best_of": 1,
+        "temperature": 0,
+        "vad_filter": False,
+    },
+}
+
+DEFAULT_PROFILES = {"partial": "balanced", "final": "accurate"}
+
+# Beam widths the governor may pick for partials, widest first
+GOVERNOR_BEAMS = (5, 3, 2, 1)
+
+
+def beam_cost(beam):
+    """Rough decode cost of a beam width relative to greedy decoding."""
+    return 1.0 + 0.3 * (beam - 1)
+
+
+class LatencyGovernor:
+    """Picks the partial beam width and cadence from the measured real-time factor.
+
+    Every partial decode reports its audio length and wall time. The governor
+    keeps a moving average of the greedy-equivalent RTF (decode seconds per
+    audio second, divided by ``beam_cost``) and then chooses:
+
+    - the widest beam whose predicted decode of ``window_seconds`` of audio
+      fits in ``budget`` of the cadence, never wider than the profile's beam;
+    - a cadence (``base_cadence`` or slower) long enough that partials occupy
+      at most ``budget`` of the worker, so they keep up with speech and leave
+      room for the final.
+
+    Finals are never governed.
+    """
+
+    def __init__(self, window_seconds=5.0, base_cadence=1.2, max_cadence=3.0,
+                 budget=0.6, smoothing=0.3):
+        self.window_seconds = window_seconds
+        self.max_cadence = max_cadence
+        self.base_cadence = base_cadence
+        self.budget = budget
+        self.smoothing = smoothing
+        self.enabled = True
+        self._rtf = None  # greedy-equivalent real-time factor
+        self._lock = threading.Lock()
+
+    def observe(self, audio_seconds, decode_seconds, beam):
+        if audio_seconds <= 0:
+            return
+        sample = decode_seconds / audio_seconds / beam_cost(beam)
+        with self._lock:
+            if self._rtf is None:
+                self._rtf = sample
+            else:
+                self._rtf += self.smoothing * (sample - self._rtf)
+
+    @property
+    def rtf(self):
+        return self._rtf
+
+    def beam(self, ceiling):
+        """Beam width for the next partial, at most ``ceiling``."""
+        rtf = self._rtf
+        if not self.enabled or rtf is None:
+            return ceiling
+        allowed = self.budget * self.cadence()
+        for beam in GOVERNOR_BEAMS:
+            if beam <= ceiling and rtf * beam_cost(beam) * self.window_seconds <= allowed:
+                return beam
+        return 1
+
+    def cadence(self):
+        """Seconds between partial decodes."""
+        rtf = self._rtf
+        if not self.enabled or rtf is None:
+            return self.base_cadence
+        # Greedy decode of the window must fit in the budget share of one tick
+        needed = rtf * self.window_seconds / self.budget
+        return min(self.max_cadence, max(self.base_cadence, needed))
+
+    def reset(self):
+        with self._lock:
+            self._rtf = None
+
+
+def decode_options(profile, beam=None):
+    """faster-whisper keyword arguments for a profile, optionally with a narrower beam."""
+    options = dict(DECODE_PROFILES[profile])
+    if beam is not None and beam < options["beam_size"]:
+        options["beam_size"] = beam
+        options["best_of"] = min(options["best_of"], beam)
+    return options
@@ -0,0 +1,127 @@
+"""
+IPC protocol for SONU
+Messages between main.js and the Python services: length-prefixed JSON frames, with the
+legacy line protocol (PARTIAL: / EVENT: / bare final text) kept as a compatibility mode
+"""
+
+import json
+import os
+import struct
+import sys
+import threading
+import time
+
+# Frame = 4-byte big-endian body length + UTF-8 JSON body
+HEADER = struct.Struct(">I")
+MAX_FRAME_BYTES = 16 * 1024 * 1024
+
+
+def monotonic_ms():
+    """Monotonic clock in ms; only differences between values are meaningful."""
+    return round(time.monotonic() * 1000.0, 3)
+
+
+def encode_frame(message):
+    body = json.dumps(message, separators=(",", ":"), ensure_ascii=False).encode("utf-8")
+    return HEADER.pack(len(body)) + body
+
+
+def read_exactly(stream, size):
+    data = b""
+    while len(data) < size:
+        chunk = stream.read(size - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+
+def read_frame(stream):
+    """Next message from a binary stream, or None at EOF."""
+    header = read_exactly(stream, HEADER.size)
+    if header is None:
+        return None
+    (size,) = HEADER.unpack(header)
+    if size > MAX_FRAME_BYTES:
+        raise ValueError(f"Frame of {size} bytes exceeds limit")
+    body = read_exactly(stream, size)
+    if body is None:
+        return None
+    return json.loads(body.decode("utf-8"))
+
+
+def claim_stdout():
+    """Move fd 1 to a private descriptor for frames and point fd 1 and sys.stdout at stderr.
+
+    Anything else that writes to stdout - a stray print, ctranslate2, PortAudio or
+    llama.cpp logging from native code - would otherwise land between frames and
+    corrupt the stream for main.js.
+    """
+    sys.stdout.flush()
+    frames_fd = os.dup(1)
+    os.dup2(2, 1)
+    sys.stdout = sys.stderr
+    return os.fdopen(frames_fd, "wb")
+
+
+def format_arg(value):
+    return f"{value:.1f}" if isinstance(value, float) else str(value)
+
+
+class Channel:
+    """Service-to-Electron messages on stdout, one frame (or legacy line) per message.
+
+    Every frame carries ``type``, a per-process ``seq`` and a monotonic ``ts``
+    in ms; callers add request IDs, timestamps and segment metadata as extra
+    fields. In text mode only the legacy line is written and the extra fields
+    are dropped. A framed channel takes stdout for itself (``claim_stdout``)
+    unless given ``out``, a binary stream to write frames to.
+    """
+
+    def __init__(self, framed=False, out=None):
+        self.framed = framed
+        self._out = out
+        if framed and out is None:
+            self._out = claim_stdout()
+        self._lock = threading.Lock()
+        self._seq = 0
+
+    def send(self, msg_type, legacy=None, **fields):
+        with self._lock:
+            self._seq += 1
+            if self.framed:
+                message = {"type": msg_type, "seq": self._seq, "ts": monotonic_ms()}
+                message.update(fields)
+                self._out.write(encode_frame(message))
+                self._out.flush()
+            elif legacy is not None:
+                sys.stdout.write(legacy + "\n")
+                sys.stdout.flush()
+
+    def partial(self, text, **fields):
+        self.send("partial", "PARTIAL: " + text, text=text, **fields)
+
+    def final(self, text, **fields):
+        self.send("final", text, text=text, **fields)
+
+    def event(self, name, *args, **fields):
+        legacy = " ".join(["EVENT:", name] + [format_arg(a) for a in args])
+        self.send("event", legacy, name=name, args=list(args), **fields)
+
+
+def read_commands(framed, stdin=None):
+    """Yield ``(command_line, request_id)`` from stdin in either mode.
+
+    Framed commands look like ``{"id": 7, "cmd": "START 1712345678901"}``;
+    text-mode commands have no request ID.
+    """
+    stdin = stdin or sys.stdin
+    if not framed:
+        for line in stdin:
+            yield line, None
+        return
+    while True:
+        message = read_frame(stdin.buffer)
+        if message is None:
+            return
+        yield message.get("cmd", ""), message.get("id")
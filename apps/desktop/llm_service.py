@@ -8,6 +8,11 @@ import sys
 import os
 import json
 import time
+import threading
+from collections import OrderedDict
+
+from ipc_protocol import Channel, read_frame
+from cpu_budget import apply_affinity, thread_budget
 
 # Try to import llama-cpp-python
 try:
@@ -29,6 +34,16 @@ model = None
 model_ready = False
 model_path = None
 
+# "framed": ID-tagged JSON frames with a bounded queue, cancellation and batching (used by main.js);
+# "text": the legacy CHECK / LOAD / STATUS / TRANSFORM:style:category:text line protocol
+IPC_FRAMED = os.environ.get("SONU_IPC", "text").lower() == "framed"
+# Requests queued or running at once; more are rejected with "busy" so callers fall back quickly
+MAX_IN_FLIGHT = int(os.environ.get("SONU_LLM_MAX_IN_FLIGHT", "4"))
+# CPU budget from main.js (src/cpu_budget.js): generation threads and, on Linux, allowed cores.
+# The LLM runs next to whisper, so it gets a share of the cores rather than all of them.
+LLM_THREADS = thread_budget("SONU_LLM_THREADS")
+apply_affinity()
+
 def find_model_file():
     """Find the model file in common locations"""
     global model_path
@@ -59,8 +74,18 @@ def find_model_file():
     
     return None
 
+load_lock = threading.Lock()
+
+
 def load_model():
     """Load the LLM model"""
+    with load_lock:
+        if model_ready:
+            return True
+        return _load_model()
+
+
+def _load_model():
     global model, model_ready, model_path
     
     if Llama is None:
@@ -89,12 +114,13 @@ def load_model():
         model = Llama(
             model_path=model_file,
             n_ctx=512,  # Small context window for speed
-            n_threads=0,  # Auto-detect CPU threads
+            n_threads=LLM_THREADS or None,  # Budget from main.js, else llama-cpp's default
             n_gpu_layers=0,  # CPU-only
             verbose=False
         )
         
         model_path = model_file
+        prefix_cache.clear()
         model_ready = True
         sys.stderr.write("LLM model loaded successfully\n")
         sys.stderr.flush()
@@ -105,8 +131,135 @@ def load_model():
         model_ready = False
         return False
 
-def transform_text(text, style="formal", category="personal"):
-    """Transform text using LLM based on style and category"""
+STYLE_PROMPTS = {
+    "formal": "Transform this text to be formal with proper capitalization and punctuation. Keep the meaning exactly the same, just adjust the style. Return only the transformed text, no explanations:\n\n",
+    "casual": "Transform this text to be casual with capitalization but less punctuation (remove trailing periods). Keep the meaning exactly the same, just adjust the style. Return only the transformed text, no explanations:\n\n",
+    "very_casual": "Transform this text to be very casual with no capitalization and less punctuation (remove trailing periods). Keep the meaning exactly the same, just adjust the style. Return only the transformed text, no explanations:\n\n",
+    "excited": "Transform this text to be more excited with exclamation marks. Keep the meaning exactly the same, just adjust the style. Return only the transformed text, no explanations:\n\n"
+}
+
+CATEGORY_CONTEXT = {
+    "personal": "This is for personal messaging.",
+    "work": "This is for workplace messaging.",
+    "email": "This is for email communication.",
+    "other": "This is for general text output."
+}
+
+
+def prompt_prefix(style, category):
+    """Constant part of the prompt for a style and category, up to the opening quote"""
+    prompt = STYLE_PROMPTS.get(style, STYLE_PROMPTS["formal"])
+    context = CATEGORY_CONTEXT.get(category, "")
+    return f'{context} {prompt}"'
+
+
+def build_prompt(text, style, category):
+    """Prompt for one transformation request"""
+    return prompt_prefix(style, category) + f'{text}"'
+
+
+class PrefixStateCache:
+    """llama state right after evaluating each style x category prompt prefix.
+
+    ``restore`` loads the saved state for the prefix (evaluating and saving it
+    on first use), so the next completion only evaluates the user's text:
+    llama-cpp keeps the KV entries of the longest common token prefix between
+    the loaded state and the new prompt. States are a few MB each; there are at
+    most len(STYLE_PROMPTS) x len(CATEGORY_CONTEXT) of them. Must be used from
+    the thread that owns the model.
+    """
+
+    def __init__(self, max_entries=len(STYLE_PROMPTS) * len(CATEGORY_CONTEXT)):
+        self.max_entries = max_entries
+        self._states = OrderedDict()
+        self.stats = {"hits": 0, "misses": 0, "failed": 0}
+
+    def clear(self):
+        self._states.clear()
+
+    def __len__(self):
+        return len(self._states)
+
+    def restore(self, llm, style, category):
+        """Put ``llm`` in the state after this prefix; False if the backend can't."""
+        key = (style if style in STYLE_PROMPTS else "formal", category)
+        try:
+            state = self._states.get(key)
+            if state is not None:
+                llm.load_state(state)
+                self._states.move_to_end(key)
+                self.stats["hits"] += 1
+                return True
+            llm.reset()
+            llm.eval(llm.tokenize(prompt_prefix(style, category).encode("utf-8")))
+            self._states[key] = llm.save_state()
+            self.stats["misses"] += 1
+            while len(self._states) > self.max_entries:
+                self._states.popitem(last=False)
+            return True
+        except Exception as e:
+            # Falls back to a full prompt evaluation; the completion itself is unaffected
+            self.stats["failed"] += 1
+            sys.stderr.write(f"ERROR: prompt prefix cache: {e}\n")
+            sys.stderr.flush()
+            return False
+
+
+prefix_cache = PrefixStateCache()
+
+
+def clean_output(transformed):
+    """Strip quotes and trailing commentary from raw model output"""
+    transformed = transformed.strip()
+    # Remove quotes if present
+    if transformed.startswith('"') and transformed.endswith('"'):
+        transformed = transformed[1:-1]
+    # Clean up any extra text
+    transformed = transformed.split('\n')[0].strip()
+    return transformed if transformed else None
+
+
+class StreamCleaner:
+    """Incremental ``clean_output``: returns only text that can no longer change.
+
+    Leading whitespace is dropped, output ends at the first newline, and
+    trailing whitespace is held back until more text follows it, so everything
+    returned by ``feed`` is a prefix of ``clean_output`` of the whole stream.
+    (A quote can't appear: generation stops at ``"``.)
+    """
+
+    def __init__(self):
+        self.text = ""
+        self._held = ""
+        self._ended = False
+
+    def feed(self, piece):
+        if self._ended:
+            return ""
+        if "\n" in piece:
+            piece = piece.split("\n", 1)[0]
+            self._ended = True
+        if not self.text:
+            piece = (self._held + piece).lstrip()
+            self._held = ""
+        body = piece.rstrip()
+        if not body:
+            self._held += piece
+            return ""
+        emitted = self._held + body
+        self._held = piece[len(body):]
+        self.text += emitted
+        return emitted
+
+
+def transform_text(text, style="formal", category="personal", should_stop=None, on_text=None):
+    """Transform text using LLM based on style and category
+
+    With ``should_stop`` or ``on_text``, tokens are generated as a stream:
+    generation ends early (returning None) as soon as ``should_stop()`` is
+    true, and ``on_text(delta)`` receives cleaned output as soon as it is
+    final, so callers can start typing at the first token.
+    """
     global model, model_ready
     
     if not model_ready or model is None:
@@ -115,32 +268,14 @@ def transform_text(text, style="formal", category="personal"):
     if not text or not text.strip():
         return text
     
-    # Create prompt based on style and category
-    style_prompts = {
-        "formal": "Transform this text to be formal with proper capitalization and punctuation. Keep the meaning exactly the same, just adjust the style. Return only the transformed text, no explanations:\n\n",
-        "casual": "Transform this text to be casual with capitalization but less punctuation (remove trailing periods). Keep the meaning exactly the same, just adjust the style. Return only the transformed text, no explanations:\n\n",
-        "very_casual": "Transform this text to be very casual with no capitalization and less punctuation (remove trailing periods). Keep the meaning exactly the same, just adjust the style. Return only the transformed text, no explanations:\n\n",
-        "excited": "Transform this text to be more excited with exclamation marks. Keep the meaning exactly the same, just adjust the style. Return only the transformed text, no explanations:\n\n"
-    }
-    
-    category_context = {
-        "personal": "This is for personal messaging.",
-        "work": "This is for workplace messaging.",
-        "email": "This is for email communication.",
-        "other": "This is for general text output."
-    }
-    
-    prompt = style_prompts.get(style, style_prompts["formal"])
-    context = category_context.get(category, "")
-    full_prompt = f"{context} {prompt}" + f'"{text}"'
+    full_prompt = build_prompt(text, style, category)
     
     try:
         # Generate with minimal tokens for speed
         # temperature: 0.3 for more consistent output
         # max_tokens: limit output length
         # stop: stop at quotes or newlines
-        response = model(
-            full_prompt,
+        options = dict(
             max_tokens=len(text) + 50,  # Slightly longer than input
             temperature=0.3,
             top_p=0.9,
@@ -148,19 +283,22 @@ def transform_text(text, style="formal", category="personal"):
             stop=['"', '\n\n'],
             echo=False
         )
+        prefix_cache.restore(model, style, category)
+        if should_stop is not None or on_text is not None:
+            cleaner = StreamCleaner()
+            for chunk in model(full_prompt, stream=True, **options):
+                if should_stop and should_stop():
+                    return None
+                delta = cleaner.feed(chunk['choices'][0]['text'])
+                if delta and on_text:
+                    on_text(delta)
+            return cleaner.text or None
+
+        response = model(full_prompt, **options)
         
         # Extract text from response
         if response and 'choices' in response and len(response['choices']) > 0:
-            transformed = response['choices'][0]['text'].strip()
-            
-            # Remove quotes if present
-            if transformed.startswith('"') and transformed.endswith('"'):
-                transformed = transformed[1:-1]
-            
-            # Clean up any extra text
-            transformed = transformed.split('\n')[0].strip()
-            
-            return transformed if transformed else None
+            return clean_output(response['choices'][0]['text'])
         
         return None
     except Exception as e:
@@ -176,10 +314,198 @@ def get_model_path():
     """Get the path to the model file"""
     return find_model_file()
 
+class TransformQueue:
+    """Bounded queue of transform requests served by one worker thread.
+
+    Requests that pile up while a generation runs are drained as one batch,
+    and identical (text, style, category) requests in it share a single
+    llama-cpp evaluation. Cancelling drops a queued request; a running
+    generation stops at the next token once every request sharing it is
+    cancelled.
+    """
+
+    def __init__(self, respond, max_in_flight=MAX_IN_FLIGHT, stream=None):
+        self._respond = respond
+        self._stream = stream
+        self.max_in_flight = max_in_flight
+        self._cond = threading.Condition()
+        self._pending = []
+        self._running = []
+        self._cancelled = set()
+        self.stats = {"completed": 0, "cancelled": 0, "batched": 0, "rejected": 0}
+
+    def start(self, before=None):
+        threading.Thread(target=self._run, args=(before,), daemon=True).start()
+
+    def submit(self, request):
+        with self._cond:
+            accepted = len(self._pending) + len(self._running) < self.max_in_flight
+            if accepted:
+                self._pending.append(request)
+                self._cond.notify()
+            else:
+                self.stats["rejected"] += 1
+        if not accepted:
+            self._respond(request.get("id"), ok=False, error="busy")
+
+    def cancel(self, request_id):
+        with self._cond:
+            queued = next((r for r in self._pending if r.get("id") == request_id), None)
+            if queued is not None:
+                self._pending.remove(queued)
+            elif any(r.get("id") == request_id for r in self._running):
+                self._cancelled.add(request_id)
+            else:
+                return  # already answered
+            self.stats["cancelled"] += 1
+        self._respond(request_id, ok=False, error="cancelled")
+
+    def _run(self, before):
+        if before:
+            before()
+        while True:
+            with self._cond:
+                while not self._pending:
+                    self._cond.wait()
+                batch, self._pending = self._pending, []
+                self._running = list(batch)
+            groups = {}
+            streaming = set()
+            for request in batch:
+                if request.get("op") == "warm":
+                    self._warm(request)
+                    self._answered([request.get("id")])
+                    continue
+                key = (request.get("text", ""), request.get("style", "formal"), request.get("category", "personal"))
+                groups.setdefault(key, []).append(request.get("id"))
+                if request.get("stream"):
+                    streaming.add(request.get("id"))
+            for (text, style, category), ids in groups.items():
+                self._serve(text, style, category, ids, [i for i in ids if i in streaming])
+            with self._cond:
+                self._running = []
+
+    def _answered(self, ids):
+        """Drops answered requests from the running batch so a late cancel is ignored"""
+        with self._cond:
+            self._running = [r for r in self._running if r.get("id") not in ids]
+
+    def _warm(self, request):
+        if not model_ready and check_model_exists():
+            load_model()
+        if not model_ready:
+            self._respond(request.get("id"), ok=False, error="not_ready")
+            return
+        ok = prefix_cache.restore(model, request.get("style", "formal"), request.get("category", "personal"))
+        self._respond(request.get("id"), ok=ok, cached=len(prefix_cache))
+
+    def _serve(self, text, style, category, ids, streaming=()):
+        def should_stop():
+            with self._cond:
+                return all(i in self._cancelled for i in ids)
+
+        first_ms = None
+
+        def on_text(delta):
+            nonlocal first_ms
+            if first_ms is None:
+                first_ms = round((time.time() - started) * 1000, 1)
+            with self._cond:
+                live = [i for i in streaming if i not in self._cancelled]
+            for request_id in live:
+                self._stream(request_id, delta)
+
+        if should_stop():
+            result, error = None, "cancelled"
+        else:
+            started = time.time()
+            result, error = run_transform(text, style, category, should_stop,
+                                          on_text if streaming and self._stream else None)
+            elapsed_ms = round((time.time() - started) * 1000, 1)
+        with self._cond:
+            live = [i for i in ids if i not in self._cancelled]
+            self._cancelled.difference_update(ids)
+            self._running = [r for r in self._running if r.get("id") not in ids]
+            if len(ids) > 1:
+                self.stats["batched"] += len(ids) - 1
+            if result is not None:
+                self.stats["completed"] += len(live)
+        for request_id in live:
+            if result is not None:
+                self._respond(request_id, ok=True, text=result, ms=elapsed_ms, first_ms=first_ms, shared=len(ids))
+            else:
+                self._respond(request_id, ok=False, error=error)
+
+
+def run_transform(text, style, category, should_stop=None, on_text=None):
+    """Returns (text, None) or (None, error code)"""
+    if not model_ready and check_model_exists():
+        load_model()
+    if not model_ready:
+        return None, "not_ready"
+    transformed = transform_text(text, style, category, should_stop, on_text)
+    if transformed is None:
+        return None, "cancelled" if should_stop and should_stop() else "failed"
+    return transformed, None
+
+
+def serve_framed():
+    """Framed protocol: {"id", "op": transform|warm|cancel|check|load|status, ...} in, {"type": "result", "id", "ok", ...} out
+
+    A transform with ``"stream": true`` also gets ``{"type": "token", "id", "text"}``
+    frames carrying each cleaned delta before its result.
+    """
+    channel = Channel(framed=True)
+
+    def respond(request_id, **fields):
+        channel.send("result", id=request_id, **fields)
+
+    def load_on_start():
+        if check_model_exists() and load_model():
+            channel.send("event", name="READY", args=[])
+        else:
+            sys.stderr.write(f"Model not found. Use check to verify.\n")
+            sys.stderr.flush()
+
+    def stream(request_id, text):
+        channel.send("token", id=request_id, text=text)
+
+    queue = TransformQueue(respond, stream=stream)
+    queue.start(before=load_on_start)
+
+    while True:
+        request = read_frame(sys.stdin.buffer)
+        if request is None:
+            break
+        op = request.get("op")
+        request_id = request.get("id")
+        if op in ("transform", "warm"):
+            # warm: evaluate and keep the prompt prefix for a style/category ahead of use
+            queue.submit(request)
+        elif op == "cancel":
+            queue.cancel(request.get("target"))
+        elif op == "check":
+            exists = check_model_exists()
+            respond(request_id, ok=True, exists=exists, path=get_model_path() if exists else None, ready=model_ready)
+        elif op == "load":
+            # Loading can take seconds; keep reading requests meanwhile
+            threading.Thread(target=lambda: respond(request_id, ok=load_model(), ready=model_ready), daemon=True).start()
+        elif op == "status":
+            respond(request_id, ok=True, ready=model_ready, model_path=model_path if model_ready else None,
+                    model_exists=check_model_exists(), stats=dict(queue.stats),
+                    prefix_cache=dict(prefix_cache.stats, entries=len(prefix_cache)))
+        else:
+            respond(request_id, ok=False, error="unknown_op")
+
+
 def main():
     """Main service loop - reads commands from stdin"""
     global model_ready
     
+    if IPC_FRAMED:
+        serve_framed()
+        return
+    
     # Try to load model on startup
     if check_model_exists():
         load_model()
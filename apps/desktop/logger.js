@@ -1,190 +1,368 @@
 /**
  * Comprehensive logging system for Voice Dictation App
- * Logs to both console and files for debugging
+ * Logs to both console and files for debugging. Calls only append to an in-memory ring;
+ * lines are written as single-line JSON in batches off the calling path, with daily and
+ * size-based rotation and a per-category level threshold
  */
 
 const fs = require('fs');
 const path = require('path');
-const { app } = require('electron');
+
+const LEVELS = { debug: 10, info: 20, warn: 30, error: 40, off: 100 };
+const CATEGORIES = ['main', 'typing', 'download', 'whisper'];
+
+// Entries waiting to be written; past this the oldest are dropped (and counted)
+const RING_CAPACITY = 5000;
+const FLUSH_INTERVAL_MS = 500;
+// A burst this large is written without waiting for the timer
+const FLUSH_BATCH = 500;
+const MAX_FILE_BYTES = 5 * 1024 * 1024;
+// Rotated copies kept per file: main-2024-05-01.1.log ... .3.log
+const MAX_ROTATED_FILES = 3;
+const RETENTION_DAYS = 7;
+
+// SONU_LOG_LEVELS="typing=warn,whisper=debug" (or a bare level for every category)
+function parseLevels(spec) {
+  const levels = {};
+  for (const part of String(spec || '').split(',')) {
+    const [key, value] = part.split('=').map(s => s && s.trim().toLowerCase());
+    if (!key) continue;
+    if (value === undefined && key in LEVELS) {
+      for (const category of CATEGORIES) levels[category] = key;
+    } else if (CATEGORIES.includes(key) && value in LEVELS) {
+      levels[key] = value;
+    }
+  }
+  return levels;
+}
+
+function errorData(error) {
+  if (!error) return null;
+  if (typeof error !== 'object') return { message: String(error) };
+  return { message: error.message, stack: error.stack, code: error.code };
+}
+
+function today() {
+  return new Date().toISOString().split('T')[0];
+}
+
+function defaultLogsDir() {
+  const { app } = require('electron');
+  return path.join(app.getPath('userData'), 'logs');
+}
 
 class Logger {
-  constructor() {
-    // Create logs directory in app data folder
-    const userDataPath = app.getPath('userData');
-    this.logsDir = path.join(userDataPath, 'logs');
-    
-    // Ensure logs directory exists
-    if (!fs.existsSync(this.logsDir)) {
-      fs.mkdirSync(this.logsDir, { recursive: true });
-    }
-    
-    // Create log file paths with timestamp
-    const timestamp = new Date().toISOString().replace(/[:.]/g, '-').split('T')[0];
-    this.mainLogPath = path.join(this.logsDir, `main-${timestamp}.log`);
-    this.typingLogPath = path.join(this.logsDir, `typing-${timestamp}.log`);
-    this.downloadLogPath = path.join(this.logsDir, `download-${timestamp}.log`);
-    this.whisperLogPath = path.join(this.logsDir, `whisper-${timestamp}.log`);
-    
-    // Initialize log files
-    this.initLogFile(this.mainLogPath);
-    this.initLogFile(this.typingLogPath);
-    this.initLogFile(this.downloadLogPath);
-    this.initLogFile(this.whisperLogPath);
-    
+  constructor(options = {}) {
+    this.logsDir = options.logsDir || defaultLogsDir();
+    this.ringCapacity = options.ringCapacity || RING_CAPACITY;
+    this.flushIntervalMs = options.flushIntervalMs ?? FLUSH_INTERVAL_MS;
+    this.maxFileBytes = options.maxFileBytes || MAX_FILE_BYTES;
+    this.maxRotatedFiles = options.maxRotatedFiles ?? MAX_ROTATED_FILES;
+    this.retentionDays = options.retentionDays ?? RETENTION_DAYS;
+    this.console = options.console ?? process.env.SONU_LOG_CONSOLE !== '0';
+    this.ring = new Array(this.ringCapacity);
+    this.head = 0; // index of the oldest entry
+    this.count = 0;
+    this.dropped = 0;
+    this.flushTimer = null;
+    this.pending = []; // drained { file, chunk } in write order, kept until appended
+    this.writing = null;
+    this.sizes = new Map(); // file path -> bytes, so rotation doesn't stat per batch
+    this.writeFailed = false;
+    this.setLevels({ ...parseLevels(process.env.SONU_LOG_LEVELS), ...(options.levels || {}) });
+
+    this.ensureDirectory(this.logsDir);
+    this.pruneOldLogs();
+    this.info('Logger started', { logsDir: this.logsDir, pid: process.pid });
     console.log('Logger initialized. Logs directory:', this.logsDir);
   }
-  
-  initLogFile(filePath) {
-    const header = `=== Voice Dictation App Log ===\nStarted: ${new Date().toISOString()}\n${'='.repeat(50)}\n\n`;
-    fs.writeFileSync(filePath, header, 'utf8');
-  }
-  
-  formatMessage(level, category, message, data = null) {
-    const timestamp = new Date().toISOString();
-    let logLine = `[${timestamp}] [${level.padEnd(5)}] [${category.padEnd(10)}] ${message}`;
-    
-    if (data) {
-      if (typeof data === 'object') {
-        logLine += `\n${JSON.stringify(data, null, 2)}`;
-      } else {
-        logLine += ` | ${data}`;
+
+  // Thresholds are turned into per-category booleans so a filtered call returns at once
+  setLevels(levels = {}) {
+    this.levels = {};
+    this.enabled = {};
+    for (const category of CATEGORIES) {
+      const level = levels[category] in LEVELS ? levels[category] : 'info';
+      this.levels[category] = level;
+      this.enabled[category] = {};
+      for (const [name, value] of Object.entries(LEVELS)) {
+        this.enabled[category][name] = name !== 'off' && value >= LEVELS[level];
       }
     }
-    
-    return logLine + '\n';
   }
-  
-  writeToFile(filePath, message) {
+
+  // For callers that would build an expensive data object only to have it filtered
+  isEnabled(category, level = 'info') {
+    return !!(this.enabled[category] && this.enabled[category][level]);
+  }
+
+  ensureDirectory(dir) {
     try {
-      fs.appendFileSync(filePath, message, 'utf8');
+      fs.mkdirSync(dir, { recursive: true });
+      return true;
     } catch (e) {
-      // Silent fail for EPIPE errors
-      if (e.code !== 'EPIPE') {
-        console.error('Failed to write log:', e.message);
+      console.error('Failed to create logs directory:', e.message);
+      return false;
+    }
+  }
+
+  filePath(category, day = today()) {
+    return path.join(this.logsDir, `${category}-${day}.log`);
+  }
+
+  // Entries are serialised at flush time, so the calling path only pays for this push
+  record(level, category, message, data) {
+    if (this.count === this.ringCapacity) {
+      this.head = (this.head + 1) % this.ringCapacity;
+      this.count--;
+      this.dropped++;
+    }
+    this.ring[(this.head + this.count) % this.ringCapacity] = { ts: Date.now(), level, category, message, data };
+    this.count++;
+    if (this.count >= FLUSH_BATCH) {
+      this.flush();
+    } else if (!this.flushTimer) {
+      this.flushTimer = setTimeout(() => {
+        this.flushTimer = null;
+        this.flush();
+      }, this.flushIntervalMs);
+      if (this.flushTimer.unref) this.flushTimer.unref();
+    }
+  }
+
+  // Takes everything buffered and groups it into one chunk of lines per file
+  drain() {
+    const batches = new Map();
+    const add = (file, line) => {
+      if (!batches.has(file)) batches.set(file, []);
+      batches.get(file).push(line);
+    };
+    if (this.dropped) {
+      add(this.filePath('main'), JSON.stringify({
+        ts: new Date().toISOString(), level: 'warn', cat: 'main',
+        msg: `Log buffer full, ${this.dropped} entries dropped`
+      }));
+      this.dropped = 0;
+    }
+    for (let i = 0; i < this.count; i++) {
+      const index = (this.head + i) % this.ringCapacity;
+      const entry = this.ring[index];
+      this.ring[index] = undefined;
+      const stamp = new Date(entry.ts).toISOString();
+      const record = { ts: stamp, level: entry.level, cat: entry.category, msg: entry.message };
+      if (entry.data !== null && entry.data !== undefined) record.data = entry.data;
+      let line;
+      try {
+        line = JSON.stringify(record);
+      } catch (e) {
+        line = JSON.stringify({ ...record, data: String(entry.data) }); // circular
       }
+      const day = stamp.split('T')[0];
+      add(this.filePath(entry.category, day), line);
+      // Category logs are also mirrored into the main log, as before
+      if (entry.category !== 'main') add(this.filePath('main', day), line);
     }
+    this.head = 0;
+    this.count = 0;
+    return batches;
   }
-  
+
+  // Writes run one chunk at a time on libuv's thread pool; resolves once all are written
+  flush() {
+    if (this.flushTimer) {
+      clearTimeout(this.flushTimer);
+      this.flushTimer = null;
+    }
+    for (const [file, lines] of this.drain()) {
+      this.pending.push({ file, chunk: lines.join('\n') + '\n' });
+    }
+    if (!this.writing && this.pending.length) {
+      this.writing = this.writePending().finally(() => {
+        this.writing = null;
+      });
+    }
+    return this.writing || Promise.resolve();
+  }
+
+  // A chunk leaves pending only once appended, so flushSync() can still write it
+  async writePending() {
+    while (this.pending.length) {
+      const item = this.pending[0];
+      const bytes = Buffer.byteLength(item.chunk);
+      try {
+        await this.rotateIfNeeded(item.file, bytes);
+        await fs.promises.appendFile(item.file, item.chunk, 'utf8');
+        this.sizes.set(item.file, (this.sizes.get(item.file) || 0) + bytes);
+        this.writeFailed = false;
+      } catch (e) {
+        // Once per outage, not once per chunk
+        if (!this.writeFailed && e.code !== 'EPIPE') console.error('Failed to write log:', e.message);
+        this.writeFailed = true;
+      }
+      // flushSync() may have taken it meanwhile
+      if (this.pending[0] === item) this.pending.shift();
+    }
+  }
+
+  async rotateIfNeeded(file, incoming) {
+    if (!this.sizes.has(file)) {
+      try {
+        this.sizes.set(file, (await fs.promises.stat(file)).size);
+      } catch (e) {
+        this.sizes.set(file, 0);
+      }
+    }
+    if (this.sizes.get(file) + incoming <= this.maxFileBytes || this.sizes.get(file) === 0) return;
+    const base = file.slice(0, -'.log'.length);
+    for (let i = this.maxRotatedFiles; i >= 1; i--) {
+      const from = i === 1 ? file : `${base}.${i - 1}.log`;
+      try {
+        if (i === this.maxRotatedFiles) await fs.promises.rm(`${base}.${i}.log`, { force: true });
+        await fs.promises.rename(from, `${base}.${i}.log`);
+      } catch (e) {
+        // Nothing to shift at this position
+      }
+    }
+    if (this.maxRotatedFiles === 0) await fs.promises.rm(file, { force: true });
+    this.sizes.set(file, 0);
+  }
+
+  // For will-quit and process exit, where pending async writes would be lost. Chunks
+  // drained by flush() go first, in order; one whose append is already under way may
+  // end up written twice, which beats losing the last entries before exit
+  flushSync() {
+    if (this.flushTimer) {
+      clearTimeout(this.flushTimer);
+      this.flushTimer = null;
+    }
+    const chunks = this.pending;
+    this.pending = [];
+    for (const [file, lines] of this.drain()) {
+      chunks.push({ file, chunk: lines.join('\n') + '\n' });
+    }
+    for (const { file, chunk } of chunks) {
+      try {
+        fs.appendFileSync(file, chunk, 'utf8');
+        if (this.sizes.has(file)) this.sizes.set(file, this.sizes.get(file) + Buffer.byteLength(chunk));
+      } catch (e) {
+        // Nothing left to report it to
+      }
+    }
+  }
+
+  // Dated files older than the retention period
+  pruneOldLogs() {
+    const cutoff = Date.now() - this.retentionDays * 24 * 60 * 60 * 1000;
+    fs.promises.readdir(this.logsDir).then(async (names) => {
+      for (const name of names) {
+        const match = /^(main|typing|download|whisper)-(\d{4}-\d{2}-\d{2})(\.\d+)?\.log$/.exec(name);
+        if (match && Date.parse(match[2]) < cutoff) {
+          await fs.promises.rm(path.join(this.logsDir, name), { force: true });
+        }
+      }
+    }).catch(() => {});
+  }
+
   safeConsole(method, ...args) {
+    if (!this.console) return;
     try {
       console[method](...args);
     } catch (e) {
       // Silent fail for EPIPE errors
     }
   }
-  
+
+  log(level, category, message, data = null, consoleArgs = null) {
+    if (!this.enabled[category][level]) return;
+    const method = level === 'error' ? 'error' : level === 'warn' ? 'warn' : 'log';
+    this.safeConsole(method, ...(consoleArgs || [`[${level.toUpperCase()}] ${message}`, data || '']));
+    this.record(level, category, message, data);
+  }
+
   // Main application logs
+  debug(message, data = null) {
+    this.log('debug', 'main', message, data);
+  }
+
   info(message, data = null) {
-    const formatted = this.formatMessage('INFO', 'Main', message, data);
-    this.safeConsole('log', `[INFO] ${message}`, data || '');
-    this.writeToFile(this.mainLogPath, formatted);
+    this.log('info', 'main', message, data);
   }
-  
+
   warn(message, data = null) {
-    const formatted = this.formatMessage('WARN', 'Main', message, data);
-    this.safeConsole('warn', `[WARN] ${message}`, data || '');
-    this.writeToFile(this.mainLogPath, formatted);
+    this.log('warn', 'main', message, data);
   }
-  
+
   error(message, error = null) {
-    const data = error ? {
-      message: error.message,
-      stack: error.stack,
-      code: error.code
-    } : null;
-    const formatted = this.formatMessage('ERROR', 'Main', message, data);
-    this.safeConsole('error', `[ERROR] ${message}`, error || '');
-    this.writeToFile(this.mainLogPath, formatted);
-  }
-  
+    if (!this.enabled.main.error) return;
+    this.log('error', 'main', message, errorData(error), [`[ERROR] ${message}`, error || '']);
+  }
+
   // Typing-specific logs
   typing(message, data = null) {
-    const formatted = this.formatMessage('INFO', 'Typing', message, data);
-    this.safeConsole('log', `[TYPING] ${message}`, data || '');
-    this.writeToFile(this.typingLogPath, formatted);
-    this.writeToFile(this.mainLogPath, formatted);
+    this.log('info', 'typing', message, data, [`[TYPING] ${message}`, data || '']);
   }
-  
+
   typingError(message, error = null) {
-    const data = error ? {
-      message: error.message,
-      stack: error.stack
-    } : null;
-    const formatted = this.formatMessage('ERROR', 'Typing', message, data);
-    this.safeConsole('error', `[TYPING ERROR] ${message}`, error || '');
-    this.writeToFile(this.typingLogPath, formatted);
-    this.writeToFile(this.mainLogPath, formatted);
-  }
-  
+    if (!this.enabled.typing.error) return;
+    this.log('error', 'typing', message, errorData(error), [`[TYPING ERROR] ${message}`, error || '']);
+  }
+
   // Download-specific logs
   download(message, data = null) {
-    const formatted = this.formatMessage('INFO', 'Download', message, data);
-    this.safeConsole('log', `[DOWNLOAD] ${message}`, data || '');
-    this.writeToFile(this.downloadLogPath, formatted);
-    this.writeToFile(this.mainLogPath, formatted);
+    this.log('info', 'download', message, data, [`[DOWNLOAD] ${message}`, data || '']);
   }
-  
+
   downloadError(message, error = null) {
-    const data = error ? {
-      message: error.message,
-      stack: error.stack
-    } : null;
-    const formatted = this.formatMessage('ERROR', 'Download', message, data);
-    this.safeConsole('error', `[DOWNLOAD ERROR] ${message}`, error || '');
-    this.writeToFile(this.downloadLogPath, formatted);
-    this.writeToFile(this.mainLogPath, formatted);
-  }
-  
+    if (!this.enabled.download.error) return;
+    this.log('error', 'download', message, errorData(error), [`[DOWNLOAD ERROR] ${message}`, error || '']);
+  }
+
   // Whisper service logs
   whisper(message, data = null) {
-    const formatted = this.formatMessage('INFO', 'Whisper', message, data);
-    this.safeConsole('log', `[WHISPER] ${message}`, data || '');
-    this.writeToFile(this.whisperLogPath, formatted);
-    this.writeToFile(this.mainLogPath, formatted);
+    this.log('info', 'whisper', message, data, [`[WHISPER] ${message}`, data || '']);
   }
-  
+
   whisperError(message, error = null) {
-    const data = error ? {
-      message: error.message,
-      stack: error.stack
-    } : null;
-    const formatted = this.formatMessage('ERROR', 'Whisper', message, data);
-    this.safeConsole('error', `[WHISPER ERROR] ${message}`, error || '');
-    this.writeToFile(this.whisperLogPath, formatted);
-    this.writeToFile(this.mainLogPath, formatted);
-  }
-  
+    if (!this.enabled.whisper.error) return;
+    this.log('error', 'whisper', message, errorData(error), [`[WHISPER ERROR] ${message}`, error || '']);
+  }
+
   // Performance timing
   startTimer(label) {
+    const start = Date.now();
     return {
       label,
-      start: Date.now(),
+      start,
       end: () => {
-        const duration = Date.now() - this.start;
+        const duration = Date.now() - start;
         this.info(`Timer [${label}] completed`, { duration_ms: duration });
         return duration;
       }
     };
   }
-  
+
   // Get logs directory for UI access
   getLogsDirectory() {
     return this.logsDir;
   }
-  
-  // Get recent logs (last N lines)
-  getRecentLogs(category = 'main', lines = 100) {
-    let filePath;
-    switch (category) {
-      case 'typing': filePath = this.typingLogPath; break;
-      case 'download': filePath = this.downloadLogPath; break;
-      case 'whisper': filePath = this.whisperLogPath; break;
-      default: filePath = this.mainLogPath; break;
-    }
-    
+
+  // Later entries go to the new directory; what is buffered is written to the old one
+  setLogsDirectory(dir) {
+    if (!dir || !this.ensureDirectory(dir)) return false;
+    this.flush();
+    this.logsDir = dir;
+    this.sizes.clear();
+    this.info('Logs directory changed', { logsDir: dir });
+    return true;
+  }
+
+  // Get recent logs (last N lines), including entries not yet flushed
+  async getRecentLogs(category = 'main', lines = 100) {
+    if (!CATEGORIES.includes(category)) category = 'main';
+    await this.flush();
     try {
-      const content = fs.readFileSync(filePath, 'utf8');
-      const allLines = content.split('\n');
+      const content = await fs.promises.readFile(this.filePath(category), 'utf8');
+      const allLines = content.split('\n').filter(Boolean);
       return allLines.slice(-lines).join('\n');
     } catch (e) {
       return `Error reading log file: ${e.message}`;
@@ -195,12 +373,12 @@ class Logger {
 // Create singleton instance
 let loggerInstance = null;
 
-function getLogger() {
+function getLogger(logsDir = null) {
   if (!loggerInstance) {
-    loggerInstance = new Logger();
+    loggerInstance = new Logger(logsDir ? { logsDir } : {});
+    process.once('exit', () => loggerInstance.flushSync());
   }
   return loggerInstance;
 }
 
-module.exports = { getLogger };
-
+module.exports = { getLogger, Logger, parseLevels };
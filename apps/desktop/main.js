@@ -27,8 +27,23 @@ const dialog = electron.dialog;
 // Model downloader integration
 const { ModelDownloader } = require('./src/model_downloader.js');
 const modelDownloader = new ModelDownloader();
+// Whisper service framed IPC (length-prefixed JSON; SONU_IPC=text keeps the legacy line protocol)
+const { encodeFrame, FrameDecoder, parseTextLine } = require('./src/whisper_ipc.js');
 // Style transformer integration
 const { applyStyle, getStyleDescription, getStyleExample, getAvailableStyles, getCategoryBannerText } = require('./src/style_transformer.js');
+const { TransformCache } = require('./src/transform_cache.js');
+const { SettingsStore } = require('./src/settings_store.js');
+const { HistoryStore } = require('./src/history_store.js');
+const { SearchIndex } = require('./src/search_index.js');
+// Thread counts, priorities and dictation phase shared by the Python services
+const { CpuBudget } = require('./src/cpu_budget.js');
+// Ordered, coalescing queue in front of every typing backend
+const { OutputQueue } = require('./src/output_queue.js');
+// Backspace-plus-insert scripts for correcting live-typed partials
+const { planEdit, MAX_BACKSPACES } = require('./src/edit_script.js');
+// Foreground app and style category, kept current as focus changes
+const { FocusWatcher } = require('./src/focus_watcher.js');
+const cpuBudget = new CpuBudget();
 
 // Performance monitoring integration (optional - gracefully handle if not available)
 let performanceMonitor = null;
@@ -72,7 +87,12 @@ const showcaseOutputDir = path.join(__dirname, 'assets', 'showcase');
 let mainWindow;
 let tray;
 let whisperProcess;
-let whisperStdoutBuffer = ''; // Buffer for incomplete stdout lines
+let whisperStdoutBuffer = ''; // Buffer for incomplete stdout lines (text protocol)
+const WHISPER_IPC_FRAMED = (process.env.SONU_IPC || 'framed').toLowerCase() !== 'text';
+const whisperFrameDecoder = new FrameDecoder();
+let whisperRequestSeq = 0;
+// START request id -> { hotkeyAt, sentAt }; lets each final be attributed to its utterance
+const whisperUtterances = new Map();
 let llmProcess = null; // LLM service process
 let llmProcessReady = false; // Whether LLM service is ready
 let isRecording = false;
@@ -80,6 +100,7 @@ let robot;
 let robotType = null; // 'insert-text', 'robot-js', or 'robotjs'
 let insertTextNative = null; // Modern native addon for instant typing
 let lastTypedText = ''; // Track what we've already typed for incremental typing
+let lastTypedTimes = null; // Word timestamps of lastTypedText, when the decoder sent them
 let pendingTypingQueue = []; // Queue for typing operations to prevent overlap
 const isTestMode = String(process.env.NODE_ENV || '').toLowerCase() === 'test' ||
   String(process.env.E2E_TEST || '').toLowerCase() === '1' ||
@@ -96,6 +117,49 @@ let settings = {
 };
 const configPath = path.join(__dirname, 'config.json');
 const historyPath = path.join(__dirname, 'history.json');
+// App settings (data/settings.json), read on every partial and final - served from memory
+const APP_SETTING_DEFAULTS = {
+  theme: 'light',
+  follow_system_theme: false,
+  auto_model: false,
+  selected_model: 'base',
+  language: 'en',
+  dictation_hotkey: 'Ctrl+Space',
+  launch_on_startup: false,
+  sound_feedback: true,
+  vibe_coding_enabled: false,
+  waveform_animation: true,
+  continuous_dictation: false,
+  low_latency: false,
+  noise_reduction: false,
+  local_only: true,
+  auto_delete_cache: false,
+  text_style: 'none',
+  text_style_category: 'personal',
+  llm_processing: false,
+  preroll_ms: 500,
+  model_cascade: false,
+  transform_cache_persist: false,
+  // model -> { error, at } for tuning runs that produced nothing (see maybeTuneWhisperModel)
+  whisper_tuning_failed: {}
+};
+const appSettingsStore = new SettingsStore({
+  filePath: path.join(__dirname, 'data', 'settings.json'),
+  defaults: APP_SETTING_DEFAULTS
+});
+// Transcript history: append-only segments + index under data/history (history.json is imported once)
+const historyStore = new HistoryStore({
+  dir: path.join(__dirname, 'data', 'history'),
+  legacyPath: historyPath,
+  runCompaction: (job) => cpuBudget.whenIdle(job)
+});
+const notesPath = path.join(__dirname, 'data', 'notes.json');
+const snippetsPath = path.join(__dirname, 'data', 'snippets.json');
+// Full-text search over history, notes and snippets, kept current as each one changes
+const searchIndex = new SearchIndex();
+let searchIndexBuild = null;
+// History entries edited or re-saved while the build runs; their index entry is already current
+let searchIndexTouched = null;
 let logger = null; // Initialize after app ready
 let whisperModelReady = false; // Track if whisper model is loaded
 let activeDownloadProcess = null; // Track active download process for cancellation
@@ -820,29 +884,26 @@ function positionIndicator() {
 
 function loadWidgetPosition() {
   try {
-    const settingsPath = path.join(__dirname, 'data', 'settings.json');
-    if (fs.existsSync(settingsPath)) {
-      const settings = JSON.parse(fs.readFileSync(settingsPath, 'utf8'));
-      if (settings.widgetPosition && 
-          typeof settings.widgetPosition.x === 'number' && 
-          typeof settings.widgetPosition.y === 'number' &&
-          !isNaN(settings.widgetPosition.x) &&
-          !isNaN(settings.widgetPosition.y)) {
-        // Validate position is within screen bounds
-        const display = screen.getPrimaryDisplay();
-        const { width, height, x, y } = display.workArea;
-        const widgetWidth = 150;
-        const widgetHeight = 32;
-        
-        // Check if saved position is within screen bounds
-        if (settings.widgetPosition.x >= x && 
-            settings.widgetPosition.y >= y &&
-            settings.widgetPosition.x + widgetWidth <= x + width &&
-            settings.widgetPosition.y + widgetHeight <= y + height) {
-          return { x: settings.widgetPosition.x, y: settings.widgetPosition.y };
-        } else {
-          console.log('Saved widget position is out of bounds, will center');
-        }
+    const pos = appSettingsStore.get('widgetPosition');
+    if (pos && 
+        typeof pos.x === 'number' && 
+        typeof pos.y === 'number' &&
+        !isNaN(pos.x) &&
+        !isNaN(pos.y)) {
+      // Validate position is within screen bounds
+      const display = screen.getPrimaryDisplay();
+      const { width, height, x, y } = display.workArea;
+      const widgetWidth = 150;
+      const widgetHeight = 32;
+      
+      // Check if saved position is within screen bounds
+      if (pos.x >= x && 
+          pos.y >= y &&
+          pos.x + widgetWidth <= x + width &&
+          pos.y + widgetHeight <= y + height) {
+        return { x: pos.x, y: pos.y };
+      } else {
+        console.log('Saved widget position is out of bounds, will center');
       }
     }
   } catch (e) {
@@ -853,13 +914,7 @@ function loadWidgetPosition() {
 
 function saveWidgetPosition(x, y) {
   try {
-    const settingsPath = path.join(__dirname, 'data', 'settings.json');
-    let settings = {};
-    if (fs.existsSync(settingsPath)) {
-      settings = JSON.parse(fs.readFileSync(settingsPath, 'utf8'));
-    }
-    settings.widgetPosition = { x, y };
-    fs.writeFileSync(settingsPath, JSON.stringify(settings, null, 2));
+    appSettingsStore.set({ widgetPosition: { x, y } });
   } catch (e) {
     console.error('Error saving widget position:', e);
   }
@@ -875,23 +930,10 @@ function showIndicator() {
   if (indicatorState === 'visible' || indicatorState === 'fading_in') return;
   
   // CRITICAL: Check waveform animation setting - don't show widget if disabled
-  const settingsPath = path.join(__dirname, 'data', 'settings.json');
-  try {
-    if (fs.existsSync(settingsPath)) {
-      const raw = fs.readFileSync(settingsPath, 'utf8');
-      const settings = JSON.parse(raw);
-      console.log('Checking waveform_animation setting:', settings.waveform_animation);
-      if (settings.waveform_animation === false) {
-        console.log('Widget NOT shown - waveform animation is disabled');
-        indicatorState = 'hidden'; // Keep state as hidden
-        return;
-      }
-      console.log('Widget WILL be shown - waveform animation is enabled or not set (default true)');
-    } else {
-      console.log('Settings file not found - widget will be shown (default behavior)');
-    }
-  } catch (e) {
-    console.error('Error reading waveform setting for widget:', e);
+  if (appSettingsStore.get('waveform_animation') === false) {
+    console.log('Widget NOT shown - waveform animation is disabled');
+    indicatorState = 'hidden'; // Keep state as hidden
+    return;
   }
   
   if (fadeTimer) { clearInterval(fadeTimer); fadeTimer = null; }
@@ -966,62 +1008,45 @@ function hideIndicator() {
   }
 }
 
-// Incremental typing: type only new words that haven't been typed yet
-// Optimized for instant output like Wispr Flow and Typeless
-function typeIncrementalText(newText, isPartial = false) {
+// Every injection goes through this queue, in order; see src/output_queue.js
+const outputQueue = new OutputQueue({ inject: injectText });
+// Tags queued text with the recording it came from, so utterances never merge
+let typingUtterance = 0;
+
+// While typing lags behind, the whisper service holds partials (finals still go out)
+outputQueue.on('pressure', (busy) => {
+  if (whisperProcess && !whisperProcess.killed) {
+    writeToWhisper(`SET_OUTPUT_BUSY ${busy ? 'ON' : 'OFF'}\n`);
+  }
+});
+
+// Incremental typing: bring what is on screen in line with the newest hypothesis.
+// Appends are typed as-is; rewritten words are corrected with backspaces (up to
+// MAX_BACKSPACES back), see src/edit_script.js. `times` are the decoder's word
+// timestamps ([word, start_ms, end_ms]) when it sent them
+function typeIncrementalText(newText, isPartial = false, times = null) {
   if (!newText || !newText.trim()) return '';
   
-  // Extract only the NEW words that haven't been typed yet
-  let textToType = '';
-  
-  if (lastTypedText && newText.startsWith(lastTypedText)) {
-    // New text extends what we've already typed - type only the delta (fastest path)
-    textToType = newText.slice(lastTypedText.length);
-    // Don't trim - preserve leading spaces for natural typing
-  } else if (lastTypedText && newText.length > lastTypedText.length) {
-    // Text has grown - find the longest common prefix for instant typing
-    let commonLength = 0;
-    const minLen = Math.min(lastTypedText.length, newText.length);
-    for (let i = 0; i < minLen && lastTypedText[i] === newText[i]; i++) {
-      commonLength = i + 1;
-    }
-    // Type everything after the common prefix (more aggressive for instant output)
-    textToType = newText.slice(commonLength);
-  } else if (!lastTypedText || !newText.includes(lastTypedText)) {
-    // Completely new text or doesn't match - type everything
-    if (isPartial) {
-      // For partials, be more aggressive - type new words immediately
-      // Find the last word boundary in lastTypedText for smoother typing
-      if (lastTypedText) {
-        const lastSpaceIndex = lastTypedText.lastIndexOf(' ');
-        if (lastSpaceIndex > 0 && newText.includes(lastTypedText.substring(0, lastSpaceIndex + 1))) {
-          // Type from after the last complete word
-          textToType = newText.slice(lastSpaceIndex + 1);
-        } else {
-          // No match - type everything (might be correction or new sentence)
-          textToType = newText;
-          lastTypedText = ''; // Reset since we're typing everything
-        }
-      } else {
-        // First partial - type everything
-        textToType = newText;
-      }
-    } else {
-      // Final text - type everything
-      textToType = newText;
-    }
-  }
+  const plan = planEdit(lastTypedText, newText, {
+    maxBackspaces: canBackspace() ? MAX_BACKSPACES : 0,
+    screenTimes: lastTypedTimes,
+    nextTimes: times
+  });
   
-  // Type immediately if there's new text to type
-  if (textToType && textToType.trim().length > 0) {
-    typeStringRobot(textToType);
-    lastTypedText = newText; // Update what we've typed
+  // Type immediately if there's anything to change
+  if (plan.backspaces || plan.text.trim().length > 0) {
+    if (plan.backspaces && logger) {
+      logger.typing('Correcting typed text', { backspaces: plan.backspaces, partial: isPartial });
+    }
+    typeStringRobot(plan.text, { backspaces: plan.backspaces });
+    lastTypedText = plan.screen; // What is on screen now, which may lag newText past the cap
+    lastTypedTimes = plan.times;
   }
   
-  return textToType;
+  return plan.text;
 }
 
-function typeStringRobot(text) {
+function typeStringRobot(text, { backspaces = 0 } = {}) {
   const startTime = Date.now();
   
   // CRITICAL: Never type or hide window for notes recording
@@ -1032,13 +1057,14 @@ function typeStringRobot(text) {
     return false;
   }
   
-  if (!text || text.trim() === '') {
+  if (!backspaces && (!text || text.trim() === '')) {
     if (logger) logger.typing('Empty text, skipping');
     return false;
   }
   
   if (logger) logger.typing('Starting typing', { 
     textLength: text.length, 
+    backspaces, 
     preview: text.substring(0, 50),
     robotType: robotType,
     robotAvailable: !!robot
@@ -1065,107 +1091,138 @@ function typeStringRobot(text) {
     indicatorWindow.setAlwaysOnTop(false);
   }
   
+  // Typed in order after anything still queued; deltas that arrive while an injection
+  // is running are merged into the next one
+  outputQueue.push(text, { utterance: typingUtterance, backspaces });
+  return true;
+}
+
+// Whether corrections can be typed: insertText and clipboard pastes have no backspace
+function canBackspace() {
+  return injectorReady || !!(robot && robot.keyTap);
+}
+
+// Resolves with the outcome once the edit has been typed (or handed to the clipboard)
+function injectText(text, { backspaces = 0 } = {}) {
+  const startTime = Date.now();
   // INSTANT TYPING: Multiple methods in order of preference
+  // Method 0 (Linux/X11): the text injector waits for focus to reach the target window
+  // and confirms delivery, so there is no fixed delay; on failure use the methods below
+  if (injectorReady) {
+    return callTextInjector('type', { text, backspaces, window: typingTargetWindow, avoid: ownWindowIds() }).then((result) => {
+      const totalTime = Date.now() - startTime;
+      if (result) {
+        if (logger) logger.typing('✓ Typed with text injector', { total_duration_ms: totalTime, ...result });
+        console.log(`✓ Typed in ${totalTime}ms (text injector)`);
+        return true;
+      }
+      if (logger) logger.typing('Text injector failed, falling back');
+      return typeWithBackspaces(text, backspaces, startTime);
+    });
+  }
+
+  return typeWithBackspaces(text, backspaces, startTime);
+}
+
+// Backspaces through robotjs (after the usual focus delay), then the text
+function typeWithBackspaces(text, backspaces, startTime) {
+  if (!backspaces) return typeStringRobotFallback(text, startTime);
+  if (!robot || !robot.keyTap) {
+    if (logger) logger.typing('No backend can send backspaces, typing text only', { backspaces });
+    return text ? typeStringRobotFallback(text, startTime) : Promise.resolve(false);
+  }
+  return afterDelay(100, () => {
+    try {
+      for (let i = 0; i < backspaces; i++) robot.keyTap('backspace');
+    } catch (e) {
+      if (logger) logger.typingError('Backspace failed', e);
+    }
+    return text ? typeStringRobotFallback(text, startTime) : true;
+  });
+}
+
+// Runs fn after ms and resolves with its result
+function afterDelay(ms, fn) {
+  return new Promise(resolve => setTimeout(() => resolve(fn()), ms));
+}
+
+// Leaves a final on the clipboard for manual pasting without racing the typer: waits until
+// the caller has queued its typing and the queue has drained, then for the last Ctrl+V to be
+// read (the target app fetches the clipboard when it handles the keystroke, not when sent)
+function copyWhenTyped(text) {
+  setImmediate(() => {
+    outputQueue.whenIdle().then(() => afterDelay(200, () => {
+      if (!outputQueue.isIdle()) {
+        copyWhenTyped(text);
+        return;
+      }
+      try {
+        clipboard.writeText(text);
+      } catch (e) {
+        console.error('Failed to copy to clipboard:', e);
+      }
+    }));
+  });
+}
+
+// Methods that can't confirm focus has moved, so they wait a fixed delay first
+function typeStringRobotFallback(text, startTime = Date.now()) {
   // Method 1: Modern native addon (fastest, most reliable - like Wispr Flow)
   if (insertTextNative && insertTextNative.insertText) {
-    // Hide window first
-    setTimeout(() => {
+    return afterDelay(100, () => { // Minimal delay for window hiding
       try {
         insertTextNative.insertText(text);
         const totalTime = Date.now() - startTime;
         if (logger) logger.typing('✓ Typed instantly with native insertText', { total_duration_ms: totalTime });
         console.log(`✓ Typed instantly in ${totalTime}ms (native insertText method)`);
+        return true;
       } catch (insertErr) {
         if (logger) logger.typingError('Native insertText failed', insertErr);
         console.error('❌ Native insertText failed:', insertErr.message || insertErr);
         // Fall through to clipboard method
-        typeStringRobotClipboard(text, startTime);
+        return typeStringRobotClipboard(text, startTime) || false;
       }
-    }, 100); // Minimal delay for window hiding
-    return true;
+    });
   }
   
   // Method 2: Clipboard + Ctrl+V (fast, reliable - what Wispr Flow uses)
   // This is how Wispr Flow, Typeless, and MacWhisper achieve instant output
   if (robot && robot.keyTap) {
-    // Write to clipboard synchronously (fast)
-    try {
-      clipboard.writeText(text);
-      if (logger) logger.typing('Text copied to clipboard', { duration_ms: Date.now() - startTime });
-      
-      // CRITICAL: Small delay to ensure window is fully hidden and focus has switched
-      // Windows needs a moment to switch focus to the previous application
-      setTimeout(() => {
-        try {
-          // Use correct robotjs syntax for Ctrl+V on Windows
-          // robotjs keyTap syntax: keyTap(key, [modifier1, modifier2])
-          if (process.platform === 'win32') {
-            // Try Ctrl+V - robotjs uses 'control' or 'ctrl' as modifier
-            robot.keyTap('v', 'control');
-            console.log('✓ Sent Ctrl+V paste command');
-          } else if (process.platform === 'darwin') {
-            // Mac uses Command
-            robot.keyTap('v', 'command');
-            console.log('✓ Sent Cmd+V paste command');
-          } else {
-            // Linux uses Ctrl
-            robot.keyTap('v', 'control');
-            console.log('✓ Sent Ctrl+V paste command');
-          }
-          const totalTime = Date.now() - startTime;
-          if (logger) logger.typing('✓ Pasted instantly with Ctrl+V', { total_duration_ms: totalTime });
-          console.log(`✓ Typed instantly in ${totalTime}ms (clipboard method)`);
-        } catch (pasteErr) {
-          if (logger) logger.typingError('Paste failed', pasteErr);
-          console.error('❌ Paste failed:', pasteErr.message || pasteErr);
-          console.warn('Text is in clipboard, use Ctrl+V manually');
-          // Try alternative syntax if first attempt failed
-          try {
-            console.log('Trying alternative robotjs syntax...');
-            if (process.platform === 'win32') {
-              robot.keyTap('v', ['control']);
-            }
-          } catch (altErr) {
-            console.error('Alternative syntax also failed:', altErr.message || altErr);
-          }
-        }
-      }, 200); // 200ms delay to ensure focus has switched and window is fully hidden
-      return true;
-    } catch (clipErr) {
-      if (logger) logger.typingError('Clipboard failed', clipErr);
-      console.error('Failed to copy to clipboard:', clipErr);
-      // Fall through to alternative methods
-    }
+    const pasted = typeStringRobotClipboard(text, startTime);
+    if (pasted) return pasted;
+    // Fall through to alternative methods
   }
   
   // FALLBACK: Try robot-js if clipboard method failed
   if (robot && robotType === 'robot-js' && robot.Keyboard && robot.Keyboard.typeString) {
-    setTimeout(() => {
+    return afterDelay(150, () => {
       try {
         robot.Keyboard.typeString(text);
         const totalTime = Date.now() - startTime;
         if (logger) logger.typing('✓ Typed with robot-js', { total_duration_ms: totalTime });
         console.log(`✓ Typed successfully in ${totalTime}ms`);
+        return true;
       } catch (e) {
         if (logger) logger.typingError('robot-js.Keyboard.typeString failed', e);
+        return false;
       }
-    }, 150);
-    return true;
+    });
   }
   
   // FALLBACK: Try typeStringDelayed with 0 delay (for very short text only)
   if (robot && robotType === 'robotjs' && robot.typeStringDelayed && text.length < 10) {
-    setTimeout(() => {
+    return afterDelay(150, () => {
       try {
         robot.typeStringDelayed(text, 0); // 0 delay = maximum speed
         const totalTime = Date.now() - startTime;
         if (logger) logger.typing('✓ Typed with robotjs.typeStringDelayed (0ms)', { total_duration_ms: totalTime });
         console.log(`✓ Typed successfully in ${totalTime}ms`);
+        return true;
       } catch (e) {
         if (logger) logger.typingError('robotjs.typeStringDelayed failed', e);
+        return false;
       }
-    }, 150);
-    return true;
+    });
   }
   
   // FINAL FALLBACK: Clipboard only (no robotjs available)
@@ -1183,71 +1240,75 @@ function typeStringRobot(text) {
       console.error('Failed to copy to clipboard:', clipErr);
     }
   }
-  
-  return true;
+  return Promise.resolve(false);
 }
 
-// Clipboard + Ctrl+V method (extracted for reuse)
+// Clipboard + Ctrl+V method; resolves once the paste keystroke has been sent, or returns
+// null if the clipboard couldn't be written. Only one runs at a time (the output queue
+// waits for it), so a later paste can't overwrite the clipboard before its Ctrl+V lands.
+// Nothing else may write the clipboard while the queue is busy: the manual-paste copy of
+// a final goes through copyWhenTyped()
 function typeStringRobotClipboard(text, startTime = Date.now()) {
   if (!text || text.trim() === '') {
-    return false;
+    return Promise.resolve(false);
   }
   
   // Write to clipboard synchronously (fast)
   try {
     clipboard.writeText(text);
     if (logger) logger.typing('Text copied to clipboard', { duration_ms: Date.now() - startTime });
-    
-    // CRITICAL: Small delay to ensure window is fully hidden and focus has switched
-    // Windows needs a moment to switch focus to the previous application
-    setTimeout(() => {
-      try {
-        // Use correct robotjs syntax for Ctrl+V on Windows
-        if (robot && robot.keyTap) {
-          if (process.platform === 'win32') {
-            robot.keyTap('v', 'control');
-            console.log('✓ Sent Ctrl+V paste command');
-          } else if (process.platform === 'darwin') {
-            robot.keyTap('v', 'command');
-            console.log('✓ Sent Cmd+V paste command');
-          } else {
-            robot.keyTap('v', 'control');
-            console.log('✓ Sent Ctrl+V paste command');
-          }
-          const totalTime = Date.now() - startTime;
-          if (logger) logger.typing('✓ Pasted instantly with Ctrl+V', { total_duration_ms: totalTime });
-          console.log(`✓ Typed instantly in ${totalTime}ms (clipboard method)`);
-        } else {
-          console.warn('⚠ robotjs not available - Text is in clipboard (use Ctrl+V manually)');
-        }
-      } catch (pasteErr) {
-        if (logger) logger.typingError('Paste failed', pasteErr);
-        console.error('❌ Paste failed:', pasteErr.message || pasteErr);
-        console.warn('Text is in clipboard, use Ctrl+V manually');
-      }
-    }, 200); // 200ms delay to ensure focus has switched
-    return true;
   } catch (clipErr) {
     if (logger) logger.typingError('Clipboard failed', clipErr);
     console.error('Failed to copy to clipboard:', clipErr);
-    return false;
+    return null;
   }
+  
+  // CRITICAL: Small delay to ensure window is fully hidden and focus has switched
+  // Windows needs a moment to switch focus to the previous application
+  return afterDelay(200, () => {
+    try {
+      // robotjs keyTap syntax: keyTap(key, [modifier1, modifier2])
+      if (robot && robot.keyTap) {
+        if (process.platform === 'darwin') {
+          // Mac uses Command
+          robot.keyTap('v', 'command');
+          console.log('✓ Sent Cmd+V paste command');
+        } else {
+          // Windows and Linux use Ctrl
+          robot.keyTap('v', 'control');
+          console.log('✓ Sent Ctrl+V paste command');
+        }
+        const totalTime = Date.now() - startTime;
+        if (logger) logger.typing('✓ Pasted instantly with Ctrl+V', { total_duration_ms: totalTime });
+        console.log(`✓ Typed instantly in ${totalTime}ms (clipboard method)`);
+        return true;
+      }
+      console.warn('⚠ robotjs not available - Text is in clipboard (use Ctrl+V manually)');
+      return false;
+    } catch (pasteErr) {
+      if (logger) logger.typingError('Paste failed', pasteErr);
+      console.error('❌ Paste failed:', pasteErr.message || pasteErr);
+      console.warn('Text is in clipboard, use Ctrl+V manually');
+      // Try alternative syntax if first attempt failed
+      if (process.platform === 'win32') {
+        try {
+          console.log('Trying alternative robotjs syntax...');
+          robot.keyTap('v', ['control']);
+          return true;
+        } catch (altErr) {
+          console.error('Alternative syntax also failed:', altErr.message || altErr);
+        }
+      }
+      return false;
+    }
+  });
 }
 
 // Removed typeDelta - we now type the full final text instead of deltas
 
 function getLastTranscript() {
-  try {
-    if (fs.existsSync(historyPath)) {
-      const arr = JSON.parse(fs.readFileSync(historyPath, 'utf8')) || [];
-      if (arr.length > 0) {
-        return arr[arr.length - 1].text;
-      }
-    }
-  } catch (e) {
-    console.error('Failed to get last transcript:', e);
-  }
-  return null;
+  const latest = historyStore.last();
+  return latest ? latest.text : null;
 }
 
 function pasteLastTranscript() {
@@ -1257,7 +1318,11 @@ function pasteLastTranscript() {
     if (mainWindow && mainWindow.isVisible()) {
       mainWindow.hide();
     }
-    // Type the text system-wide
+    // Type the text system-wide; the injector waits for focus itself
+    if (injectorReady) {
+      typeStringRobot(lastText);
+      return;
+    }
     setTimeout(() => {
       typeStringRobot(lastText);
     }, 100);
@@ -1509,6 +1574,77 @@ function createTray() {
   });
 }
 
+// Model the running service falls back to if a LOAD_MODEL fails
+let whisperSwapFallbackModel = null;
+
+// Switch the running service to another model without restarting it.
+// The old model keeps serving until the new one is loaded ("EVENT: READY").
+function switchWhisperModel(modelName, previousModel) {
+  if (!whisperProcess || whisperProcess.killed) {
+    ensureWhisperService();
+    return;
+  }
+  whisperSwapFallbackModel = previousModel || null;
+  if (logger) logger.whisper('Hot-swapping whisper model', { from: previousModel, to: modelName });
+  if (mainWindow && !mainWindow.isDestroyed()) {
+    mainWindow.webContents.send('whisper-loading', { model: modelName, hotSwap: true });
+  }
+  writeToWhisper(`LOAD_MODEL ${modelName}\n`);
+}
+
+// Benchmark compute type / threads for a model once per host (system_utils.py tune).
+// Runs at low priority; the service uses the result the next time it loads that model.
+// A model whose tuning failed is not retried for a week (every READY would respawn it)
+const WHISPER_TUNE_RETRY_MS = 7 * 24 * 60 * 60 * 1000;
+let whisperTuneProcess = null;
+function recordWhisperTuningFailure(modelName, error) {
+  if (logger) logger.whisperError(`Whisper tuning failed for ${modelName}`, error);
+  const failed = { ...appSettingsStore.get('whisper_tuning_failed') };
+  failed[modelName] = { error: String(error), at: Date.now() };
+  appSettingsStore.set({ whisper_tuning_failed: failed });
+}
+
+function maybeTuneWhisperModel(modelName) {
+  if (!modelName || whisperTuneProcess) return;
+  // system_utils.py writes the result straight to the file; the store's watch picks it up
+  const tuning = appSettingsStore.get('whisper_tuning');
+  if (tuning && tuning[modelName]) return;
+  const failure = appSettingsStore.get('whisper_tuning_failed')[modelName];
+  if (failure && Date.now() - failure.at < WHISPER_TUNE_RETRY_MS) return;
+  const pythonCmd = findPythonExecutable();
+  if (!pythonCmd) return;
+
+  if (logger) logger.whisper('Tuning whisper model for this host', { model: modelName });
+  const startedAt = Date.now();
+  whisperTuneProcess = spawn(pythonCmd, [path.join(__dirname, 'system_utils.py'), 'tune', modelName], {
+    stdio: ['ignore', 'pipe', 'pipe'],
+    shell: process.platform === 'win32',
+    cwd: __dirname
+  });
+  // Benchmark processes inherit this, so dictation keeps priority. Not permitted on
+  // some systems - tuning still works there, it just competes for CPU.
+  cpuBudget.applyPriority('background', whisperTuneProcess.pid);
+  let output = '';
+  whisperTuneProcess.stdout.on('data', (data) => {
+    output += data.toString();
+  });
+  whisperTuneProcess.on('close', (code) => {
+    whisperTuneProcess = null;
+    let result = null;
+    try {
+      result = JSON.parse(output.trim());
+    } catch (e) {
+      recordWhisperTuningFailure(modelName, `exit code ${code}`);
+      return;
+    }
+    if (!result.best) {
+      recordWhisperTuningFailure(modelName, result.error || 'no usable benchmark run');
+      return;
+    }
+    if (logger) logger.whisper('Whisper tuning finished', { model: modelName, best: result.best, seconds: Math.round((Date.now() - startedAt) / 1000) });
+  });
+}
+
 function ensureWhisperService() {
   // CRITICAL: Don't restart service if recording is active - this causes interruptions
   if (isRecording) {
@@ -1551,6 +1687,8 @@ function ensureWhisperService() {
   // Set WHISPER_MODEL environment variable
   const env = { ...process.env };
   env.WHISPER_MODEL = settings.activeModel || 'tiny';
+  env.SONU_IPC = WHISPER_IPC_FRAMED ? 'framed' : 'text';
+  Object.assign(env, cpuBudget.envFor('whisper'));
   
   try {
     whisperProcess = spawn(pythonCmd, [pythonScript], { 
@@ -1559,6 +1697,8 @@ function ensureWhisperService() {
       env: env,
       cwd: __dirname  // Set working directory to ensure relative paths work
     });
+    cpuBudget.applyPriority('whisper', whisperProcess.pid);
+    if (logger) logger.whisper('CPU budget', cpuBudget.plan);
   } catch (error) {
     const errorMsg = `Failed to spawn whisper service: ${error.message}`;
     console.error(errorMsg);
@@ -1572,6 +1712,7 @@ function ensureWhisperService() {
   
   // Reset buffer when creating new process
   whisperStdoutBuffer = '';
+  whisperFrameDecoder.reset();
   
   // Add error handler for spawn failures
   whisperProcess.on('error', (error) => {
@@ -1596,22 +1737,22 @@ function ensureWhisperService() {
   
   whisperProcess.stdout.on('data', (data) => {
     // Handle data that might come in chunks
-    whisperStdoutBuffer += data.toString();
-    const lines = whisperStdoutBuffer.split('\n');
-    // Keep the last incomplete line in buffer
-    whisperStdoutBuffer = lines.pop() || '';
+    // Frames decoded before any corruption are still handled below
+    const messages = readWhisperMessages(data);
+    if (WHISPER_IPC_FRAMED) {
+      checkFrameStream(whisperFrameDecoder, 'Whisper', whisperProcess, () => setTimeout(() => {
+        if (!whisperProcess && !isRecording) ensureWhisperService();
+      }, 1000));
+    }
     
-    for (const line of lines) {
-      const raw = line.trim();
-      if (!raw) continue;
-      
+    for (const msg of messages) {
       // Handle live partial updates - TYPE INCREMENTALLY FOR INSTANT OUTPUT
-      if (raw.startsWith('PARTIAL:')) {
+      if (msg.type === 'partial') {
         // CRITICAL: Capture isNotesRecording state IMMEDIATELY (before any async operations)
         // This ensures we know if it was notes recording even if flag gets reset
         const wasNotesRecordingPartial = isNotesRecording;
         
-        const partial = raw.slice(8).trim();
+        const partial = (msg.text || '').trim();
         try { mainWindow.webContents.send('transcription-partial', partial); } catch (e) {}
         
         // Check if continuous dictation is enabled
@@ -1634,7 +1775,7 @@ function ensureWhisperService() {
           } else if (continuousDictationEnabled && isRecording) {
             // Continuous dictation mode: Type partials live/incrementally while dictating
             console.log('Continuous dictation: typing partials live');
-            typeIncrementalText(transformedPartial, true); // true = isPartial
+            typeIncrementalText(transformedPartial, true, msg.words); // true = isPartial
           } else if (!continuousDictationEnabled && isRecording) {
             // Normal mode (continuous dictation OFF): Don't type partials, wait for final
             console.log('Normal mode: storing partial, waiting for final transcription');
@@ -1656,6 +1797,7 @@ function ensureWhisperService() {
               // The final transcription will handle any corrections
               typeStringRobot(transformedPartial);
               lastTypedText = transformedPartial;
+              lastTypedTimes = msg.words || null;
             } else if (isReleasePartial && wasNotesRecordingPartial) {
               // Notes recording: Don't type partials, just log
               console.log('Notes recording: skipping release partial typing, text will go to Notes UI');
@@ -1665,8 +1807,8 @@ function ensureWhisperService() {
         continue;
       }
       // Immediate release event: hide indicator INSTANTLY - ULTRA FAST
-      if (raw.startsWith('EVENT:')) {
-        const evt = raw.slice(6).trim().toUpperCase();
+      if (msg.type === 'event') {
+        const evt = msg.name;
         if (evt === 'READY') {
           // Model is loaded and ready
           whisperModelReady = true;
@@ -1679,6 +1821,10 @@ function ensureWhisperService() {
           // Send experimental settings when model is ready
           sendExperimentalSettings();
           
+          // First run on this host for this model: tune it once dictation has settled
+          const readyModel = settings.activeModel;
+          setTimeout(() => cpuBudget.whenIdle(() => maybeTuneWhisperModel(readyModel)), 60000);
+          
           // Pre-configure hold keys now that model is ready
           // Small delay to ensure service is fully initialized before configuring keys
           setTimeout(() => {
@@ -1694,7 +1840,10 @@ function ensureWhisperService() {
             console.log('⚡ Executing queued recording action');
             const action = pendingRecordingAction;
             pendingRecordingAction = null;
-            
+            // The hotkey was pressed before the model loaded; a START sent without its timestamp
+            // keeps model-load time out of the capture latency samples
+            recordingRequestedAt = 0;
+
             // Execute the queued action immediately
             setImmediate(() => {
               action();
@@ -1702,6 +1851,33 @@ function ensureWhisperService() {
           }
           continue;
         }
+        if (evt === 'CAPTURE_LATENCY') {
+          // args: [hotkey->first sample ms, START->first sample ms] (-1 = unknown)
+          const [hotkeyMs, startMs] = msg.args.map(Number);
+          if (logger) logger.whisper('Capture latency', { hotkey_to_first_sample_ms: hotkeyMs, start_to_first_sample_ms: startMs });
+          if (performanceMonitor) performanceMonitor.recordCaptureLatency(hotkeyMs >= 0 ? hotkeyMs : startMs);
+          continue;
+        }
+        if (evt === 'LOAD_FAILED') {
+          // args: [model] - the service is still serving the previous model
+          const failedModel = msg.args[0];
+          if (logger) logger.whisperError(`Model hot swap to ${failedModel} failed, still using ${whisperSwapFallbackModel || 'previous model'}`);
+          console.error(`✗ Failed to switch to model ${failedModel}`);
+          if (whisperSwapFallbackModel) {
+            settings.activeModel = whisperSwapFallbackModel;
+            saveSettings();
+          }
+          if (mainWindow && !mainWindow.isDestroyed()) {
+            mainWindow.webContents.send('whisper-ready', { model: settings.activeModel });
+          }
+          continue;
+        }
+        if (evt === 'CASCADE') {
+          // args: ['ON', draft model, resident MB] or ['OFF']
+          const [state, draft, residentMb] = msg.args;
+          if (logger) logger.whisper('Model cascade', { enabled: state === 'ON', draft, resident_mb: Number(residentMb) || undefined });
+          continue;
+        }
         if (evt === 'ERROR') {
           // Model failed to load
           if (logger) logger.whisperError('Whisper model failed to load');
@@ -1729,6 +1905,7 @@ function ensureWhisperService() {
           continue;
         }
         if (evt === 'RELEASE') {
+          cpuBudget.setPhase('decode');
           // CRITICAL: Check if this is notes recording BEFORE hiding anything
           const wasNotesRecording = isNotesRecording;
           
@@ -1781,8 +1958,12 @@ function ensureWhisperService() {
         }
         continue;
       }
+      if (msg.type !== 'final') continue;
       // Regular transcription text (final text after release/stop)
-      const text = raw;
+      recordUtteranceTimings(msg);
+      const text = (msg.text || '').trim();
+      // Decoding is done; the LLM (if enabled) and typing follow
+      if (cpuBudget.phase === 'decode') cpuBudget.setPhase(text ? 'transform' : 'idle');
       if (text) {
         console.log('Received final transcription text:', text);
         
@@ -1792,14 +1973,21 @@ function ensureWhisperService() {
         const wasNotesRecording = isNotesRecording;
         console.log('📝 Transcription received - wasNotesRecording:', wasNotesRecording, 'isNotesRecording:', isNotesRecording);
         
+        // Stream LLM output straight into the typer when nothing of this utterance has been
+        // typed yet, so the first characters appear at the first token instead of after
+        // the whole generation. Live-typed partials (continuous dictation) and Notes
+        // recordings keep the non-streamed path.
+        const streamToTyper = !wasNotesRecording && !lastTypedText && !isContinuousDictationEnabled();
+        const onStream = streamToTyper ? (textSoFar) => typeIncrementalText(textSoFar, false) : null;
+
         // Apply style transformation to final text (async - may use LLM if enabled)
-        transformText(text).then(transformedText => {
+        transformText(text, onStream).then(transformedText => {
           // Use the captured wasNotesRecording value (don't check isNotesRecording again)
           
           // Ensure text is available for manual paste as a fallback (use transformed text)
           // BUT: Don't copy to clipboard for notes recording (text should stay in Notes UI)
           if (!wasNotesRecording) {
-            try { clipboard.writeText(transformedText); } catch (e) {}
+            copyWhenTyped(transformedText);
           }
           appendHistory(transformedText);
           mainWindow.webContents.send('transcription', transformedText);
@@ -1897,16 +2085,13 @@ function ensureWhisperService() {
                 lastTypedText = '';
               } else {
                 // Normal mode (continuous dictation OFF): Type the complete final transcription
-                // BUT: If we already typed a partial on STOP, only type the delta
+                // BUT: If we already typed a partial on STOP, only correct it into the final
                 // CRITICAL: Don't type for notes recording - text should only go to Notes UI
                 if (!wasNotesRecording) {
-                  if (lastTypedText && transformedText.startsWith(lastTypedText)) {
-                    // We already typed a partial, just type the delta
-                    const delta = transformedText.slice(lastTypedText.length);
-                    if (delta && delta.trim().length > 0) {
-                      console.log('Normal mode: typing final delta:', delta.substring(0, 50));
-                      typeStringRobot(delta);
-                      lastTypedText = transformedText;
+                  if (lastTypedText) {
+                    const delta = typeIncrementalText(transformedText, false);
+                    if (delta) {
+                      console.log('Normal mode: typing final correction:', delta.substring(0, 50));
                     } else {
                       console.log('Normal mode: All text already typed from partial');
                     }
@@ -1928,11 +2113,7 @@ function ensureWhisperService() {
             console.error('Failed to type text:', e);
             // Fallback: ensure text is in clipboard (unless Notes recording)
             if (!isNotesRecording) {
-              try {
-                clipboard.writeText(transformedText);
-              } catch (clipErr) {
-                console.error('Failed to copy to clipboard:', clipErr);
-              }
+              copyWhenTyped(transformedText);
             }
             // Reset on error
             lastTypedText = '';
@@ -1947,7 +2128,7 @@ function ensureWhisperService() {
           
           // Don't copy to clipboard for notes recording
           if (!wasNotesRecording) {
-            try { clipboard.writeText(fallbackText); } catch (e) {}
+            copyWhenTyped(fallbackText);
           }
           appendHistory(fallbackText);
           mainWindow.webContents.send('transcription', fallbackText);
@@ -1969,7 +2150,7 @@ function ensureWhisperService() {
             // Type the fallback text (only for non-notes recording)
             typeStringRobot(fallbackText);
           }
-        });
+        }).finally(() => cpuBudget.endPhase('transform'));
       }
     }
   });
@@ -1985,6 +2166,7 @@ function ensureWhisperService() {
 
   whisperProcess.on('exit', (code) => {
     console.log('Whisper service exited with code', code);
+    cpuBudget.setPhase('idle');
     const wasRecording = isRecording; // Capture state before resetting
     const wasNotesRecording = isNotesRecording; // Capture notes recording state
     whisperProcess = null;
@@ -2045,7 +2227,82 @@ function ensureWhisperService() {
   });
 }
 
+// Split a stdout chunk into protocol messages ({ type: 'partial' | 'final' | 'event', ... })
+function readWhisperMessages(data) {
+  if (WHISPER_IPC_FRAMED) {
+    return whisperFrameDecoder.push(data);
+  }
+  whisperStdoutBuffer += data.toString();
+  const lines = whisperStdoutBuffer.split('\n');
+  // Keep the last incomplete line in buffer
+  whisperStdoutBuffer = lines.pop() || '';
+  return lines.map(parseTextLine).filter(Boolean);
+}
+
+// Reports frames the decoder skipped and, if the stream is corrupt (stray bytes on the
+// service's stdout), kills the process - there is no frame boundary to resync on.
+// restart() runs once it has exited. Returns true if the process is being restarted.
+function checkFrameStream(decoder, name, proc, restart) {
+  if (decoder.skipped) {
+    console.error(`Skipped ${decoder.skipped} invalid ${name} frame(s):`, decoder.lastSkipError);
+    if (logger) logger.error(`Invalid ${name} frame skipped`, decoder.lastSkipError);
+    decoder.skipped = 0;
+  }
+  if (!decoder.error || !proc || proc.frameRestart) return false;
+  console.error(`${name} frame stream corrupted, restarting:`, decoder.error.message);
+  if (logger) logger.error(`${name} frame stream corrupted, restarting`, decoder.error);
+  proc.frameRestart = true;
+  if (restart) proc.once('exit', restart);
+  try { proc.kill(); } catch (e) {}
+  return true;
+}
+
+// Commands are written as text lines; in framed mode each gets a request id
+function encodeWhisperCommand(command) {
+  if (!WHISPER_IPC_FRAMED) return command;
+  const cmd = command.trim();
+  const id = ++whisperRequestSeq;
+  if (cmd === 'START' || cmd.startsWith('START ')) {
+    whisperUtterances.set(id, { hotkeyAt: recordingRequestedAt || Date.now(), sentAt: Date.now() });
+    // Only the latest few utterances can still be waiting for a final
+    if (whisperUtterances.size > 16) {
+      whisperUtterances.delete(whisperUtterances.keys().next().value);
+    }
+  }
+  return encodeFrame({ id, cmd });
+}
+
+// Per-utterance latency from a framed final; the service's times are monotonic ms
+function recordUtteranceTimings(msg) {
+  if (!msg.times || msg.request_id == null) return;
+  const utterance = whisperUtterances.get(msg.request_id);
+  whisperUtterances.delete(msg.request_id);
+  const times = msg.times;
+  const span = (from, to) => (Number.isFinite(times[from]) && Number.isFinite(times[to]) ? Math.round(times[to] - times[from]) : undefined);
+  const breakdown = {
+    request_id: msg.request_id,
+    audio_ms: msg.audio_ms,
+    first_sample_ms: span('start', 'first_sample'),
+    capture_ms: span('start', 'stop'),
+    queue_ms: span('stop', 'decode_start'),
+    decode_ms: span('decode_start', 'decode_end'),
+    release_to_final_ms: Number.isFinite(times.stop) ? Math.round(msg.ts - times.stop) : undefined,
+    hotkey_to_final_ms: utterance ? Date.now() - utterance.hotkeyAt : undefined,
+    segments: Array.isArray(msg.segments) ? msg.segments.length : undefined,
+    decoder: msg.decoder,
+    model: msg.model
+  };
+  if (logger) logger.whisper('Utterance latency', breakdown);
+  if (performanceMonitor) performanceMonitor.recordUtteranceLatency(breakdown);
+}
+
 function writeToWhisper(command) {
+  const verb = command.trim().split(/\s+/)[0];
+  if (verb === 'START') {
+    cpuBudget.setPhase('capture');
+    typingUtterance++;
+    rememberTypingTarget();
+  } else if (verb === 'STOP') cpuBudget.setPhase('decode');
   if (!whisperProcess || whisperProcess.killed) {
     // CRITICAL: Don't restart service if recording is active - this causes interruptions
     if (isRecording) {
@@ -2063,7 +2320,7 @@ function writeToWhisper(command) {
     const tryWrite = () => {
       if (whisperProcess && !whisperProcess.killed) {
         try {
-          whisperProcess.stdin.write(command);
+          whisperProcess.stdin.write(encodeWhisperCommand(command));
           console.log('Sent command to whisper:', command.trim());
         } catch (e) {
           console.error('Failed to write to whisper stdin:', e);
@@ -2085,7 +2342,7 @@ function writeToWhisper(command) {
     return;
   }
   try {
-    whisperProcess.stdin.write(command);
+    whisperProcess.stdin.write(encodeWhisperCommand(command));
     console.log('Sent command to whisper:', command.trim());
   } catch (e) {
     console.error('Failed to write to whisper stdin:', e);
@@ -2098,7 +2355,7 @@ function writeToWhisper(command) {
       setTimeout(() => {
         if (whisperProcess && !whisperProcess.killed && !isRecording) {
           try {
-            whisperProcess.stdin.write(command);
+            whisperProcess.stdin.write(encodeWhisperCommand(command));
             console.log('Retry: Sent command to whisper:', command.trim());
           } catch (retryErr) {
             console.error('Retry failed:', retryErr);
@@ -2111,49 +2368,22 @@ function writeToWhisper(command) {
 
 // Function to get continuous dictation setting
 function isContinuousDictationEnabled() {
-  const appSettingsPath = path.join(app.getPath('userData'), 'app-settings.json');
-  try {
-    if (fs.existsSync(appSettingsPath)) {
-      const raw = fs.readFileSync(appSettingsPath, 'utf8');
-      const appSettings = JSON.parse(raw);
-      return appSettings.continuous_dictation || false;
-    }
-  } catch (e) {
-    console.error('Error loading app settings for continuous dictation:', e);
-  }
-  return false;
+  return appSettingsStore.get('continuous_dictation');
 }
 
 // Function to get text style setting
 function getTextStyle() {
-  const appSettingsPath = path.join(app.getPath('userData'), 'app-settings.json');
-  try {
-    if (fs.existsSync(appSettingsPath)) {
-      const raw = fs.readFileSync(appSettingsPath, 'utf8');
-      const appSettings = JSON.parse(raw);
-      return appSettings.text_style || 'none';
-    }
-  } catch (e) {
-    console.error('Error loading app settings for text style:', e);
-  }
-  return 'none';
+  return appSettingsStore.get('text_style');
 }
 
 // Function to detect context and update category automatically
 async function detectAndUpdateContext() {
   try {
-    const detectedCategory = await detectContextCategory();
+    const detectedCategory = detectContextCategory();
     if (detectedCategory) {
-      const appSettingsPath = path.join(app.getPath('userData'), 'app-settings.json');
-      let appSettings = {};
-      if (fs.existsSync(appSettingsPath)) {
-        const raw = fs.readFileSync(appSettingsPath, 'utf8');
-        appSettings = JSON.parse(raw);
-      }
       // Only update if different from current
-      if (appSettings.text_style_category !== detectedCategory) {
-        appSettings.text_style_category = detectedCategory;
-        fs.writeFileSync(appSettingsPath, JSON.stringify(appSettings, null, 2));
+      if (getTextStyleCategory() !== detectedCategory) {
+        appSettingsStore.set({ text_style_category: detectedCategory });
         console.log(`✓ Auto-detected context: ${detectedCategory}`);
         // Notify renderer to update UI if style page is open
         if (mainWindow && !mainWindow.isDestroyed()) {
@@ -2168,97 +2398,108 @@ async function detectAndUpdateContext() {
   return null;
 }
 
-// Helper function to detect context category (same logic as IPC handler)
+// Category of the app in the foreground, from the focus watcher's cache (no subprocess)
 function detectContextCategory() {
+  return focusWatcher.category();
+}
+
+// Function to get text style category
+function getTextStyleCategory() {
+  return appSettingsStore.get('text_style_category');
+}
+
+// Function to check if LLM processing is enabled
+function isLLMProcessingEnabled() {
+  return appSettingsStore.get('llm_processing');
+}
+
+// LLM requests awaiting a framed result: id -> { resolve, timer }
+const llmRequests = new Map();
+const llmFrameDecoder = new FrameDecoder();
+let llmRequestSeq = 0;
+// Transforms allowed in flight; beyond this the oldest is cancelled so new dictation isn't starved
+const LLM_MAX_IN_FLIGHT = 4;
+const LLM_TIMEOUT_MS = 5000;
+const LLM_WARM_TIMEOUT_MS = 30000;
+
+function sendLLMRequest(op, fields = {}) {
+  const id = ++llmRequestSeq;
+  llmProcess.stdin.write(encodeFrame({ id, op, ...fields }));
+  return id;
+}
+
+// Resolve with the service's result frame, or null on timeout / service exit.
+// With onToken, the request streams: onToken(textSoFar) runs for every token frame
+// and the timeout restarts on each one, so it bounds the gap between tokens.
+function requestLLM(op, fields = {}, timeoutMs = LLM_TIMEOUT_MS, onToken = null) {
   return new Promise((resolve) => {
+    let id;
     try {
-      // Get active window information
-      // On Windows, use PowerShell to get the active window title
-      if (process.platform === 'win32') {
-        const psCommand = `powershell -Command "Add-Type -TypeDefinition 'using System; using System.Runtime.InteropServices; public class Win32 { [DllImport(\\\"user32.dll\\\")] public static extern IntPtr GetForegroundWindow(); [DllImport(\\\"user32.dll\\\")] public static extern int GetWindowText(IntPtr hWnd, System.Text.StringBuilder text, int count); } $hwnd = [Win32]::GetForegroundWindow(); $sb = New-Object System.Text.StringBuilder 256; [Win32]::GetWindowText($hwnd, $sb, $sb.Capacity) | Out-Null; $sb.ToString()"`;
-        try {
-          const activeWindowTitle = execSync(psCommand, { encoding: 'utf8', timeout: 1000 }).trim().toLowerCase();
-          
-          // Map window titles to categories
-          const emailApps = ['outlook', 'gmail', 'thunderbird', 'mail', 'apple mail', 'spark'];
-          const workMessengers = ['slack', 'teams', 'microsoft teams', 'discord', 'zoom'];
-          const personalMessengers = ['whatsapp', 'telegram', 'signal', 'messenger', 'imessage', 'messages'];
-          
-          if (emailApps.some(app => activeWindowTitle.includes(app))) {
-            resolve('email');
-            return;
-          } else if (workMessengers.some(app => activeWindowTitle.includes(app))) {
-            resolve('work');
-            return;
-          } else if (personalMessengers.some(app => activeWindowTitle.includes(app))) {
-            resolve('personal');
-            return;
-          }
-        } catch (e) {
-          console.warn('Context detection command failed:', e.message);
-        }
-      } else if (process.platform === 'darwin') {
-        // macOS - use AppleScript
-        try {
-          const script = `osascript -e 'tell application "System Events" to get name of first application process whose frontmost is true'`;
-          const activeApp = execSync(script, { encoding: 'utf8', timeout: 1000 }).trim().toLowerCase();
-          
-          const emailApps = ['mail', 'outlook', 'spark', 'airmail'];
-          const workMessengers = ['slack', 'microsoft teams', 'zoom'];
-          const personalMessengers = ['messages', 'whatsapp', 'telegram', 'signal'];
-          
-          if (emailApps.some(app => activeApp.includes(app))) {
-            resolve('email');
-            return;
-          } else if (workMessengers.some(app => activeApp.includes(app))) {
-            resolve('work');
-            return;
-          } else if (personalMessengers.some(app => activeApp.includes(app))) {
-            resolve('personal');
-            return;
-          }
-        } catch (e) {
-          console.warn('Context detection failed on macOS:', e.message);
-        }
-      }
-      
-      // Default to null if no match (don't change category)
-      resolve(null);
+      id = sendLLMRequest(op, onToken ? { ...fields, stream: true } : fields);
     } catch (e) {
-      console.warn('Context detection failed:', e.message);
+      console.warn('Failed to write to LLM service:', e.message);
       resolve(null);
+      return;
     }
+    const expire = () => {
+      llmRequests.delete(id);
+      if (op === 'transform') cancelLLMRequest(id);
+      resolve(null);
+    };
+    llmRequests.set(id, { resolve, timer: setTimeout(expire, timeoutMs), op, onToken, streamed: '', expire, timeoutMs });
   });
 }
 
-// Function to get text style category
-function getTextStyleCategory() {
-  const appSettingsPath = path.join(app.getPath('userData'), 'app-settings.json');
-  try {
-    if (fs.existsSync(appSettingsPath)) {
-      const raw = fs.readFileSync(appSettingsPath, 'utf8');
-      const appSettings = JSON.parse(raw);
-      return appSettings.text_style_category || 'personal';
-    }
-  } catch (e) {
-    console.error('Error loading app settings for text style category:', e);
+function cancelLLMRequest(id) {
+  const pending = llmRequests.get(id);
+  if (pending) {
+    clearTimeout(pending.timer);
+    llmRequests.delete(id);
+    pending.resolve(null);
+  }
+  if (llmProcess && !llmProcess.killed) {
+    try { sendLLMRequest('cancel', { target: id }); } catch (e) {}
   }
-  return 'personal';
 }
 
-// Function to check if LLM processing is enabled
-function isLLMProcessingEnabled() {
-  const appSettingsPath = path.join(app.getPath('userData'), 'app-settings.json');
-  try {
-    if (fs.existsSync(appSettingsPath)) {
-      const raw = fs.readFileSync(appSettingsPath, 'utf8');
-      const appSettings = JSON.parse(raw);
-      return appSettings.llm_processing || false;
+// Have the service evaluate and keep the prompt prefix for a style/category, so the
+// next transform only evaluates the dictated text
+function warmLLMPrefix(style = getTextStyle(), category = getTextStyleCategory()) {
+  // Background work: wait until no dictation is being captured, decoded or typed
+  cpuBudget.whenIdle(() => {
+    if (!llmProcessReady || !llmProcess || llmProcess.killed || !isLLMProcessingEnabled()) return;
+    requestLLM('warm', { style, category }, LLM_WARM_TIMEOUT_MS).then((result) => {
+      if (result && !result.ok) console.warn('LLM prefix warm-up failed:', result.error);
+    });
+  });
+}
+
+function handleLLMMessage(msg) {
+  if (msg.type === 'event' && msg.name === 'READY') {
+    llmProcessReady = true;
+    console.log('✓ LLM model loaded');
+    warmLLMPrefix();
+    return;
+  }
+  if (msg.type === 'token') {
+    const streaming = llmRequests.get(msg.id);
+    if (!streaming || !streaming.onToken) return;
+    clearTimeout(streaming.timer);
+    streaming.timer = setTimeout(streaming.expire, streaming.timeoutMs);
+    streaming.streamed += msg.text || '';
+    try {
+      streaming.onToken(streaming.streamed);
+    } catch (e) {
+      console.error('LLM token handler failed:', e);
     }
-  } catch (e) {
-    console.error('Error loading app settings for LLM processing:', e);
+    return;
   }
-  return false;
+  if (msg.type !== 'result') return;
+  const pending = llmRequests.get(msg.id);
+  if (!pending) return; // timed out or cancelled
+  clearTimeout(pending.timer);
+  llmRequests.delete(msg.id);
+  pending.resolve(msg);
 }
 
 // Function to ensure LLM service is running
@@ -2282,43 +2523,55 @@ function ensureLLMService() {
   try {
     llmProcess = spawn(pythonCmd, [llmScript], {
       stdio: ['pipe', 'pipe', 'pipe'],
-      cwd: __dirname
+      cwd: __dirname,
+      env: { ...process.env, SONU_IPC: 'framed', ...cpuBudget.envFor('llm') }
     });
+    cpuBudget.applyPriority('llm', llmProcess.pid);
 
-    llmProcess.stdout.setEncoding('utf8');
     llmProcess.stderr.setEncoding('utf8');
     llmProcessReady = false;
+    llmFrameDecoder.reset();
+
+    const thisProcess = llmProcess;
+    llmProcess.stdout.on('data', (data) => {
+      const messages = llmFrameDecoder.push(data);
+      // Restarted lazily by the next transform
+      checkFrameStream(llmFrameDecoder, 'LLM', thisProcess);
+      messages.forEach(handleLLMMessage);
+    });
 
     // Check if model exists and load it
-    llmProcess.stdin.write('CHECK\n');
-    
-    llmProcess.stdout.once('data', (data) => {
-      try {
-        const result = JSON.parse(data.toString().trim());
-        if (result.exists && result.ready) {
-          llmProcessReady = true;
-          console.log('✓ LLM service ready');
-        } else if (result.exists) {
-          // Model exists but not loaded, try to load
-          llmProcess.stdin.write('LOAD\n');
-        }
-      } catch (e) {
-        // Not JSON, ignore
+    requestLLM('check').then((result) => {
+      if (!result) return;
+      if (result.exists && result.ready) {
+        llmProcessReady = true;
+        console.log('✓ LLM service ready');
+        warmLLMPrefix();
+      } else if (result.exists) {
+        // Model exists but not loaded yet: the service loads it on startup and sends READY
+        console.log('LLM model loading...');
       }
     });
 
     llmProcess.stderr.on('data', (data) => {
       const msg = data.toString();
-      if (msg.includes('loaded successfully')) {
-        llmProcessReady = true;
-        console.log('✓ LLM model loaded');
+      if (msg.includes('ERROR')) {
+        console.warn('LLM service:', msg.trim());
       }
     });
 
     llmProcess.on('exit', (code) => {
       console.log('LLM service exited with code', code);
-      llmProcess = null;
-      llmProcessReady = false;
+      if (llmProcess === thisProcess) {
+        llmProcess = null;
+        llmProcessReady = false;
+      }
+      // Nothing will answer the outstanding requests now
+      for (const [id, pending] of llmRequests) {
+        clearTimeout(pending.timer);
+        pending.resolve(null);
+        llmRequests.delete(id);
+      }
     });
 
     return true;
@@ -2329,41 +2582,368 @@ function ensureLLMService() {
   }
 }
 
-// Function to transform text using LLM service
-async function transformTextWithLLM(text, style, category = 'personal') {
+// Function to transform text using LLM service.
+// onText(textSoFar) streams the cleaned output as it is generated; a successful
+// result is always an extension of what it was given.
+async function transformTextWithLLM(text, style, category = 'personal', onText = null) {
   if (!llmProcess || llmProcess.killed) {
     if (!ensureLLMService()) {
       return null;
     }
   }
 
+  // Bounded in-flight: drop the oldest transform rather than queue behind it
+  const inFlight = [...llmRequests.entries()].filter(([, pending]) => pending.op === 'transform');
+  if (inFlight.length >= LLM_MAX_IN_FLIGHT) {
+    cancelLLMRequest(inFlight[0][0]);
+  }
+
+  const result = await requestLLM('transform', { style, category, text }, LLM_TIMEOUT_MS, onText);
+  if (!result || !result.ok) {
+    if (result && logger) logger.info(`LLM transform skipped: ${result.error}`);
+    return null;
+  }
+  if (logger && result.first_ms != null) {
+    logger.info(`LLM transform: first token ${result.first_ms} ms, total ${result.ms} ms`);
+  }
+  return (result.text || '').trim() || null;
+}
+
+// Sidecar host: one long-lived Python process for system_utils / model_manager /
+// translation calls, instead of a fresh interpreter per IPC call
+let sidecarProcess = null;
+let sidecarStopping = false;
+// Requests awaiting a framed result: id -> { resolve, timer, op, startedAt }
+const sidecarRequests = new Map();
+const sidecarFrameDecoder = new FrameDecoder();
+let sidecarRequestSeq = 0;
+let sidecarFailures = 0;
+let sidecarRetryAt = 0;
+const SIDECAR_TIMEOUT_MS = 15000;
+const SIDECAR_MAX_BACKOFF_MS = 60000;
+// The hardware doesn't change while the app runs; the host caches these too, this saves the round trip
+const SIDECAR_CACHED_OPS = new Set(['system_info', 'system_profile', 'suggest_model']);
+const sidecarResults = new Map();
+
+function handleSidecarMessage(msg) {
+  if (msg.type === 'event' && msg.name === 'READY') {
+    sidecarFailures = 0;
+    return;
+  }
+  if (msg.type !== 'result') return;
+  const pending = sidecarRequests.get(msg.id);
+  if (!pending) return; // timed out
+  clearTimeout(pending.timer);
+  sidecarRequests.delete(msg.id);
+  const roundTripMs = Date.now() - pending.startedAt;
+  if (logger) {
+    logger.info(`Sidecar ${pending.op}: ${roundTripMs} ms (host ${msg.ms} ms${msg.cached ? ', cached' : ''})`);
+  }
+  if (performanceMonitor) performanceMonitor.recordSidecarCall(pending.op, roundTripMs, msg.ms);
+  if (!msg.ok) {
+    console.warn(`Sidecar ${pending.op} failed:`, msg.error);
+    pending.resolve(null);
+    return;
+  }
+  pending.resolve(msg.result);
+}
+
+function ensureSidecarHost() {
+  if (sidecarProcess && !sidecarProcess.killed) {
+    return true;
+  }
+  // Back off after crashes so a broken Python install doesn't respawn on every call
+  if (sidecarStopping || Date.now() < sidecarRetryAt) {
+    return false;
+  }
+
+  const pythonCmd = findPythonExecutable();
+  const hostScript = path.join(__dirname, 'sidecar_host.py');
+  if (!pythonCmd || !fs.existsSync(hostScript)) {
+    return false;
+  }
+
+  try {
+    sidecarProcess = spawn(pythonCmd, [hostScript], {
+      stdio: ['pipe', 'pipe', 'pipe'],
+      cwd: __dirname,
+      windowsHide: true
+    });
+    cpuBudget.applyPriority('background', sidecarProcess.pid);
+  } catch (error) {
+    console.error('Failed to start sidecar host:', error);
+    sidecarProcess = null;
+    return false;
+  }
+
+  sidecarFrameDecoder.reset();
+  const thisProcess = sidecarProcess;
+  sidecarProcess.stdout.on('data', (data) => {
+    const messages = sidecarFrameDecoder.push(data);
+    // Restarted by the next call, with the usual backoff
+    checkFrameStream(sidecarFrameDecoder, 'Sidecar host', thisProcess);
+    messages.forEach(handleSidecarMessage);
+  });
+
+  sidecarProcess.stderr.on('data', (data) => {
+    const msg = data.toString();
+    if (msg.includes('ERROR')) {
+      console.warn('Sidecar host:', msg.trim());
+    }
+  });
+
+  let gone = false;
+  const onGone = (reason) => {
+    if (gone) return;
+    gone = true;
+    if (sidecarProcess === thisProcess) {
+      sidecarProcess = null;
+    }
+    if (!sidecarStopping) {
+      sidecarFailures += 1;
+      const backoffMs = Math.min(SIDECAR_MAX_BACKOFF_MS, 1000 * 2 ** (sidecarFailures - 1));
+      sidecarRetryAt = Date.now() + backoffMs;
+      console.warn(`Sidecar host stopped (${reason}); next start allowed in ${backoffMs} ms`);
+    }
+    // Nothing will answer the outstanding requests now; callers fall back
+    for (const [id, pending] of sidecarRequests) {
+      clearTimeout(pending.timer);
+      pending.resolve(null);
+      sidecarRequests.delete(id);
+    }
+  };
+  // A spawn failure (e.g. ENOENT) arrives as 'error' rather than 'exit'
+  sidecarProcess.on('error', (error) => onGone(error.message));
+  sidecarProcess.on('exit', (code) => onGone(`code ${code}`));
+  sidecarProcess.stdin.on('error', (error) => onGone(error.message));
+
+  return true;
+}
+
+// Resolve with the op's result, or null when the host is unavailable, failed or timed out
+function callSidecar(op, args = {}, timeoutMs = SIDECAR_TIMEOUT_MS) {
+  if (SIDECAR_CACHED_OPS.has(op) && sidecarResults.has(op)) {
+    return Promise.resolve(sidecarResults.get(op));
+  }
+  if (!ensureSidecarHost()) {
+    return Promise.resolve(null);
+  }
   return new Promise((resolve) => {
-    const timeout = setTimeout(() => {
-      resolve(null); // Timeout after 5 seconds
-    }, 5000);
-
-    const onData = (data) => {
-      clearTimeout(timeout);
-      llmProcess.stdout.removeListener('data', onData);
-      const transformed = data.toString().trim();
-      resolve(transformed || null);
-    };
+    const id = ++sidecarRequestSeq;
+    try {
+      sidecarProcess.stdin.write(encodeFrame({ id, op, args }));
+    } catch (e) {
+      console.warn('Failed to write to sidecar host:', e.message);
+      resolve(null);
+      return;
+    }
+    const timer = setTimeout(() => {
+      sidecarRequests.delete(id);
+      console.warn(`Sidecar ${op} timed out after ${timeoutMs} ms`);
+      resolve(null);
+    }, timeoutMs);
+    sidecarRequests.set(id, { resolve, timer, op, startedAt: Date.now() });
+  }).then((result) => {
+    if (result !== null && SIDECAR_CACHED_OPS.has(op)) {
+      sidecarResults.set(op, result);
+    }
+    return result;
+  });
+}
 
-    llmProcess.stdout.once('data', onData);
-    // Send category along with style
-    llmProcess.stdin.write(`TRANSFORM:${style}:${category}:${text}\n`);
+function stopSidecarHost() {
+  sidecarStopping = true;
+  if (sidecarProcess && !sidecarProcess.killed) {
+    // Closing stdin lets the host finish in-flight calls and exit on its own
+    try { sidecarProcess.stdin.end(); } catch (e) {}
+    const proc = sidecarProcess;
+    setTimeout(() => { if (!proc.killed) proc.kill(); }, 2000).unref();
+  }
+}
 
-    // Fallback timeout
-    setTimeout(() => {
-      clearTimeout(timeout);
-      llmProcess.stdout.removeListener('data', onData);
+// Text injector (Linux/X11): types into the window that was focused when dictation
+// started and answers once the X server has the key events, so typing needs neither
+// the fixed focus-switch delays below nor a clipboard round trip
+let injectorProcess = null;
+let injectorReady = false;
+let injectorUnavailable = false;
+const injectorRequests = new Map();
+const injectorFrameDecoder = new FrameDecoder();
+let injectorRequestSeq = 0;
+// Window that had focus when the current recording started; 0 when unknown
+let typingTargetWindow = 0;
+const INJECTOR_TIMEOUT_MS = 3000;
+
+function handleInjectorMessage(msg) {
+  if (msg.type === 'event') {
+    if (msg.name === 'READY') {
+      injectorReady = true;
+    } else if (msg.name === 'FOCUS') {
+      focusWatcher.update(msg);
+    } else if (msg.name === 'UNAVAILABLE') {
+      // No X display or no libXtst; this won't change while the app runs
+      injectorUnavailable = true;
+      console.log(`Text injector unavailable: ${msg.reason}`);
+    }
+    return;
+  }
+  if (msg.type !== 'result') return;
+  const pending = injectorRequests.get(msg.id);
+  if (!pending) return;
+  clearTimeout(pending.timer);
+  injectorRequests.delete(msg.id);
+  if (!msg.ok) {
+    console.warn(`Text injector ${pending.op} failed:`, msg.error);
+    pending.resolve(null);
+    return;
+  }
+  pending.resolve(msg.result);
+}
+
+function ensureTextInjector() {
+  if (process.platform !== 'linux' || injectorUnavailable) return false;
+  if (injectorProcess && !injectorProcess.killed) return true;
+
+  const pythonCmd = findPythonExecutable();
+  const injectorScript = path.join(__dirname, 'text_injector.py');
+  if (!pythonCmd || !fs.existsSync(injectorScript)) {
+    injectorUnavailable = true;
+    return false;
+  }
+
+  try {
+    // Normal priority: it sits on the typing path, unlike the sidecar
+    injectorProcess = spawn(pythonCmd, [injectorScript], {
+      stdio: ['pipe', 'pipe', 'pipe'],
+      cwd: __dirname
+    });
+  } catch (error) {
+    console.error('Failed to start text injector:', error);
+    injectorProcess = null;
+    injectorUnavailable = true;
+    return false;
+  }
+
+  injectorReady = false;
+  injectorFrameDecoder.reset();
+  const thisProcess = injectorProcess;
+  injectorProcess.stdout.on('data', (data) => {
+    const messages = injectorFrameDecoder.push(data);
+    checkFrameStream(injectorFrameDecoder, 'Text injector', thisProcess, () => ensureTextInjector());
+    messages.forEach(handleInjectorMessage);
+  });
+  injectorProcess.stderr.on('data', (data) => {
+    const msg = data.toString();
+    if (msg.includes('ERROR')) console.warn('Text injector:', msg.trim());
+  });
+
+  const onGone = () => {
+    if (injectorProcess === thisProcess) {
+      injectorProcess = null;
+      injectorReady = false;
+    }
+    for (const [id, pending] of injectorRequests) {
+      clearTimeout(pending.timer);
+      pending.resolve(null);
+      injectorRequests.delete(id);
+    }
+  };
+  injectorProcess.on('error', (error) => {
+    console.warn('Text injector stopped:', error.message);
+    injectorUnavailable = true;
+    onGone();
+  });
+  injectorProcess.on('exit', onGone);
+  injectorProcess.stdin.on('error', onGone);
+  return true;
+}
+
+// Resolve with the op's result, or null when the injector is unavailable or failed
+function callTextInjector(op, args = {}, timeoutMs = INJECTOR_TIMEOUT_MS) {
+  if (!injectorReady || !injectorProcess || injectorProcess.killed) {
+    return Promise.resolve(null);
+  }
+  return new Promise((resolve) => {
+    const id = ++injectorRequestSeq;
+    try {
+      injectorProcess.stdin.write(encodeFrame({ id, op, args }));
+    } catch (e) {
+      resolve(null);
+      return;
+    }
+    const timer = setTimeout(() => {
+      injectorRequests.delete(id);
+      console.warn(`Text injector ${op} timed out after ${timeoutMs} ms`);
       resolve(null);
-    }, 5000);
+    }, timeoutMs);
+    injectorRequests.set(id, { resolve, timer, op });
   });
 }
 
-// Function to transform text based on style settings
-async function transformText(text) {
+// X11 window id behind an Electron window, for telling our windows from the target
+function nativeWindowId(win) {
+  if (!win || win.isDestroyed()) return 0;
+  try {
+    const handle = win.getNativeWindowHandle();
+    return handle.length >= 8 ? Number(handle.readBigUInt64LE(0)) : handle.readUInt32LE(0);
+  } catch (e) {
+    return 0;
+  }
+}
+
+function ownWindowIds() {
+  return [mainWindow, indicatorWindow].map(nativeWindowId).filter(Boolean);
+}
+
+// Focus sources report X11 window ids (Linux), HWNDs (Windows) or the frontmost pid (macOS)
+const focusWatcher = new FocusWatcher({
+  ignore: ({ window }) => window === process.pid || ownWindowIds().includes(window)
+});
+
+// Called as a recording starts: the focused window is where the text should go
+function rememberTypingTarget() {
+  typingTargetWindow = 0;
+  // The injector's focus events already name the last window outside SONU
+  if (process.platform === 'linux' && focusWatcher.current && focusWatcher.current.window) {
+    typingTargetWindow = focusWatcher.current.window;
+    return;
+  }
+  callTextInjector('focus').then((result) => {
+    const window = result && result.window;
+    if (window && !ownWindowIds().includes(window)) typingTargetWindow = window;
+  });
+}
+
+function stopTextInjector() {
+  if (injectorProcess && !injectorProcess.killed) {
+    try { injectorProcess.stdin.end(); } catch (e) {}
+    const proc = injectorProcess;
+    setTimeout(() => { if (!proc.killed) proc.kill(); }, 2000).unref();
+  }
+}
+
+// Finished transformations of recent finals, so repeated phrases (sign-offs, common
+// replies) skip both the LLM round trip and the rule-based pass
+const transformCache = new TransformCache();
+
+function isTransformCachePersistEnabled() {
+  return appSettingsStore.get('transform_cache_persist');
+}
+
+function configureTransformCache(persist = isTransformCachePersistEnabled()) {
+  const cachePath = path.join(app.getPath('userData'), 'transform-cache.json');
+  if (persist) {
+    transformCache.setPersistPath(cachePath);
+    transformCache.save();
+  } else {
+    transformCache.setPersistPath(null);
+    try { fs.rmSync(cachePath, { force: true }); } catch (e) {}
+  }
+}
+
+// Function to transform text based on style settings.
+// onStream(textSoFar) receives LLM output while it is generated (see transformTextWithLLM).
+async function transformText(text, onStream = null) {
   if (!text || !text.trim()) {
     return text;
   }
@@ -2372,21 +2952,46 @@ async function transformText(text) {
   const category = getTextStyleCategory();
   const useLLM = isLLMProcessingEnabled();
 
+  const cacheSettings = { engine: useLLM ? 'llm' : 'rules', style, category };
+  const cached = transformCache.get(text, cacheSettings);
+  if (cached !== undefined) {
+    if (logger) logger.info('Transform cache hit', transformCache.getStats());
+    return cached;
+  }
+
   // Try LLM transformation if enabled (only for final transcriptions, not partials)
   if (useLLM) {
+    let streamedText = '';
     try {
-      const transformed = await transformTextWithLLM(text, style, category);
-      if (transformed && transformed !== text && transformed.length > 0) {
+      const onText = onStream ? (textSoFar) => {
+        streamedText = textSoFar;
+        onStream(textSoFar);
+      } : null;
+      const transformed = await transformTextWithLLM(text, style, category, onText);
+      if (transformed) {
+        // Once part of the stream is typed, the LLM text is kept even if unchanged
+        const result = transformed !== text || streamedText ? transformed : applyStyle(text, style, category);
         console.log('✓ Text transformed using local LLM');
-        return transformed;
+        transformCache.set(text, cacheSettings, result);
+        return result;
       }
     } catch (error) {
       console.warn('LLM transformation failed, falling back to rule-based:', error.message);
     }
+    if (streamedText) {
+      // Already typed; falling back to other text now would duplicate it. Not cached.
+      console.warn('LLM stream ended early; keeping the streamed text');
+      return streamedText;
+    }
   }
 
   // Fall back to rule-based style transformation
-  return applyStyle(text, style, category);
+  const rulesSettings = { engine: 'rules', style, category };
+  const ruled = useLLM ? transformCache.get(text, rulesSettings) : undefined;
+  if (ruled !== undefined) return ruled;
+  const styled = applyStyle(text, style, category);
+  transformCache.set(text, rulesSettings, styled);
+  return styled;
 }
 
 // Function to send experimental settings to whisper service
@@ -2395,26 +3000,36 @@ function sendExperimentalSettings() {
     return;
   }
   
-  // Load app settings to get experimental feature values
-  const appSettingsPath = path.join(app.getPath('userData'), 'app-settings.json');
-  let appSettings = {};
-  try {
-    if (fs.existsSync(appSettingsPath)) {
-      const raw = fs.readFileSync(appSettingsPath, 'utf8');
-      appSettings = JSON.parse(raw);
-    }
-  } catch (e) {
-    console.error('Error loading app settings for experimental features:', e);
-  }
-  
   // Send experimental settings
-  const continuousDictation = appSettings.continuous_dictation || false;
-  const lowLatency = appSettings.low_latency || false;
-  const noiseReduction = appSettings.noise_reduction || false;
+  const continuousDictation = appSettingsStore.get('continuous_dictation');
+  const lowLatency = appSettingsStore.get('low_latency');
+  const noiseReduction = appSettingsStore.get('noise_reduction');
+  // Audio kept from before the hotkey so the first syllable is never lost (0 = off)
+  const prerollMs = Number.isFinite(appSettingsStore.get('preroll_ms')) ? appSettingsStore.get('preroll_ms') : 500;
   
   writeToWhisper(`SET_CONTINUOUS_DICTATION ${continuousDictation}\n`);
   writeToWhisper(`SET_LOW_LATENCY ${lowLatency}\n`);
   writeToWhisper(`SET_NOISE_REDUCTION ${noiseReduction}\n`);
+  writeToWhisper(`SET_PREROLL_MS ${prerollMs}\n`);
+  // Low latency trades partial accuracy for speed; finals keep the accurate profile
+  writeToWhisper(`SET_PROFILE PARTIAL ${lowLatency ? 'FAST' : 'BALANCED'}\n`);
+  // Opt-in: tiny draft model for live partials; the service refuses it on low-RAM machines
+  writeToWhisper(`SET_CASCADE ${appSettingsStore.get('model_cascade') ? 'ON' : 'OFF'}\n`);
+}
+
+// Runs for changes made through app-settings:set and for edits to the file made elsewhere
+function applyAppSettingChanges(keys) {
+  const changed = new Set(keys);
+  // If experimental settings changed, send them to whisper service
+  if (['continuous_dictation', 'low_latency', 'noise_reduction', 'preroll_ms', 'model_cascade'].some(k => changed.has(k))) {
+    sendExperimentalSettings();
+  }
+  if (changed.has('transform_cache_persist')) {
+    configureTransformCache();
+  }
+  if (changed.has('text_style') || changed.has('text_style_category') || changed.has('llm_processing')) {
+    warmLLMPrefix(getTextStyle(), getTextStyleCategory());
+  }
 }
 
 function registerHotkeys() {
@@ -2564,12 +3179,19 @@ function electronToPythonCombo(accelerator) {
 
 let holdRecordingTimeout = null;
 let isHoldKeyPressed = false;
+let recordingRequestedAt = 0; // Hotkey timestamp of the current recording (for capture latency)
+
+// START carries the hotkey timestamp so the service can report hotkey-to-first-sample latency
+function startCommand() {
+  return `START ${recordingRequestedAt || Date.now()}\n`;
+}
 
 function startHoldRecording() {
   // Prevent multiple calls when key is held down
   if (isHoldKeyPressed || isRecording) {
     return;
   }
+  recordingRequestedAt = Date.now();
   
   // If model not ready, queue this action and show subtle indicator
   if (!whisperModelReady) {
@@ -2620,7 +3242,7 @@ function startHoldRecording() {
             writeToWhisper(`SET_HOLD_KEYS ${pyCombo}\n`);
             setTimeout(() => {
               if (whisperProcess && !whisperProcess.killed && isRecording) {
-                writeToWhisper('START\n');
+                writeToWhisper(startCommand());
               }
             }, 50);
           }
@@ -2669,7 +3291,7 @@ function startHoldRecording() {
         // Another small delay before START to ensure hold keys are registered
         setTimeout(() => {
           if (whisperProcess && !whisperProcess.killed && isRecording) {
-            writeToWhisper('START\n');
+            writeToWhisper(startCommand());
           }
         }, 50);
       }
@@ -2701,7 +3323,7 @@ function startHoldRecording() {
             writeToWhisper(`SET_HOLD_KEYS ${pyCombo}\n`);
             setTimeout(() => {
               if (whisperProcess && !whisperProcess.killed && isRecording) {
-                writeToWhisper('START\n');
+                writeToWhisper(startCommand());
               }
             }, 50);
           }
@@ -2749,6 +3371,7 @@ function startToggleRecording() {
     console.log('⚠ Notes recording active - cannot start toggle recording');
     return;
   }
+  recordingRequestedAt = Date.now();
   
   // If model not ready, queue this action and show indicator
   if (!whisperModelReady) {
@@ -2776,7 +3399,7 @@ function startToggleRecording() {
       
       if (whisperProcess && !whisperProcess.killed) {
         writeToWhisper(`SET_MODE TOGGLE\n`);
-        writeToWhisper('START\n');
+        writeToWhisper(startCommand());
       }
     };
     
@@ -2809,7 +3432,7 @@ function startToggleRecording() {
   // Send commands IMMEDIATELY - Service should already be ready from pre-initialization
   if (whisperProcess && !whisperProcess.killed) {
     writeToWhisper(`SET_MODE TOGGLE\n`);
-    writeToWhisper('START\n');
+    writeToWhisper(startCommand());
   } else {
     // If process not ready, ensure it and send immediately
     ensureWhisperService();
@@ -2817,7 +3440,7 @@ function startToggleRecording() {
     process.nextTick(() => {
       if (whisperProcess && !whisperProcess.killed) {
         writeToWhisper(`SET_MODE TOGGLE\n`);
-        writeToWhisper('START\n');
+        writeToWhisper(startCommand());
       }
     });
   }
@@ -2881,6 +3504,7 @@ function toggleRecording() {
 let isNotesRecording = false;
 
 function startNotesRecording() {
+  recordingRequestedAt = Date.now();
   // If model not ready, queue this action
   if (!whisperModelReady) {
     console.log('⚡ Model loading... queuing notes recording');
@@ -2904,7 +3528,7 @@ function startNotesRecording() {
       
       if (whisperProcess && !whisperProcess.killed) {
         writeToWhisper(`SET_MODE TOGGLE\n`);
-        writeToWhisper('START\n');
+        writeToWhisper(startCommand());
       }
     };
     
@@ -2929,13 +3553,13 @@ function startNotesRecording() {
   // Send commands to start recording
   if (whisperProcess && !whisperProcess.killed) {
     writeToWhisper(`SET_MODE TOGGLE\n`);
-    writeToWhisper('START\n');
+    writeToWhisper(startCommand());
   } else {
     ensureWhisperService();
     setImmediate(() => {
       if (whisperProcess && !whisperProcess.killed) {
         writeToWhisper(`SET_MODE TOGGLE\n`);
-        writeToWhisper('START\n');
+        writeToWhisper(startCommand());
       }
     });
   }
@@ -3006,22 +3630,94 @@ function stopNotesRecording() {
 }
 
 function appendHistory(text) {
-  const entry = { text, ts: Date.now() };
-  try {
-    let arr = [];
-    if (fs.existsSync(historyPath)) {
-      arr = JSON.parse(fs.readFileSync(historyPath, 'utf8')) || [];
-    }
-    arr.push(entry);
-    // Keep only last 100 items
-    if (arr.length > 100) {
-      arr = arr.slice(-100);
-    }
-    fs.writeFileSync(historyPath, JSON.stringify(arr, null, 2));
+  historyStore.append({ text, ts: Date.now() }).then((entry) => {
+    searchIndex.add('history', entry.ts, entry.text, entry.ts);
     if (mainWindow) mainWindow.webContents.send('history-append', entry);
-  } catch (e) {
+  }).catch((e) => {
     console.warn('Failed to write history:', e);
+  });
+}
+
+function indexNote(note) {
+  searchIndex.add('notes', note.id, note.text, note.timestamp);
+}
+
+function indexSnippet(snippet) {
+  searchIndex.add('snippets', snippet.id, `${snippet.title || ''} ${snippet.text || ''}`, snippet.timestamp);
+}
+
+async function readJsonList(filePath) {
+  try {
+    const list = JSON.parse(await fsp.readFile(filePath, 'utf8'));
+    return Array.isArray(list) ? list : [];
+  } catch (e) {
+    return [];
+  }
+}
+
+const SEARCH_BUILD_BATCH = 2000;
+
+function touchSearchIndex(ts) {
+  if (searchIndexTouched) searchIndexTouched.add(ts);
+}
+
+// Initial build, in batches so a long history never blocks the main thread for long.
+// Changes made meanwhile go straight into the index; the build skips entries deleted or
+// edited after their batch was read so it never re-adds stale text.
+function buildSearchIndex() {
+  if (!searchIndexBuild) {
+    searchIndexTouched = new Set();
+    searchIndexBuild = (async () => {
+      const startedAt = Date.now();
+      for (const note of await readJsonList(notesPath)) indexNote(note);
+      for (const snippet of await readJsonList(snippetsPath)) indexSnippet(snippet);
+      await historyStore.open();
+      const keys = historyStore.keys();
+      for (let i = 0; i < keys.length; i += SEARCH_BUILD_BATCH) {
+        const entries = await historyStore.readEntries(keys.slice(i, i + SEARCH_BUILD_BATCH));
+        for (const entry of entries) {
+          if (!historyStore.entries.has(entry.ts) || searchIndexTouched.has(entry.ts)) continue;
+          searchIndex.add('history', entry.ts, entry.text, entry.ts);
+        }
+        await new Promise(resolve => setImmediate(resolve));
+      }
+      searchIndexTouched = null;
+      if (logger) logger.info('Search index built', { documents: searchIndex.size, ms: Date.now() - startedAt });
+    })().catch((e) => {
+      console.warn('Search index build failed:', e.message);
+      searchIndexTouched = null;
+      searchIndexBuild = null;
+    });
+  }
+  return searchIndexBuild;
+}
+
+// Resolves index hits to the entries themselves, for one page of results
+async function searchAll(query, options = {}) {
+  await buildSearchIndex();
+  const startedAt = Date.now();
+  const offset = Math.max(0, Number(options.offset) || 0);
+  const limit = Math.min(200, Math.max(1, Number(options.limit) || 50));
+  const { hits, total } = searchIndex.search(query, { kinds: options.kinds || null, offset, limit });
+
+  const history = new Map();
+  const historyHits = hits.filter(hit => hit.kind === 'history').map(hit => hit.id);
+  if (historyHits.length) {
+    for (const entry of await historyStore.readEntries(historyHits)) history.set(entry.ts, entry);
+  }
+  const lists = {};
+  for (const kind of ['notes', 'snippets']) {
+    if (hits.some(hit => hit.kind === kind)) {
+      lists[kind] = new Map((await readJsonList(kind === 'notes' ? notesPath : snippetsPath)).map(item => [item.id, item]));
+    }
   }
+  const items = [];
+  for (const hit of hits) {
+    const entry = hit.kind === 'history' ? history.get(hit.id) : lists[hit.kind].get(hit.id);
+    if (!entry) continue;
+    items.push({ kind: hit.kind, id: hit.id, ts: hit.ts, text: entry.text || '', title: entry.title });
+  }
+  return { items, total, offset, limit, tookMs: Date.now() - startedAt };
 }
 
 // File watcher for hot reload in development mode
@@ -3269,6 +3965,15 @@ function reloadApp(changedFile) {
 
     // Load settings first to check for custom logs directory
     loadSettings();
+    appSettingsStore.load();
+    appSettingsStore.on('change', applyAppSettingChanges);
+    appSettingsStore.watch();
+    historyStore.open()
+      .then(() => cpuBudget.whenIdle(buildSearchIndex))
+      .catch(e => console.warn('Failed to open history:', e.message));
+    ensureTextInjector();
+    focusWatcher.start();
+    configureTransformCache();
     
     // Initialize logger with custom directory if set
     let customLogsDir = null;
@@ -3535,37 +4240,74 @@ function reloadApp(changedFile) {
 
   ipcMain.handle('history:get', async () => {
     try {
-      if (!fs.existsSync(historyPath)) return [];
-      const arr = JSON.parse(fs.readFileSync(historyPath, 'utf8')) || [];
-      return arr;
+      return await historyStore.all();
     } catch (e) {
       return [];
     }
   });
+  // Newest first: { items, total, offset, limit }
+  ipcMain.handle('history:get-page', async (_evt, options) => {
+    try {
+      return await historyStore.page(options || {});
+    } catch (e) {
+      console.error('Error reading history page:', e);
+      return { items: [], total: 0, offset: 0, limit: 0 };
+    }
+  });
+  ipcMain.handle('history:get-stats', async () => {
+    await historyStore.open().catch(() => {});
+    return historyStore.stats();
+  });
+  // Prefix words and "quoted phrases"; options: { kinds: ['history', 'notes', 'snippets'], offset, limit }
+  ipcMain.handle('search:query', async (_evt, query, options) => {
+    try {
+      return await searchAll(query, options || {});
+    } catch (e) {
+      console.error('Error searching:', e);
+      return { items: [], total: 0, offset: 0, limit: 0, tookMs: 0 };
+    }
+  });
   ipcMain.handle('history:clear', async () => {
-    try { fs.writeFileSync(historyPath, JSON.stringify([], null, 2)); } catch (e) {}
+    try { await historyStore.clear(); } catch (e) {}
+    searchIndex.removeKind('history');
     return [];
   });
   
   ipcMain.handle('history:save', async (_evt, items) => {
     try {
-      fs.writeFileSync(historyPath, JSON.stringify(items, null, 2));
+      await historyStore.replaceAll(items);
+      searchIndex.removeKind('history');
+      for (const entry of await historyStore.all()) {
+        searchIndex.add('history', entry.ts, entry.text, entry.ts);
+        touchSearchIndex(entry.ts);
+      }
       return true;
     } catch (e) {
       console.error('Error saving history:', e);
       return false;
     }
   });
+
+  ipcMain.handle('history:update', async (_evt, timestamp, text) => {
+    try {
+      const updated = await historyStore.update(timestamp, { text });
+      if (updated) {
+        searchIndex.add('history', updated.ts, updated.text, updated.ts);
+        touchSearchIndex(updated.ts);
+      }
+      return !!updated;
+    } catch (e) {
+      console.error('Error updating history item:', e);
+      return false;
+    }
+  });
   
   ipcMain.handle('history:delete', async (_evt, timestamp) => {
     try {
-      let arr = [];
-      if (fs.existsSync(historyPath)) {
-        arr = JSON.parse(fs.readFileSync(historyPath, 'utf8')) || [];
-      }
-      arr = arr.filter(item => item.ts !== timestamp);
-      fs.writeFileSync(historyPath, JSON.stringify(arr, null, 2));
-      return true;
+      const removed = await historyStore.remove(timestamp);
+      // Only a delete that reached the store leaves the index; a failed one stays searchable
+      if (removed) searchIndex.remove('history', timestamp);
+      return removed;
     } catch (e) {
       console.error('Error deleting history item:', e);
       return false;
@@ -3615,63 +4357,12 @@ function reloadApp(changedFile) {
       }
     }
     
-    // Try Python script first
-    try {
-      const systemUtilsPath = path.join(__dirname, 'system_utils.py');
-      const pythonCommands = ['python3', 'python'];
-      
-      for (const pythonCmd of pythonCommands) {
-        try {
-          const pythonProcess = spawn(pythonCmd, [systemUtilsPath, 'info'], { 
-            stdio: ['pipe', 'pipe', 'pipe'],
-            shell: process.platform === 'win32' // Use shell on Windows
-          });
-          let output = '';
-          let error = '';
-          
-          pythonProcess.stdout.on('data', (data) => {
-            output += data.toString();
-          });
-          
-          pythonProcess.stderr.on('data', (data) => {
-            error += data.toString();
-          });
-          
-          const result = await new Promise((resolve) => {
-            pythonProcess.on('close', (code) => {
-              if (code === 0 && output && output.trim()) {
-                try {
-                  const info = JSON.parse(output.trim());
-                  console.log('System info from Python:', info);
-                  resolve({ success: true, info });
-                  return;
-                } catch (e) {
-                  console.error('Failed to parse system info:', e, 'Output:', output);
-                  resolve({ success: false });
-                }
-              } else {
-                console.log(`Python command '${pythonCmd}' failed with code ${code}, error: ${error}`);
-                resolve({ success: false });
-              }
-            });
-          });
-          
-          if (result.success) {
-            return result.info;
-          }
-        } catch (e) {
-          console.log(`Failed to run '${pythonCmd}':`, e.message);
-          continue; // Try next Python command
-        }
-      }
-      
-      // If all Python attempts failed, use Node.js fallback
-      console.log('All Python attempts failed, using Node.js fallback');
-      return getNodeSystemInfo();
-    } catch (e) {
-      console.error('Error in system info handler:', e);
-      return getNodeSystemInfo();
+    const info = await callSidecar('system_info');
+    if (info) {
+      return info;
     }
+    console.log('Sidecar host unavailable, using Node.js fallback');
+    return getNodeSystemInfo();
   });
 
   // Helper function to calculate model recommendation based on system specs
@@ -3711,92 +4402,22 @@ function reloadApp(changedFile) {
 
   // System profile handler - returns detailed system info with recommendations
   ipcMain.handle('system:get-profile', async () => {
-    try {
-      const systemUtilsPath = path.join(__dirname, 'system_utils.py');
-      const pythonExecutable = findPythonExecutable();
-      
-      if (!pythonExecutable) {
-        // Fallback to Node.js
-        const os = require('os');
-        const cpuCount = os.cpus().length;
-        const ramGB = Math.round(os.totalmem() / (1024 ** 3));
-        const gpu = false; // Can't detect GPU easily in Node.js
-        
-        return {
-          os: process.platform,
-          cpu_cores: cpuCount,
-          ram_gb: ramGB,
-          gpu: gpu,
-          recommended: getModelRecommendation(ramGB, cpuCount, gpu)
-        };
-      }
-      
-      const pythonProcess = spawn(pythonExecutable, [systemUtilsPath, 'profile'], {
-        stdio: ['pipe', 'pipe', 'pipe'],
-        shell: process.platform === 'win32'
-      });
-      
-      let output = '';
-      let error = '';
-      
-      pythonProcess.stdout.on('data', (data) => {
-        output += data.toString();
-      });
-      
-      pythonProcess.stderr.on('data', (data) => {
-        error += data.toString();
-      });
-      
-      return new Promise((resolve) => {
-        pythonProcess.on('close', (code) => {
-          if (code === 0 && output) {
-            try {
-              const profile = JSON.parse(output.trim());
-              resolve(profile);
-            } catch (e) {
-              console.error('Error parsing system profile:', e);
-              // Fallback
-              const os = require('os');
-              const cpuCount = os.cpus().length;
-              const ramGB = Math.round(os.totalmem() / (1024 ** 3));
-              resolve({
-                os: process.platform,
-                cpu_cores: cpuCount,
-                ram_gb: ramGB,
-                gpu: false,
-                recommended: getModelRecommendation(ramGB, cpuCount, false)
-              });
-            }
-          } else {
-            console.error('System profile check failed:', error);
-            // Fallback
-            const os = require('os');
-            const cpuCount = os.cpus().length;
-            const ramGB = Math.round(os.totalmem() / (1024 ** 3));
-            resolve({
-              os: process.platform,
-              cpu_cores: cpuCount,
-              ram_gb: ramGB,
-              gpu: false,
-              recommended: getModelRecommendation(ramGB, cpuCount, false)
-            });
-          }
-        });
-      });
-    } catch (e) {
-      console.error('Error getting system profile:', e);
-      // Fallback
-      const os = require('os');
-      const cpuCount = os.cpus().length;
-      const ramGB = Math.round(os.totalmem() / (1024 ** 3));
-      return {
-        os: process.platform,
-        cpu_cores: cpuCount,
-        ram_gb: ramGB,
-        gpu: false,
-        recommended: getModelRecommendation(ramGB, cpuCount, false)
-      };
+    const profile = await callSidecar('system_profile');
+    if (profile) {
+      return profile;
     }
+    // Fallback to Node.js
+    const os = require('os');
+    const cpuCount = os.cpus().length;
+    const ramGB = Math.round(os.totalmem() / (1024 ** 3));
+    const gpu = false; // Can't detect GPU easily in Node.js
+    return {
+      os: process.platform,
+      cpu_cores: cpuCount,
+      ram_gb: ramGB,
+      gpu: gpu,
+      recommended: getModelRecommendation(ramGB, cpuCount, gpu)
+    };
   });
 
   // Model suggestion handler - using Node.js model downloader
@@ -3811,84 +4432,14 @@ function reloadApp(changedFile) {
 
   // Get available disk space - with Node.js fallback
   ipcMain.handle('model:get-space', async () => {
-    // First try Python script
-    try {
-      const modelManagerPath = path.join(__dirname, 'model_manager.py');
-      
-      // Find Python executable
-      const pythonExecutable = findPythonExecutable();
-      if (pythonExecutable) {
-        try {
-          const pythonProcess = spawn(pythonExecutable, [modelManagerPath, 'space'], {
-            stdio: ['pipe', 'pipe', 'pipe'],
-            shell: process.platform === 'win32'
-          });
-          
-          let output = '';
-          let error = '';
-          
-          pythonProcess.stdout.on('data', (data) => {
-            output += data.toString();
-          });
-          
-          pythonProcess.stderr.on('data', (data) => {
-            error += data.toString();
-            console.log('Python stderr (space):', data.toString());
-          });
-          
-          const result = await new Promise((resolve) => {
-            pythonProcess.on('close', (code) => {
-              console.log(`Disk space check: code=${code}, output="${output.trim()}"`);
-              if (code === 0 && output) {
-                try {
-                  const trimmed = output.trim();
-                  const result = JSON.parse(trimmed);
-                  // New format returns {success, space_gb, path}
-                  if (result.success) {
-                    console.log('Parsed disk space from Python:', result.space_gb, 'GB, path:', result.path);
-                    resolve({
-                      success: true,
-                      space_gb: result.space_gb || 0,
-                      path: result.path || ''
-                    });
-                  } else {
-                    resolve({
-                      success: false,
-                      space_gb: result.space_gb || 0,
-                      path: result.path || ''
-                    });
-                  }
-                } catch (e) {
-                  console.error('Failed to parse disk space result:', e, 'Raw output:', output);
-                  resolve({
-                    success: false,
-                    space_gb: 0,
-                    path: ''
-                  });
-                }
-              } else {
-                console.error(`Python disk space check failed, code ${code}, error: ${error}`);
-                resolve({
-                  success: false,
-                  space_gb: 0,
-                  path: ''
-                });
-              }
-            });
-          });
-          
-          if (result && result.success) {
-            return result;
-          }
-        } catch (e) {
-          console.error(`Failed to run Python for disk space:`, e);
-          // Python failed, try Node.js fallback
-        }
-      } else {
-        console.log('Python not found, using Node.js fallback for disk space');
-      }
-    } catch (e) {
-      console.error('Error in Python disk space check:', e);
+    // First try the sidecar host
+    const space = await callSidecar('model_space');
+    if (space && space.success) {
+      return {
+        success: true,
+        space_gb: space.space_gb || 0,
+        path: space.path || ''
+      };
     }
     
     // Fallback to Node.js method
@@ -4034,18 +4585,7 @@ function reloadApp(changedFile) {
       if (!result.canceled && result.filePaths.length > 0) {
         const selectedPath = result.filePaths[0];
         // Save to settings
-        const settingsPath = path.join(__dirname, 'data', 'settings.json');
-        let settings = {};
-        if (fs.existsSync(settingsPath)) {
-          try {
-            settings = JSON.parse(fs.readFileSync(settingsPath, 'utf8'));
-          } catch (e) {
-            console.error('Error reading settings:', e);
-          }
-        }
-        settings.model_download_path = selectedPath;
-        fs.mkdirSync(path.dirname(settingsPath), { recursive: true });
-        fs.writeFileSync(settingsPath, JSON.stringify(settings, null, 2));
+        appSettingsStore.set({ model_download_path: selectedPath });
         return { success: true, path: selectedPath };
       }
       return { success: false, path: null };
@@ -4057,12 +4597,9 @@ function reloadApp(changedFile) {
   
   ipcMain.handle('model:get-path', async () => {
     try {
-      const settingsPath = path.join(__dirname, 'data', 'settings.json');
-      if (fs.existsSync(settingsPath)) {
-        const settings = JSON.parse(fs.readFileSync(settingsPath, 'utf8'));
-        if (settings.model_download_path) {
-          return { success: true, path: settings.model_download_path };
-        }
+      const storedPath = appSettingsStore.get('model_download_path');
+      if (storedPath) {
+        return { success: true, path: storedPath };
       }
       // Return default path
       const os = require('os');
@@ -4083,18 +4620,7 @@ function reloadApp(changedFile) {
   
   ipcMain.handle('model:set-path', async (_evt, downloadPath) => {
     try {
-      const settingsPath = path.join(__dirname, 'data', 'settings.json');
-      let settings = {};
-      if (fs.existsSync(settingsPath)) {
-        try {
-          settings = JSON.parse(fs.readFileSync(settingsPath, 'utf8'));
-        } catch (e) {
-          console.error('Error reading settings:', e);
-        }
-      }
-      settings.model_download_path = downloadPath;
-      fs.mkdirSync(path.dirname(settingsPath), { recursive: true });
-      fs.writeFileSync(settingsPath, JSON.stringify(settings, null, 2));
+      appSettingsStore.set({ model_download_path: downloadPath });
       return { success: true };
     } catch (e) {
       console.error('Error setting model path:', e);
@@ -4454,7 +4980,7 @@ function reloadApp(changedFile) {
   ipcMain.handle('logs:get-recent', async (_evt, category, lines) => {
     try {
       if (logger) {
-        const logs = logger.getRecentLogs(category || 'main', lines || 100);
+        const logs = await logger.getRecentLogs(category || 'main', lines || 100);
         return { success: true, logs };
       }
       return { success: false, error: 'Logger not initialized' };
@@ -4487,19 +5013,8 @@ function reloadApp(changedFile) {
       if (!result.canceled && result.filePaths.length > 0) {
         const selectedPath = result.filePaths[0];
         // Save to settings
-        const settingsPath = path.join(__dirname, 'data', 'settings.json');
-        let settingsData = {};
-        if (fs.existsSync(settingsPath)) {
-          try {
-            settingsData = JSON.parse(fs.readFileSync(settingsPath, 'utf8'));
-          } catch (e) {
-            console.error('Error reading settings:', e);
-          }
-        }
-        settingsData.logs_directory = selectedPath;
+        appSettingsStore.set({ logs_directory: selectedPath });
         settings.logs_directory = selectedPath;
-        fs.mkdirSync(path.dirname(settingsPath), { recursive: true });
-        fs.writeFileSync(settingsPath, JSON.stringify(settingsData, null, 2));
         
         // Update logger directory
         if (logger) {
@@ -4532,19 +5047,8 @@ function reloadApp(changedFile) {
   
   ipcMain.handle('logs:set-path', async (_evt, logsPath) => {
     try {
-      const settingsPath = path.join(__dirname, 'data', 'settings.json');
-      let settingsData = {};
-      if (fs.existsSync(settingsPath)) {
-        try {
-          settingsData = JSON.parse(fs.readFileSync(settingsPath, 'utf8'));
-        } catch (e) {
-          console.error('Error reading settings:', e);
-        }
-      }
-      settingsData.logs_directory = logsPath;
+      appSettingsStore.set({ logs_directory: logsPath });
       settings.logs_directory = logsPath;
-      fs.mkdirSync(path.dirname(settingsPath), { recursive: true });
-      fs.writeFileSync(settingsPath, JSON.stringify(settingsData, null, 2));
       
       // Update logger directory
       if (logger) {
@@ -4660,18 +5164,7 @@ function reloadApp(changedFile) {
       }
       
       // Get download path
-      let downloadPath = null;
-      try {
-        const settingsPath = path.join(__dirname, 'data', 'settings.json');
-        if (fs.existsSync(settingsPath)) {
-          const settings = JSON.parse(fs.readFileSync(settingsPath, 'utf8'));
-          if (settings.model_download_path) {
-            downloadPath = settings.model_download_path;
-          }
-        }
-      } catch (e) {
-        console.warn('Error reading download path from settings:', e);
-      }
+      let downloadPath = appSettingsStore.get('model_download_path') || null;
       
       // Use default path if not set
       if (!downloadPath) {
@@ -4712,20 +5205,13 @@ function reloadApp(changedFile) {
         console.log(`✓ Model ${modelName} already exists in faster-whisper cache at ${modelCacheDir}`);
         
         // Set as active model
+        const previousModel = settings.activeModel;
         settings.activeModel = modelName;
         saveSettings();
         if (logger) logger.download('Model already exists, setting as active', { model: modelName, path: modelCacheDir });
         
-        // Restart whisper service with this model
-        whisperModelReady = false;
-        if (whisperProcess && !whisperProcess.killed) {
-          whisperProcess.kill();
-        }
-        
-        // Trigger model ready event after restart
-        setTimeout(() => {
-          ensureWhisperService();
-        }, 500);
+        // Swap the model inside the running service; dictation keeps working meanwhile
+        switchWhisperModel(modelName, previousModel);
         
         const cachedResult = {
           success: true,
@@ -4794,14 +5280,12 @@ function reloadApp(changedFile) {
                       activeDownloadProcess = null;
                       if (jsonData.success) {
                         // Set as active model
+                        const previousModel = settings.activeModel;
                         settings.activeModel = modelName;
                         saveSettings();
                         
-                        // Restart whisper service
-                        whisperModelReady = false;
-                        if (whisperProcess && !whisperProcess.killed) {
-                          whisperProcess.kill();
-                        }
+                        // Swap the model inside the running service
+                        switchWhisperModel(modelName, previousModel);
                         
                         if (mainWindow && !mainWindow.isDestroyed()) {
                           mainWindow.webContents.send('model:complete', {
@@ -5122,18 +5606,7 @@ function reloadApp(changedFile) {
   ipcMain.handle('model:check', async (_evt, modelName) => {
     try {
       // Get custom download path from settings
-      let customPath = null;
-      try {
-        const settingsPath = path.join(__dirname, 'data', 'settings.json');
-        if (fs.existsSync(settingsPath)) {
-          const settings = JSON.parse(fs.readFileSync(settingsPath, 'utf8'));
-          if (settings.model_download_path) {
-            customPath = settings.model_download_path;
-          }
-        }
-      } catch (e) {
-        console.warn('Error reading download path from settings:', e);
-      }
+      const customPath = appSettingsStore.get('model_download_path') || null;
       
       const downloadPath = await modelDownloader.getDownloadPath(customPath);
       const exists = await modelDownloader.checkModelExists(modelName, downloadPath);
@@ -5193,18 +5666,7 @@ function reloadApp(changedFile) {
       const sourceSizeMB = sourceStats.size / (1024 * 1024);
 
       // Get download path
-      let downloadPath = null;
-      try {
-        const settingsPath = path.join(__dirname, 'data', 'settings.json');
-        if (fs.existsSync(settingsPath)) {
-          const settings = JSON.parse(fs.readFileSync(settingsPath, 'utf8'));
-          if (settings.model_download_path) {
-            downloadPath = settings.model_download_path;
-          }
-        }
-    } catch (e) {
-        console.warn('Error reading download path from settings:', e);
-      }
+      let downloadPath = appSettingsStore.get('model_download_path') || null;
 
       if (!downloadPath) {
         downloadPath = getDefaultModelsDir();
@@ -5374,75 +5836,34 @@ function reloadApp(changedFile) {
     }
   });
 
-  // Translation service handler - uses Python service for on-the-fly translation
-  ipcMain.handle('translation:translate', async (_evt, text, targetLang, sourceLang = 'en') => {
-    try {
-      const translationServicePath = path.join(__dirname, 'translation_service.py');
-      
-      if (!fs.existsSync(translationServicePath)) {
-        return { error: 'Translation service not found', translated: text };
-      }
-
-      // Call Python translation service
-      const result = execSync(
-        `python "${translationServicePath}" translate "${text.replace(/"/g, '\\"')}" ${sourceLang} ${targetLang}`,
-        { encoding: 'utf8', maxBuffer: 10 * 1024 * 1024 }
-      );
+  // Translation service handlers - the sidecar host loads translation_service.py once
+  const TRANSLATION_TIMEOUT_MS = 30000;
+  const translationServicePath = path.join(__dirname, 'translation_service.py');
 
-      const parsed = JSON.parse(result.trim());
-      return parsed;
-    } catch (error) {
-      console.error('Translation error:', error);
-      return { error: error.message, translated: text };
+  ipcMain.handle('translation:translate', async (_evt, text, targetLang, sourceLang = 'en') => {
+    if (!fs.existsSync(translationServicePath)) {
+      return { error: 'Translation service not found', translated: text };
     }
+    const result = await callSidecar('translate', { text, source: sourceLang, target: targetLang }, TRANSLATION_TIMEOUT_MS);
+    return result || { error: 'Translation service unavailable', translated: text };
   });
 
   // Translation service handler for dictionaries (translation files)
   ipcMain.handle('translation:translate-dict', async (_evt, translationsJson, targetLang, sourceLang = 'en') => {
-    try {
-      const translationServicePath = path.join(__dirname, 'translation_service.py');
-      
-      if (!fs.existsSync(translationServicePath)) {
-        return { error: 'Translation service not found', translated: translationsJson };
-      }
-
-      // Escape JSON for command line
-      const escapedJson = JSON.stringify(translationsJson).replace(/"/g, '\\"');
-      
-      // Call Python translation service
-      const result = execSync(
-        `python "${translationServicePath}" translate_dict "${escapedJson}" ${sourceLang} ${targetLang}`,
-        { encoding: 'utf8', maxBuffer: 10 * 1024 * 1024 }
-      );
-
-      const parsed = JSON.parse(result.trim());
-      return parsed;
-    } catch (error) {
-      console.error('Translation error:', error);
-      return { error: error.message, translated: translationsJson };
+    if (!fs.existsSync(translationServicePath)) {
+      return { error: 'Translation service not found', translated: translationsJson };
     }
+    const result = await callSidecar('translate_dict', { translations: translationsJson, source: sourceLang, target: targetLang }, TRANSLATION_TIMEOUT_MS);
+    return result || { error: 'Translation service unavailable', translated: translationsJson };
   });
 
   // Check if translation service is available
   ipcMain.handle('translation:check', async () => {
-    try {
-      const translationServicePath = path.join(__dirname, 'translation_service.py');
-      
-      if (!fs.existsSync(translationServicePath)) {
-        return { available: false, error: 'Translation service not found' };
-      }
-
-      const result = execSync(
-        `python "${translationServicePath}" check`,
-        { encoding: 'utf8', maxBuffer: 1024 * 1024 }
-      );
-
-      const parsed = JSON.parse(result.trim());
-      return parsed;
-    } catch (error) {
-      console.error('Translation check error:', error);
-      return { available: false, error: error.message };
+    if (!fs.existsSync(translationServicePath)) {
+      return { available: false, error: 'Translation service not found' };
     }
+    const result = await callSidecar('translation_check');
+    return result || { available: false, error: 'Translation service unavailable' };
   });
 
   // Clipboard handler
@@ -5456,66 +5877,15 @@ function reloadApp(changedFile) {
     }
   });
 
-  // App settings handlers
-  const appSettingsPath = path.join(__dirname, 'data', 'settings.json');
-  
-  // Ensure data directory exists
-  const dataDir = path.join(__dirname, 'data');
-  if (!fs.existsSync(dataDir)) {
-    fs.mkdirSync(dataDir, { recursive: true });
-  }
-
+  // App settings handlers - the store keeps data/settings.json in memory and writes it behind
   ipcMain.handle('app-settings:get', async () => {
-    try {
-      if (fs.existsSync(appSettingsPath)) {
-        const raw = fs.readFileSync(appSettingsPath, 'utf8');
-        return JSON.parse(raw);
-      }
-      // Return defaults
-      return {
-        theme: 'light',
-        follow_system_theme: false,
-        auto_model: false,
-        selected_model: 'base',
-        language: 'en',
-        dictation_hotkey: 'Ctrl+Space',
-        launch_on_startup: false,
-        sound_feedback: true,
-        vibe_coding_enabled: false,
-        waveform_animation: true,
-        continuous_dictation: false,
-        low_latency: false,
-        noise_reduction: false,
-        local_only: true,
-        auto_delete_cache: false,
-        text_style: 'none',
-        text_style_category: 'personal',
-        llm_processing: false
-      };
-    } catch (e) {
-      console.error('Error loading app settings:', e);
-      return {};
-    }
+    return appSettingsStore.getAll(true);
   });
 
   ipcMain.handle('app-settings:set', async (_evt, newSettings) => {
     try {
-      let currentSettings = {};
-      if (fs.existsSync(appSettingsPath)) {
-        const raw = fs.readFileSync(appSettingsPath, 'utf8');
-        currentSettings = JSON.parse(raw);
-      }
-      const updated = { ...currentSettings, ...newSettings };
-      fs.writeFileSync(appSettingsPath, JSON.stringify(updated, null, 2));
-      
-      // If experimental settings changed, send them to whisper service
-      if ('continuous_dictation' in newSettings || 
-          'low_latency' in newSettings || 
-          'noise_reduction' in newSettings) {
-        sendExperimentalSettings();
-      }
-      
-      return updated;
+      // Side effects run from the store's change event (applyAppSettingChanges)
+      return appSettingsStore.set(newSettings);
     } catch (e) {
       console.error('Error saving app settings:', e);
       return {};
@@ -5564,6 +5934,13 @@ function reloadApp(changedFile) {
     }
   });
 
+  ipcMain.handle('style:get-cache-stats', async () => transformCache.getStats());
+
+  ipcMain.handle('style:clear-cache', async () => {
+    transformCache.clear();
+    return transformCache.getStats();
+  });
+
   ipcMain.handle('style:get-banner-text', async (_evt, category) => {
     console.log('[Style IPC] get-banner-text called:', category);
     try {
@@ -5576,56 +5953,8 @@ function reloadApp(changedFile) {
     }
   });
 
-  // Context detection handler - detects active application and suggests category
-  ipcMain.handle('style:detect-context', async () => {
-    try {
-      // Get active window information
-      // On Windows, use PowerShell to get the active window title
-      if (process.platform === 'win32') {
-        const psCommand = `powershell -Command "Add-Type -TypeDefinition 'using System; using System.Runtime.InteropServices; public class Win32 { [DllImport(\\\"user32.dll\\\")] public static extern IntPtr GetForegroundWindow(); [DllImport(\\\"user32.dll\\\")] public static extern int GetWindowText(IntPtr hWnd, System.Text.StringBuilder text, int count); } $hwnd = [Win32]::GetForegroundWindow(); $sb = New-Object System.Text.StringBuilder 256; [Win32]::GetWindowText($hwnd, $sb, $sb.Capacity) | Out-Null; $sb.ToString()"`;
-        const activeWindowTitle = execSync(psCommand, { encoding: 'utf8', timeout: 1000 }).trim().toLowerCase();
-        
-        // Map window titles to categories
-        const emailApps = ['outlook', 'gmail', 'thunderbird', 'mail', 'apple mail', 'spark'];
-        const workMessengers = ['slack', 'teams', 'microsoft teams', 'discord', 'zoom'];
-        const personalMessengers = ['whatsapp', 'telegram', 'signal', 'messenger', 'imessage', 'messages'];
-        
-        if (emailApps.some(app => activeWindowTitle.includes(app))) {
-          return 'email';
-        } else if (workMessengers.some(app => activeWindowTitle.includes(app))) {
-          return 'work';
-        } else if (personalMessengers.some(app => activeWindowTitle.includes(app))) {
-          return 'personal';
-        }
-      } else if (process.platform === 'darwin') {
-        // macOS - use AppleScript
-        try {
-          const script = `osascript -e 'tell application "System Events" to get name of first application process whose frontmost is true'`;
-          const activeApp = execSync(script, { encoding: 'utf8', timeout: 1000 }).trim().toLowerCase();
-          
-          const emailApps = ['mail', 'outlook', 'spark', 'airmail'];
-          const workMessengers = ['slack', 'microsoft teams', 'zoom'];
-          const personalMessengers = ['messages', 'whatsapp', 'telegram', 'signal'];
-          
-          if (emailApps.some(app => activeApp.includes(app))) {
-            return 'email';
-          } else if (workMessengers.some(app => activeApp.includes(app))) {
-            return 'work';
-          } else if (personalMessengers.some(app => activeApp.includes(app))) {
-            return 'personal';
-          }
-        } catch (e) {
-          console.warn('Context detection failed on macOS:', e.message);
-        }
-      }
-      
-      // Default to 'other' if no match
-      return 'other';
-    } catch (e) {
-      console.warn('Context detection failed:', e.message);
-      return 'other';
-    }
-  });
+  // Context detection handler - category of the active application, 'other' if unknown
+  ipcMain.handle('style:detect-context', async () => focusWatcher.category() || 'other');
 
   // Cache clear handler
   ipcMain.handle('cache:clear', async () => {
@@ -5644,38 +5973,11 @@ function reloadApp(changedFile) {
 
   // Microphone detection handler
   ipcMain.handle('microphone:list', async () => {
-    try {
-      const systemUtilsPath = path.join(__dirname, 'system_utils.py');
-      const pythonProcess = spawn('python', [systemUtilsPath, 'list-microphones'], { stdio: ['pipe', 'pipe', 'pipe'] });
-      let output = '';
-      let error = '';
-      
-      pythonProcess.stdout.on('data', (data) => {
-        output += data.toString();
-      });
-      
-      pythonProcess.stderr.on('data', (data) => {
-        error += data.toString();
-      });
-      
-      return new Promise((resolve) => {
-        pythonProcess.on('close', (code) => {
-          if (code === 0 && output) {
-            try {
-              const devices = JSON.parse(output.trim());
-              resolve(devices);
-            } catch (e) {
-              resolve([{ name: 'Auto-detect (Audio)', id: 'default' }]);
-            }
-          } else {
-            resolve([{ name: 'Auto-detect (Audio)', id: 'default' }]);
-          }
-        });
-      });
-    } catch (e) {
-      console.error('Error listing microphones:', e);
-      return [{ name: 'Auto-detect (Audio)', id: 'default' }];
+    const devices = await callSidecar('list_microphones');
+    if (Array.isArray(devices) && devices.length > 0) {
+      return devices;
     }
+    return [{ name: 'Auto-detect (Audio)', id: 'default' }];
   });
 
   // System theme detection handlers
@@ -5830,8 +6132,6 @@ function reloadApp(changedFile) {
   });
 
   // Snippets handlers
-  const snippetsPath = path.join(__dirname, 'data', 'snippets.json');
-  
   ipcMain.handle('snippets:get', async () => {
     try {
       if (fs.existsSync(snippetsPath)) {
@@ -5860,6 +6160,7 @@ function reloadApp(changedFile) {
       };
       snippets.unshift(newSnippet);
       fs.writeFileSync(snippetsPath, JSON.stringify(snippets, null, 2));
+      indexSnippet(newSnippet);
       return snippets;
     } catch (e) {
       console.error('Error adding snippet:', e);
@@ -5878,6 +6179,7 @@ function reloadApp(changedFile) {
       if (index !== -1) {
         snippets[index] = { ...snippets[index], ...snippet };
         fs.writeFileSync(snippetsPath, JSON.stringify(snippets, null, 2));
+        indexSnippet(snippets[index]);
       }
       return snippets;
     } catch (e) {
@@ -5895,6 +6197,7 @@ function reloadApp(changedFile) {
       }
       snippets = snippets.filter(s => s.id !== id);
       fs.writeFileSync(snippetsPath, JSON.stringify(snippets, null, 2));
+      searchIndex.remove('snippets', id);
       return snippets;
     } catch (e) {
       console.error('Error deleting snippet:', e);
@@ -5903,8 +6206,6 @@ function reloadApp(changedFile) {
   });
 
   // Notes handlers
-  const notesPath = path.join(__dirname, 'data', 'notes.json');
-  
   ipcMain.handle('notes:get', async () => {
     try {
       if (fs.existsSync(notesPath)) {
@@ -5932,6 +6233,7 @@ function reloadApp(changedFile) {
       };
       notes.unshift(newNote);
       fs.writeFileSync(notesPath, JSON.stringify(notes, null, 2));
+      indexNote(newNote);
       return notes;
     } catch (e) {
       console.error('Error adding note:', e);
@@ -5950,6 +6252,7 @@ function reloadApp(changedFile) {
       if (index !== -1) {
         notes[index] = { ...notes[index], ...note };
         fs.writeFileSync(notesPath, JSON.stringify(notes, null, 2));
+        indexNote(notes[index]);
       }
       return notes;
     } catch (e) {
@@ -5967,6 +6270,7 @@ function reloadApp(changedFile) {
       }
       notes = notes.filter(n => n.id !== id);
       fs.writeFileSync(notesPath, JSON.stringify(notes, null, 2));
+      searchIndex.remove('notes', id);
       return notes;
     } catch (e) {
       console.error('Error deleting note:', e);
@@ -6166,6 +6470,14 @@ function wait(ms) {
   if (whisperProcess && !whisperProcess.killed) {
     whisperProcess.kill();
   }
+  stopSidecarHost();
+  stopTextInjector();
+  focusWatcher.stop();
+  transformCache.save();
+  appSettingsStore.unwatch();
+  appSettingsStore.flushSync();
+  historyStore.saveIndexSync();
+  if (logger) logger.flushSync();
   if (indicatorWindow && !indicatorWindow.isDestroyed()) {
     try { indicatorWindow.destroy(); } catch (e) {}
   }
@@ -76,8 +76,8 @@ def get_model_path(model, download_root=None):
     model_dir = f"models--openai--whisper-{model}"
     return cache_base / model_dir
 
-def get_space():
-    """Get available disk space and cache path."""
+def space_info():
+    """Available disk space and cache path."""
     try:
         cache_dir = get_model_path("tiny").parent  # Use parent of any model path
         cache_dir.mkdir(parents=True, exist_ok=True)
@@ -85,22 +85,23 @@ def get_space():
         total, used, free = shutil.disk_usage(str(cache_dir))
         space_gb = round(free / (1024 ** 3), 2)
         
-        result = {
+        return {
             "success": True,
             "space_gb": space_gb,
             "path": str(cache_dir)
         }
-        print(json.dumps(result))
-        sys.stdout.flush()
     except Exception as e:
-        result = {
+        return {
             "success": False,
             "error": str(e),
             "space_gb": 0,
             "path": str(CACHE_DIR)
         }
-        print(json.dumps(result))
-        sys.stdout.flush()
+
+def get_space():
+    """Print available disk space and cache path."""
+    print(json.dumps(space_info()))
+    sys.stdout.flush()
 
 def is_downloaded(model, download_root=None):
     """Check if a model is already downloaded."""
@@ -157,6 +158,16 @@ def is_downloaded(model, download_root=None):
     except Exception as e:
         return False, None
 
+def check_model(model, download_root=None):
+    """Download status of a model as reported by the ``check`` command."""
+    exists, info = is_downloaded(model, download_root)
+    return {
+        "exists": exists,
+        "path": info["path"] if exists and info else None,
+        "cache_path": info["cache_path"] if exists and info else str(get_model_path(model, download_root)),
+        "size_mb": info["size_mb"] if exists and info else None
+    }
+
 def get_downloaded_size(model, download_root=None):
     """Get the current downloaded size of a model (even if incomplete)."""
     try:
@@ -582,14 +593,7 @@ if __name__ == "__main__":
             sys.exit(1)
         model = sys.argv[2]
         download_root = sys.argv[3] if len(sys.argv) > 3 else None
-        exists, info = is_downloaded(model, download_root)
-        result = {
-            "exists": exists,
-            "path": info["path"] if exists and info else None,
-            "cache_path": info["cache_path"] if exists and info else str(get_model_path(model, download_root)),
-            "size_mb": info["size_mb"] if exists and info else None
-        }
-        print(json.dumps(result))
+        print(json.dumps(check_model(model, download_root)))
         sys.stdout.flush()
     
     elif command == "download":
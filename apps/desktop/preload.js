@@ -17,6 +17,10 @@ contextBridge.exposeInMainWorld('voiceApp', {
   startCaptureHotkey: () => ipcRenderer.send('hotkey-capture-start'),
   endCaptureHotkey: () => ipcRenderer.send('hotkey-capture-end'),
   getHistory: () => ipcRenderer.invoke('history:get'),
+  getHistoryPage: (options) => ipcRenderer.invoke('history:get-page', options),
+  getHistoryStats: () => ipcRenderer.invoke('history:get-stats'),
+  updateHistoryItem: (timestamp, text) => ipcRenderer.invoke('history:update', timestamp, text),
+  search: (query, options) => ipcRenderer.invoke('search:query', query, options),
   clearHistory: () => ipcRenderer.invoke('history:clear'),
   saveHistory: (items) => ipcRenderer.invoke('history:save', items),
   deleteHistoryItem: (timestamp) => ipcRenderer.invoke('history:delete', timestamp),
@@ -110,5 +114,7 @@ contextBridge.exposeInMainWorld('voiceApp', {
   getAvailableStyles: (category) => ipcRenderer.invoke('style:get-available', category),
   getCategoryBannerText: (category) => ipcRenderer.invoke('style:get-banner-text', category),
   detectContext: () => ipcRenderer.invoke('style:detect-context'),
+  getTransformCacheStats: () => ipcRenderer.invoke('style:get-cache-stats'),
+  clearTransformCache: () => ipcRenderer.invoke('style:clear-cache'),
   onStyleCategoryAutoUpdated: (callback) => ipcRenderer.on('style-category-auto-updated', (_, category) => callback(category))
 });
@@ -134,6 +134,10 @@ window.accessibilityManager = accessibilityManager;
     startCaptureHotkey: () => {},
     endCaptureHotkey: () => {},
     getHistory: async () => [],
+    getHistoryPage: async () => ({ items: [], total: 0, offset: 0, limit: 0 }),
+    getHistoryStats: async () => ({ count: 0, words: 0, duration: 0 }),
+    updateHistoryItem: async () => false,
+    search: async () => ({ items: [], total: 0, offset: 0, limit: 0, tookMs: 0 }),
     clearHistory: async () => {},
     saveHistory: async () => false,
     deleteHistoryItem: async () => false,
@@ -1117,6 +1121,7 @@ window.accessibilityManager = accessibilityManager;
     
     // Create history item element
     const item = createHistoryItem(entry);
+    historyLoaded++;
       const firstItem = historyListFull.querySelector('.history-item');
       if (firstItem) {
         historyListFull.insertBefore(item, firstItem);
@@ -1429,6 +1434,7 @@ window.accessibilityManager = accessibilityManager;
           // Delete from history file
           deleteHistoryItem(entry.timestamp);
           item.remove();
+          historyLoaded = Math.max(0, historyLoaded - 1);
           showMessage('Deleted');
           // Recalculate stats after deletion
           calculateStatsFromHistory();
@@ -1564,18 +1570,10 @@ window.accessibilityManager = accessibilityManager;
     }
   }
   
-  // Update history item in file
+  // Update history item in the store (appends an edit record)
   async function updateHistoryItem(timestamp, newText) {
     try {
-      const history = await ipc.getHistory();
-      const updated = history.map(item => {
-        if (item.ts === timestamp) {
-          return { ...item, text: newText };
-        }
-        return item;
-      });
-      // Save updated history
-      await ipc.saveHistory(updated);
+      await ipc.updateHistoryItem(timestamp, newText);
     } catch (error) {
       console.error('Error updating history item:', error);
     }
@@ -1599,6 +1597,24 @@ window.accessibilityManager = accessibilityManager;
     editingHistoryItem = null;
   }
 
+  // History is read a page at a time, newest first; older pages load as the end of the
+  // list scrolls into view
+  const HISTORY_PAGE_SIZE = 100;
+  let historyLoaded = 0; // entries rendered from the store (the offset of the next page)
+  let historyTotal = 0;
+  let historyLoading = false;
+  let lastHistoryDateKey = null;
+  let historyObserver = null;
+  let historyQuery = ''; // non-empty: the list shows search results instead
+
+  function historyDateLabel(dateKey) {
+    const today = new Date().toDateString();
+    const yesterday = new Date(Date.now() - 86400000).toDateString();
+    if (dateKey === today) return 'Today';
+    if (dateKey === yesterday) return 'Yesterday';
+    return new Date(dateKey).toLocaleDateString('en-US', { month: 'long', day: 'numeric', year: 'numeric' });
+  }
+
   // Load history function
   function loadHistory() {
     const historyListFull = document.getElementById('history-list-full');
@@ -1606,55 +1622,63 @@ window.accessibilityManager = accessibilityManager;
     
     // Clear existing items
     historyListFull.innerHTML = '';
+    historyLoaded = 0;
+    historyTotal = 0;
+    lastHistoryDateKey = null;
     
-    ipc.getHistory().then((items) => {
-      if (!items || items.length === 0) {
-        return;
-      }
-      
-      // Group items by date
-      const groupedByDate = {};
-      items.reverse().forEach(entry => {
+    loadHistoryPage().then(() => {
+      // Calculate stats from history
+      calculateStatsFromHistory();
+    });
+  }
+
+  function loadHistoryPage() {
+    const historyListFull = document.getElementById('history-list-full');
+    if (!historyListFull || historyLoading) return Promise.resolve();
+    historyLoading = true;
+    
+    const options = { offset: historyLoaded, limit: HISTORY_PAGE_SIZE };
+    const request = historyQuery
+      ? ipc.search(historyQuery, { ...options, kinds: ['history'] })
+      : ipc.getHistoryPage(options);
+    return request.then((page) => {
+      const items = (page && page.items) || [];
+      historyTotal = (page && page.total) || 0;
+      historyLoaded += items.length;
+      
+      // Display items grouped by date, continuing the previous page's group
+      items.forEach(entry => {
         const date = new Date(entry.ts);
         const dateKey = date.toDateString();
-        if (!groupedByDate[dateKey]) {
-          groupedByDate[dateKey] = [];
-        }
-        const timeStr = formatTime(date);
-        groupedByDate[dateKey].push({ text: entry.text, time: timeStr, timestamp: entry.ts });
-      });
-      
-      // Display items grouped by date
-      Object.keys(groupedByDate).forEach(dateKey => {
-        const dateHeader = document.createElement('h3');
-        dateHeader.className = 'history-title';
-        const date = new Date(dateKey);
-        const today = new Date().toDateString();
-        const yesterday = new Date(Date.now() - 86400000).toDateString();
-        
-        if (dateKey === today) {
-          dateHeader.textContent = 'Today';
-        } else if (dateKey === yesterday) {
-          dateHeader.textContent = 'Yesterday';
-        } else {
-          dateHeader.textContent = date.toLocaleDateString('en-US', { month: 'long', day: 'numeric', year: 'numeric' });
+        if (dateKey !== lastHistoryDateKey) {
+          const dateHeader = document.createElement('h3');
+          dateHeader.className = 'history-title';
+          dateHeader.textContent = historyDateLabel(dateKey);
+          historyListFull.appendChild(dateHeader);
+          lastHistoryDateKey = dateKey;
         }
-        
-        historyListFull.appendChild(dateHeader);
-        
-        groupedByDate[dateKey].forEach(entry => {
-          const item = createHistoryItem(entry);
-          historyListFull.appendChild(item);
-        });
+        const item = createHistoryItem({ text: entry.text, time: formatTime(date), timestamp: entry.ts });
+        historyListFull.appendChild(item);
       });
       
-      // Calculate stats from history
-      calculateStatsFromHistory();
+      watchHistoryEnd(historyListFull);
     }).catch(e => {
       console.error('Error loading history:', e);
+    }).finally(() => {
+      historyLoading = false;
     });
   }
 
+  function watchHistoryEnd(historyListFull) {
+    if (typeof IntersectionObserver === 'undefined') return;
+    if (historyObserver) historyObserver.disconnect();
+    if (historyLoaded >= historyTotal || !historyListFull.lastElementChild) return;
+    historyObserver = new IntersectionObserver((entries) => {
+      if (entries.some(e => e.isIntersecting)) loadHistoryPage();
+    });
+    historyObserver.observe(historyListFull.lastElementChild);
+  }
+
   // Calculate stats from history
   function calculateStatsFromHistory() {
     // Reset stats
@@ -1663,23 +1687,15 @@ window.accessibilityManager = accessibilityManager;
     stats.timeSaved = 0;
     stats.wpm = 0;
     
-  ipc.getHistory().then((items) => {
-      if (!items || items.length === 0) {
+  // Totals come from the history index, so this never reads the entries themselves
+  ipc.getHistoryStats().then((totals) => {
+      if (!totals || totals.count === 0) {
         updateStatsDisplay();
         return;
       }
       
-      // Calculate total words and track actual durations if available
-      let totalActualDuration = 0;
-      items.forEach(entry => {
-      const wordCount = entry.text.split(/\s+/).filter(w => w.length > 0).length;
-      stats.words += wordCount;
-        
-        // If entry has duration metadata, use it
-        if (entry.duration) {
-          totalActualDuration += entry.duration;
-        }
-      });
+      stats.words = totals.words;
+      const totalActualDuration = totals.duration || 0;
       
       // Use actual durations if available, otherwise estimate
       if (totalActualDuration > 0) {
@@ -1702,7 +1718,7 @@ window.accessibilityManager = accessibilityManager;
         const totalDuration = recordingDurations.reduce((sum, d) => sum + d, 0);
         const avgDuration = totalDuration / recordingDurations.length;
         if (avgDuration > 0) {
-          const avgWordsPerRecording = stats.words / items.length;
+          const avgWordsPerRecording = stats.words / totals.count;
           stats.wpm = Math.round((avgWordsPerRecording / avgDuration) * 60);
         }
       }
@@ -1723,6 +1739,19 @@ window.accessibilityManager = accessibilityManager;
   // Load history on initialization
   loadHistory();
 
+  // Search box above the history list: prefix words and "quoted phrases"
+  const historySearchInput = document.getElementById('history-search');
+  if (historySearchInput) {
+    let searchTimer = null;
+    historySearchInput.addEventListener('input', () => {
+      clearTimeout(searchTimer);
+      searchTimer = setTimeout(() => {
+        historyQuery = historySearchInput.value.trim();
+        loadHistory();
+      }, 150);
+    });
+  }
+
   // Stats
   function updateStats(text) {
     const wordCount = text.split(/\s+/).filter(w => w.length > 0).length;
@@ -2203,6 +2232,7 @@ window.accessibilityManager = accessibilityManager;
       'waveform-toggle': appSettings.waveform_animation !== undefined ? appSettings.waveform_animation : true,
       'continuous-dictation-toggle': appSettings.continuous_dictation !== undefined ? appSettings.continuous_dictation : false,
       'low-latency-toggle': appSettings.low_latency !== undefined ? appSettings.low_latency : false,
+      'model-cascade-toggle': appSettings.model_cascade !== undefined ? appSettings.model_cascade : false,
       'noise-reduction-toggle': appSettings.noise_reduction !== undefined ? appSettings.noise_reduction : false,
       'local-only-toggle': appSettings.local_only !== undefined ? appSettings.local_only : true,
       'auto-delete-cache-toggle': appSettings.auto_delete_cache !== undefined ? appSettings.auto_delete_cache : false,
@@ -3290,6 +3320,13 @@ window.accessibilityManager = accessibilityManager;
     });
   }
 
+  const modelCascadeToggle = document.getElementById('model-cascade-toggle');
+  if (modelCascadeToggle) {
+    modelCascadeToggle.addEventListener('change', (e) => {
+      saveAppSettings({ model_cascade: e.target.checked });
+    });
+  }
+
   const noiseReductionToggle = document.getElementById('noise-reduction-toggle');
   if (noiseReductionToggle) {
     noiseReductionToggle.addEventListener('change', (e) => {
@@ -4835,11 +4872,9 @@ window.accessibilityManager = accessibilityManager;
         notesSearchBtn.addEventListener('click', () => {
           const searchTerm = prompt('Search notes:');
           if (searchTerm && searchTerm.trim()) {
-            // Filter notes by search term
-            ipc.getNotes().then(notes => {
-              const filtered = notes.filter(note => 
-                note.text.toLowerCase().includes(searchTerm.toLowerCase())
-              );
+            // Search notes through the main-process index (prefix words, "quoted phrases")
+            ipc.search(searchTerm, { kinds: ['notes'], limit: 200 }).then(result => {
+              const filtered = ((result && result.items) || []).map(item => ({ id: item.id, text: item.text, timestamp: item.ts }));
               const notesList = document.getElementById('notes-list');
               const notesEmpty = document.getElementById('notes-empty');
               
@@ -5457,7 +5492,10 @@ window.accessibilityManager = accessibilityManager;
   if (window.voiceApp.onWhisperLoading) {
     window.voiceApp.onWhisperLoading((data) => {
       console.log('🔄 Whisper model loading...', data);
-      whisperModelReady = false;
+      // During a hot swap the previous model keeps serving dictation
+      if (!data?.hotSwap) {
+        whisperModelReady = false;
+      }
       modelLoadStartTime = Date.now();
       const activeModelStatus = document.getElementById('active-model-status');
       if (activeModelStatus) {
@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""
+Sidecar host for SONU
+One long-lived interpreter that serves the system_utils, model_manager and translation
+calls main.js used to make by spawning a fresh Python process each time
+"""
+
+import importlib
+import sys
+import threading
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+from ipc_protocol import Channel, read_frame
+
+# Slow calls (PyAudio device scan, translation) must not hold up quick ones
+MAX_WORKERS = 2
+
+
+def _system_info(modules, args):
+    return modules("system_utils").get_system_info()
+
+
+def _system_profile(modules, args):
+    return modules("system_utils").get_system_profile()
+
+
+def _suggest_model(modules, args):
+    return modules("system_utils").suggest_model()
+
+
+def _plan_cascade(modules, args):
+    return modules("system_utils").plan_cascade(args["model"])
+
+
+def _list_microphones(modules, args):
+    return modules("system_utils").list_microphones()
+
+
+def _model_space(modules, args):
+    return modules("model_manager").space_info()
+
+
+def _model_check(modules, args):
+    return modules("model_manager").check_model(args["model"], args.get("download_root"))
+
+
+def _translate(modules, args):
+    return modules("translation_service").translate_text(
+        args.get("text", ""), args.get("target", "en"), args.get("source", "en"))
+
+
+def _translate_dict(modules, args):
+    return modules("translation_service").translate_dict(
+        args.get("translations") or {}, args.get("target", "en"), args.get("source", "en"))
+
+
+def _translation_check(modules, args):
+    module = modules("translation_service")
+    return {"available": module.TRANSLATOR_AVAILABLE, "languages": list(module.LANGUAGE_MAP)}
+
+
+# op -> (handler, cacheable). Cacheable results describe the hardware and never
+# change while the app runs, so they are computed once per host process.
+OPS = {
+    "system_info": (_system_info, True),
+    "system_profile": (_system_profile, True),
+    "suggest_model": (_suggest_model, True),
+    "plan_cascade": (_plan_cascade, False),
+    "list_microphones": (_list_microphones, False),
+    "model_space": (_model_space, False),
+    "model_check": (_model_check, False),
+    "translate": (_translate, False),
+    "translate_dict": (_translate_dict, False),
+    "translation_check": (_translation_check, False),
+}
+
+
+class SidecarHost:
+    """Dispatches ``{id, op, args}`` requests to lazily imported modules.
+
+    Each module is imported once, on the first call that needs it, and kept for
+    the life of the process. Requests run on a small thread pool so answers can
+    come back out of order; ``respond(id, **fields)`` is called exactly once
+    per request with ``ok`` and either ``result`` or ``error``, plus ``ms``
+    (time spent in the host) and ``cached``.
+    """
+
+    def __init__(self, respond, ops=None, importer=importlib.import_module, workers=MAX_WORKERS):
+        self._respond = respond
+        self._ops = OPS if ops is None else ops
+        self._import = importer
+        self._modules = {}
+        self._importing = {}  # module name -> lock held only while that module imports
+        self._cache = {}
+        self._once = {op: threading.Lock() for op, (_, cacheable) in self._ops.items() if cacheable}
+        self._lock = threading.Lock()
+        self._pool = ThreadPoolExecutor(max_workers=workers, thread_name_prefix="sidecar")
+        self.stats = {"calls": 0, "cached": 0, "failed": 0}
+        self.op_ms = {}  # op -> (calls, total ms)
+
+    def module(self, name):
+        with self._lock:
+            module = self._modules.get(name)
+            if module is not None:
+                return module
+            importing = self._importing.setdefault(name, threading.Lock())
+        # A slow first import (GPUtil, translation) only holds up callers of that module
+        with importing:
+            with self._lock:
+                module = self._modules.get(name)
+            if module is None:
+                module = self._import(name)
+                with self._lock:
+                    self._modules[name] = module
+            return module
+
+    def submit(self, request_id, op, args=None):
+        if op == "stats":
+            self._respond(request_id, ok=True, result=self.snapshot(), ms=0.0, cached=False)
+            return
+        if op not in self._ops:
+            self._respond(request_id, ok=False, error="unknown_op", ms=0.0, cached=False)
+            return
+        self._pool.submit(self._serve, request_id, op, args or {})
+
+    def call(self, op, args=None):
+        """Run one op on the calling thread; returns ``(result, cached)``."""
+        handler, cacheable = self._ops[op]
+        if not cacheable:
+            return handler(self.module, args or {}), False
+        # Concurrent first calls wait for one computation instead of each running it
+        with self._once[op]:
+            if op in self._cache:
+                return self._cache[op], True
+            result = handler(self.module, args or {})
+            with self._lock:
+                self._cache[op] = result
+            return result, False
+
+    def snapshot(self):
+        with self._lock:
+            return {
+                "modules": sorted(self._modules),
+                "cached_ops": sorted(self._cache),
+                "stats": dict(self.stats),
+                "avg_ms": {op: round(total / calls, 3) for op, (calls, total) in self.op_ms.items()},
+            }
+
+    def shutdown(self):
+        self._pool.shutdown(wait=True)
+
+    def _serve(self, request_id, op, args):
+        started = time.perf_counter()
+        try:
+            result, cached = self.call(op, args)
+            fields = {"ok": True, "result": result}
+        except Exception as e:
+            cached = False
+            fields = {"ok": False, "error": f"{type(e).__name__}: {e}"}
+        ms = round((time.perf_counter() - started) * 1000.0, 3)
+        with self._lock:
+            self.stats["calls"] += 1
+            if cached:
+                self.stats["cached"] += 1
+            if not fields["ok"]:
+                self.stats["failed"] += 1
+            calls, total = self.op_ms.get(op, (0, 0.0))
+            self.op_ms[op] = (calls + 1, total + ms)
+        self._respond(request_id, ms=ms, cached=cached, **fields)
+
+
+def main():
+    channel = Channel(framed=True)
+    host = SidecarHost(lambda request_id, **fields: channel.send("result", id=request_id, **fields))
+    channel.event("READY")
+    while True:
+        try:
+            message = read_frame(sys.stdin.buffer)
+        except ValueError as e:
+            sys.stderr.write(f"ERROR: bad frame: {e}\n")
+            sys.stderr.flush()
+            break
+        if message is None:
+            break  # main.js closed stdin
+        host.submit(message.get("id"), message.get("op"), message.get("args"))
+    host.shutdown()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,119 @@
+/**
+ * CPU budget for SONU
+ * Splits the machine's cores between the whisper service, the LLM service and background
+ * work, sets their OS priorities, and tracks the dictation phase so background jobs wait
+ * until capture, decoding and typing are done
+ */
+
+const os = require('os');
+
+const PHASES = ['idle', 'capture', 'decode', 'transform'];
+// A phase whose end was never seen (service crash, dropped final) lapses back to idle
+const PHASE_TIMEOUT_MS = { capture: 10 * 60 * 1000, decode: 30000, transform: 30000 };
+
+// Past this, extra decode threads mostly add contention
+const MAX_WHISPER_THREADS = 8;
+const MAX_LLM_THREADS = 4;
+
+class CpuBudget {
+  constructor(options = {}) {
+    this.cores = options.cores || (os.cpus() || []).length || 1;
+    this.platform = options.platform || process.platform;
+    this.phase = 'idle';
+    this.phaseTimer = null;
+    this.idleWaiters = [];
+    this.plan = this.computePlan();
+  }
+
+  // One core stays free for audio capture, the Electron main thread and typing.
+  // Whisper gets the rest: finals are the latency-critical decode. The LLM runs right
+  // after a final and alongside the next utterance's partials, so it gets half of
+  // that and a lower priority; background work (tuning, sidecar calls) gets the lowest.
+  computePlan() {
+    const reserved = this.cores >= 4 ? 1 : 0;
+    const usable = Math.max(1, this.cores - reserved);
+    const affinity = this.platform === 'linux' && reserved ? `${reserved}-${this.cores - 1}` : '';
+    const { PRIORITY_NORMAL, PRIORITY_BELOW_NORMAL, PRIORITY_LOW } = os.constants.priority;
+    return {
+      cores: this.cores,
+      reserved,
+      whisper: { threads: Math.min(MAX_WHISPER_THREADS, usable), priority: PRIORITY_NORMAL, affinity },
+      llm: { threads: Math.min(MAX_LLM_THREADS, Math.max(1, Math.floor(usable / 2))), priority: PRIORITY_BELOW_NORMAL, affinity },
+      background: { threads: 1, priority: PRIORITY_LOW, affinity }
+    };
+  }
+
+  // Environment for a service process: SONU_<SERVICE>_THREADS and SONU_CPU_AFFINITY
+  envFor(service) {
+    const budget = this.plan[service];
+    if (!budget) return {};
+    const env = { [`SONU_${service.toUpperCase()}_THREADS`]: String(budget.threads) };
+    if (budget.affinity) env.SONU_CPU_AFFINITY = budget.affinity;
+    return env;
+  }
+
+  // Lowering priority is always allowed; raising it usually needs privileges, so
+  // services start at the level they keep instead of being boosted per phase
+  applyPriority(service, pid) {
+    const budget = this.plan[service];
+    if (!budget || !pid) return false;
+    try {
+      os.setPriority(pid, budget.priority);
+      return true;
+    } catch (e) {
+      return false;
+    }
+  }
+
+  setPhase(phase) {
+    if (!PHASES.includes(phase) || phase === this.phase) return;
+    this.phase = phase;
+    if (this.phaseTimer) clearTimeout(this.phaseTimer);
+    this.phaseTimer = null;
+    if (PHASE_TIMEOUT_MS[phase]) {
+      this.phaseTimer = setTimeout(() => this.endPhase(phase), PHASE_TIMEOUT_MS[phase]);
+      if (this.phaseTimer.unref) this.phaseTimer.unref();
+    }
+    if (phase === 'idle') this.flushIdle();
+  }
+
+  // Leave a phase only if nothing has moved on since (e.g. a new recording started)
+  endPhase(phase) {
+    if (this.phase === phase) this.setPhase('idle');
+  }
+
+  isIdle() {
+    return this.phase === 'idle';
+  }
+
+  // Run background work now if idle, otherwise once the current dictation has finished
+  whenIdle(fn) {
+    if (this.isIdle()) {
+      fn();
+    } else {
+      this.idleWaiters.push(fn);
+    }
+  }
+
+  flushIdle() {
+    const waiters = this.idleWaiters;
+    this.idleWaiters = [];
+    for (const fn of waiters) {
+      if (!this.isIdle()) {
+        this.idleWaiters.push(fn);
+        continue;
+      }
+      try {
+        fn();
+      } catch (e) {
+        console.error('Deferred background task failed:', e);
+      }
+    }
+  }
+
+  getStatus() {
+    return { phase: this.phase, deferred: this.idleWaiters.length, plan: this.plan };
+  }
+}
+
+module.exports = { CpuBudget, PHASES };
@@ -0,0 +1,145 @@
+/**
+ * Edit scripts for SONU
+ * Turns "what is on screen" into "what the recogniser now says" with the fewest keystrokes
+ * the typing backends can send: backspaces from the cursor, then the new text. Rewrites
+ * are capped; past the cap, words are aligned (by timestamps when the decoder sent them,
+ * by word-level edit distance otherwise) and only the part after the cap is corrected
+ */
+
+// How many characters before the cursor a correction may erase
+const MAX_BACKSPACES = 60;
+// Word alignment looks at this many trailing words of the screen
+const MAX_ALIGN_WORDS = 64;
+
+// Same normalisation as streaming_decoder.normalize_word: case and punctuation don't count
+function normalizeWord(word) {
+  return word.toLowerCase().replace(/[^\p{L}\p{N}']/gu, '');
+}
+
+// [{ word, start, end }] - positions of whitespace-separated words in text
+function splitWords(text) {
+  const words = [];
+  const pattern = /\S+/g;
+  let match;
+  while ((match = pattern.exec(text)) !== null) {
+    words.push({ word: match[0], start: match.index, end: match.index + match[0].length });
+  }
+  return words;
+}
+
+function commonPrefixLength(a, b) {
+  const limit = Math.min(a.length, b.length);
+  let i = 0;
+  while (i < limit && a.charCodeAt(i) === b.charCodeAt(i)) i++;
+  // Never split a surrogate pair
+  if (i > 0 && i < a.length && /[\uD800-\uDBFF]/.test(a[i - 1])) i--;
+  return i;
+}
+
+// For each word of a, the index of the word of b it lines up with (equal or substituted),
+// or -1 where a's word was dropped; minimum word-level edit distance
+function alignWords(a, b) {
+  const n = a.length;
+  const m = b.length;
+  const cost = Array.from({ length: n + 1 }, () => new Uint32Array(m + 1));
+  for (let i = 0; i <= n; i++) cost[i][0] = i;
+  for (let j = 0; j <= m; j++) cost[0][j] = j;
+  for (let i = 1; i <= n; i++) {
+    for (let j = 1; j <= m; j++) {
+      const replace = cost[i - 1][j - 1] + (a[i - 1] === b[j - 1] ? 0 : 1);
+      cost[i][j] = Math.min(replace, cost[i - 1][j] + 1, cost[i][j - 1] + 1);
+    }
+  }
+  const map = new Array(n).fill(-1);
+  let i = n;
+  let j = m;
+  while (i > 0 && j > 0) {
+    if (cost[i][j] === cost[i - 1][j - 1] + (a[i - 1] === b[j - 1] ? 0 : 1)) {
+      map[--i] = --j;
+    } else if (cost[i][j] === cost[i - 1][j] + 1) {
+      i--;
+    } else {
+      j--;
+    }
+  }
+  return map;
+}
+
+// Index of the first hypothesis word that replaces screen word k onwards (k may be the
+// word count, meaning "after the last screen word")
+function alignedIndex(screenWords, nextWords, k, screenTimes, nextTimes) {
+  if (screenTimes && nextTimes) {
+    // Word midpoints: a boundary moving by a few ms must not re-map a word
+    const from = k < screenTimes.length ? screenTimes[k][1] : screenTimes[screenTimes.length - 1][2];
+    const j = nextTimes.findIndex(([, start, end]) => (start + end) / 2 >= from);
+    return j === -1 ? nextWords.length : j;
+  }
+  const n = screenWords.length;
+  const first = Math.max(0, Math.min(k, n - MAX_ALIGN_WORDS));
+  const offset = Math.max(0, first - 16);
+  const map = alignWords(
+    screenWords.slice(first).map(w => normalizeWord(w.word)),
+    nextWords.slice(offset).map(w => normalizeWord(w.word))
+  );
+  // Screen word k is replaced by its counterpart; failing that, by whatever follows the
+  // counterpart of the nearest aligned word before it
+  if (k < n && map[k - first] >= 0) return offset + map[k - first];
+  for (let i = Math.min(k, n) - 1; i >= first; i--) {
+    if (map[i - first] >= 0) return offset + map[i - first] + 1;
+  }
+  return offset;
+}
+
+// Timestamps count only if there is one per word of the text they claim to describe
+function usableTimes(times, words) {
+  return Array.isArray(times) && times.length > 0 && times.length === words.length ? times : null;
+}
+
+/**
+ * Keystrokes that take the screen from `screen` to (as close as the cap allows) `next`.
+ * Returns { backspaces, text, screen, times }: press backspace `backspaces` times, type
+ * `text`; `screen` is what is on screen afterwards and `times` its word timestamps
+ * (or null). `screenTimes`/`nextTimes` are [word, start_ms, end_ms] per word.
+ */
+function planEdit(screen, next, options = {}) {
+  const maxBackspaces = options.maxBackspaces ?? MAX_BACKSPACES;
+  screen = screen || '';
+  next = next || '';
+  const nextWordList = splitWords(next);
+  const nextTimes = usableTimes(options.nextTimes, nextWordList);
+
+  // With edits only at the cursor, keeping the longest common prefix is the minimum:
+  // everything after it has to be erased and retyped anyway
+  const prefix = commonPrefixLength(screen, next);
+  if (screen.length - prefix <= maxBackspaces) {
+    return { backspaces: screen.length - prefix, text: next.slice(prefix), screen: next, times: nextTimes };
+  }
+
+  // Too far back: leave the words before the cap alone and line up the rest
+  const screenWordList = splitWords(screen);
+  const screenTimes = usableTimes(options.screenTimes, screenWordList);
+  let k = screenWordList.findIndex(w => screen.length - w.start <= maxBackspaces);
+  if (k === -1) k = screenWordList.length;
+  const useTimes = screenTimes && nextTimes;
+  const j = alignedIndex(screenWordList, nextWordList, k, useTimes && screenTimes, useTimes && nextTimes);
+
+  let target;
+  if (k < screenWordList.length) {
+    const keep = screen.slice(0, screenWordList[k].start);
+    target = j < nextWordList.length ? keep + next.slice(nextWordList[j].start) : keep.replace(/\s+$/, '');
+  } else if (j < nextWordList.length) {
+    target = screen + (/\s$/.test(screen) || !screen ? '' : ' ') + next.slice(nextWordList[j].start);
+  } else {
+    target = screen;
+  }
+  const kept = commonPrefixLength(screen, target);
+  const times = useTimes ? screenTimes.slice(0, k).concat(nextTimes.slice(j)) : null;
+  return {
+    backspaces: screen.length - kept,
+    text: target.slice(kept),
+    screen: target,
+    times: usableTimes(times, splitWords(target))
+  };
+}
+
+module.exports = { planEdit, alignWords, splitWords, normalizeWord, MAX_BACKSPACES };
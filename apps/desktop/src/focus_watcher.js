@@ -0,0 +1,161 @@
+/**
+ * Focus watcher for SONU
+ * Keeps the foreground app, window title and style category in memory as focus changes,
+ * so context detection at dictation start is a lookup instead of a subprocess. Sources
+ * push changes in: on Linux the text injector (X11 _NET_ACTIVE_WINDOW events), on
+ * Windows and macOS a long-lived helper script started here
+ */
+
+const EventEmitter = require('events');
+const { spawn } = require('child_process');
+
+// Matched against the app name and window title, lowercased; first category wins
+const CATEGORY_APPS = [
+  ['email', ['outlook', 'gmail', 'thunderbird', 'mail', 'spark', 'airmail']],
+  ['work', ['slack', 'teams', 'discord', 'zoom']],
+  ['personal', ['whatsapp', 'telegram', 'signal', 'messenger', 'imessage', 'messages']]
+];
+
+const RESTART_DELAY_MS = 5000;
+const MAX_RESTARTS = 5;
+
+// Windows has no focus-change event short of a WinEvent hook with a message loop, so the
+// helper checks the foreground window every 250 ms and prints only when it changes
+const WINDOWS_SCRIPT = `
+Add-Type @"
+using System; using System.Runtime.InteropServices; using System.Text;
+public class SonuForeground {
+  [DllImport("user32.dll")] public static extern IntPtr GetForegroundWindow();
+  [DllImport("user32.dll", CharSet = CharSet.Unicode)] public static extern int GetWindowText(IntPtr hWnd, StringBuilder text, int count);
+  [DllImport("user32.dll")] public static extern uint GetWindowThreadProcessId(IntPtr hWnd, out uint pid);
+}
+"@
+$last = ''
+while ($true) {
+  $hwnd = [SonuForeground]::GetForegroundWindow()
+  $sb = New-Object System.Text.StringBuilder 512
+  [void][SonuForeground]::GetWindowText($hwnd, $sb, $sb.Capacity)
+  $procId = 0
+  [void][SonuForeground]::GetWindowThreadProcessId($hwnd, [ref]$procId)
+  $name = ''
+  try { $name = (Get-Process -Id $procId -ErrorAction Stop).ProcessName } catch {}
+  $line = "$hwnd\`t$name\`t$($sb.ToString())"
+  if ($line -ne $last) { [Console]::Out.WriteLine($line); [Console]::Out.Flush(); $last = $line }
+  Start-Sleep -Milliseconds 250
+}
+`;
+
+// JXA; console.log goes to stderr
+const MAC_SCRIPT = `
+var events = Application('System Events');
+var last = '';
+while (true) {
+  try {
+    var proc = events.processes.whose({ frontmost: true })[0];
+    var title = '';
+    try { title = proc.windows[0].name() || ''; } catch (e) {}
+    var line = proc.unixId() + '\\t' + proc.name() + '\\t' + title;
+    if (line !== last) { last = line; console.log(line); }
+  } catch (e) {}
+  delay(0.25);
+}
+`;
+
+function categorize(app, title) {
+  const haystack = `${app || ''} ${title || ''}`.toLowerCase();
+  for (const [category, apps] of CATEGORY_APPS) {
+    if (apps.some(name => haystack.includes(name))) return category;
+  }
+  return null;
+}
+
+class FocusWatcher extends EventEmitter {
+  // ignore(info) drops focus changes to windows that aren't dictation targets (SONU's own)
+  constructor(options = {}) {
+    super();
+    this.platform = options.platform || process.platform;
+    this.spawn = options.spawn || spawn;
+    this.ignore = options.ignore || (() => false);
+    this.current = null; // { window, app, title, category, at }
+    this.child = null;
+    this.stopped = true;
+    this.restarts = 0;
+  }
+
+  // Memory read; null until a source has reported a window that maps to a category
+  category() {
+    return this.current ? this.current.category : null;
+  }
+
+  update({ window = 0, app = '', title = '' } = {}) {
+    const info = { window, app, title };
+    if (this.ignore(info)) return;
+    const previous = this.current;
+    this.current = { ...info, category: categorize(app, title), at: Date.now() };
+    if (!previous || previous.category !== this.current.category || previous.app !== app) {
+      this.emit('change', this.current);
+    }
+  }
+
+  // Starts the helper script where one is needed; Linux is fed by the text injector
+  start() {
+    this.stopped = false;
+    if (this.child) return;
+    let command;
+    let args;
+    if (this.platform === 'win32') {
+      command = 'powershell';
+      args = ['-NoProfile', '-NonInteractive', '-EncodedCommand', Buffer.from(WINDOWS_SCRIPT, 'utf16le').toString('base64')];
+    } else if (this.platform === 'darwin') {
+      command = 'osascript';
+      args = ['-l', 'JavaScript', '-e', MAC_SCRIPT];
+    } else {
+      return;
+    }
+    try {
+      this.child = this.spawn(command, args, { stdio: ['ignore', 'pipe', 'pipe'], windowsHide: true });
+    } catch (e) {
+      console.warn('Focus watcher unavailable:', e.message);
+      return;
+    }
+    const child = this.child;
+    let pending = '';
+    const onData = (data) => {
+      pending += data.toString();
+      const lines = pending.split(/\r?\n/);
+      pending = lines.pop();
+      for (const line of lines) this.handleLine(line);
+    };
+    child.stdout.on('data', onData);
+    child.stderr.on('data', onData);
+    const onGone = () => {
+      if (this.child !== child) return;
+      this.child = null;
+      if (this.stopped || this.restarts >= MAX_RESTARTS) return;
+      this.restarts++;
+      setTimeout(() => { if (!this.stopped) this.start(); }, RESTART_DELAY_MS).unref();
+    };
+    child.on('error', (e) => {
+      console.warn('Focus watcher stopped:', e.message);
+      onGone();
+    });
+    child.on('exit', onGone);
+  }
+
+  // "<window>\t<app>\t<title>" from a helper script
+  handleLine(line) {
+    const [window, app, ...title] = line.split('\t');
+    if (app === undefined) return;
+    this.update({ window: Number(window) || 0, app, title: title.join('\t') });
+  }
+
+  stop() {
+    this.stopped = true;
+    if (this.child) {
+      try { this.child.kill(); } catch (e) {}
+      this.child = null;
+    }
+  }
+}
+
+module.exports = { FocusWatcher, categorize };
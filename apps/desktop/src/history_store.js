@@ -0,0 +1,547 @@
+/**
+ * History store for SONU
+ * Append-only transcript history. Every change is one JSON line appended to the active
+ * segment file; an in-memory index (timestamp -> segment, offset, length) finds each live
+ * entry, so appends never rewrite old data and the renderer can read a page at a time.
+ * Compaction copies the live entries into a fresh segment once most bytes are dead.
+ */
+
+const fs = require('fs');
+const path = require('path');
+
+const SEGMENT_MAX_BYTES = 4 * 1024 * 1024;
+// Dead bytes must exceed both this and the live bytes before a rewrite is worth it
+const COMPACT_MIN_DEAD_BYTES = 1024 * 1024;
+const INDEX_SAVE_DELAY_MS = 2000;
+const INDEX_VERSION = 1;
+const SEGMENT_RE = /^(\d{8})\.jsonl$/;
+// Above this many entries in one segment, one whole-file read beats per-entry reads
+const WHOLE_SEGMENT_READ = 64;
+
+function countWords(text) {
+  return String(text || '').split(/\s+/).filter(w => w.length > 0).length;
+}
+
+function segmentName(seg) {
+  return `${String(seg).padStart(8, '0')}.jsonl`;
+}
+
+class HistoryStore {
+  constructor(options = {}) {
+    this.dir = options.dir;
+    this.legacyPath = options.legacyPath || null;
+    this.segmentMaxBytes = options.segmentMaxBytes || SEGMENT_MAX_BYTES;
+    this.compactMinDeadBytes = options.compactMinDeadBytes ?? COMPACT_MIN_DEAD_BYTES;
+    // Compaction is background work; main.js defers it until dictation is idle
+    this.runCompaction = options.runCompaction || (job => job());
+    this.indexPath = path.join(this.dir, 'index.json');
+    this.reset();
+    this.opened = null;
+    this.writes = Promise.resolve(); // segment appends, in order
+    this.indexTimer = null;
+    this.indexSave = Promise.resolve();
+    this.reads = new Set();
+    this.compaction = null; // in-flight compaction
+    this.compactQueued = false;
+  }
+
+  reset() {
+    this.entries = new Map(); // ts -> { seg, off, len, words, duration }
+    this.order = []; // live timestamps, oldest first
+    this.segments = []; // segment numbers, oldest first; the last one takes appends
+    this.sizes = new Map(); // seg -> bytes
+    this.live = new Map(); // seg -> bytes still referenced by the index
+    this.words = 0;
+    this.duration = 0;
+    this.latest = null; // newest entry, so paste-last needs no read
+  }
+
+  segmentPath(seg) {
+    return path.join(this.dir, segmentName(seg));
+  }
+
+  open() {
+    if (!this.opened) this.opened = this.load();
+    return this.opened;
+  }
+
+  async load() {
+    await fs.promises.mkdir(this.dir, { recursive: true });
+    const onDisk = (await fs.promises.readdir(this.dir))
+      .map(name => SEGMENT_RE.exec(name))
+      .filter(Boolean)
+      .map(m => Number(m[1]))
+      .sort((a, b) => a - b);
+    const actual = new Map();
+    for (const seg of onDisk) {
+      actual.set(seg, (await fs.promises.stat(this.segmentPath(seg))).size);
+    }
+
+    if (!(await this.loadIndex(onDisk, actual))) {
+      this.reset();
+      for (const seg of onDisk) {
+        this.addSegment(seg);
+        await this.replay(seg, 0);
+      }
+    }
+    if (!this.segments.length) this.addSegment(1);
+    if (this.order.length) {
+      this.latest = await this.readEntry(this.order[this.order.length - 1]);
+    }
+    if (this.legacyPath && !this.order.length) await this.importLegacy();
+    this.maybeCompact();
+  }
+
+  // The index is trusted only if it describes exactly the segments on disk; only the
+  // active segment may have grown since (appends after the last index save)
+  async loadIndex(onDisk, actual) {
+    let index;
+    try {
+      index = JSON.parse(await fs.promises.readFile(this.indexPath, 'utf8'));
+    } catch (e) {
+      return false;
+    }
+    if (!index || index.version !== INDEX_VERSION || !Array.isArray(index.segments)) return false;
+    // An active segment nothing was appended to yet has no file
+    const segments = index.segments.filter(([, size]) => size > 0);
+    const indexed = segments.map(([seg]) => seg);
+    if (indexed.length !== onDisk.length || indexed.some((seg, i) => seg !== onDisk[i])) return false;
+    const last = indexed[indexed.length - 1];
+    for (const [seg, size] of segments) {
+      const real = actual.get(seg);
+      if (real < size || (real > size && seg !== last)) return false;
+    }
+    for (const [seg, size] of segments) {
+      this.addSegment(seg);
+      this.sizes.set(seg, size);
+    }
+    for (const [ts, seg, off, len, words, duration] of index.entries || []) {
+      if (!this.sizes.has(seg)) return false;
+      this.entries.set(ts, { seg, off, len, words, duration });
+      this.live.set(seg, this.live.get(seg) + len);
+      this.order.push(ts);
+      this.words += words;
+      this.duration += duration;
+    }
+    if (last !== undefined && actual.get(last) > this.sizes.get(last)) {
+      await this.replay(last, this.sizes.get(last));
+    }
+    return true;
+  }
+
+  addSegment(seg) {
+    if (this.sizes.has(seg)) return;
+    this.segments.push(seg);
+    this.segments.sort((a, b) => a - b);
+    this.sizes.set(seg, 0);
+    this.live.set(seg, 0);
+  }
+
+  // Applies a segment's records from `from`; a torn last line (crash mid-append) is cut off
+  async replay(seg, from) {
+    const data = await fs.promises.readFile(this.segmentPath(seg));
+    let off = from;
+    while (off < data.length) {
+      const end = data.indexOf(0x0a, off);
+      if (end === -1) break;
+      let record;
+      try {
+        record = JSON.parse(data.toString('utf8', off, end));
+      } catch (e) {
+        break;
+      }
+      this.apply(record, seg, off, end + 1 - off);
+      off = end + 1;
+    }
+    this.sizes.set(seg, off);
+    if (off < data.length) {
+      console.warn(`History segment ${segmentName(seg)}: dropping ${data.length - off} torn bytes`);
+      await fs.promises.truncate(this.segmentPath(seg), off);
+    }
+  }
+
+  apply(record, seg, off, len) {
+    const { op, ts } = record;
+    if (op === 'add' || op === 'edit') {
+      const prev = this.entries.get(ts);
+      if (prev) {
+        this.drop(prev);
+      } else {
+        this.insertOrder(ts);
+      }
+      const words = countWords(record.text);
+      const duration = Number(record.duration) || 0;
+      this.entries.set(ts, { seg, off, len, words, duration });
+      this.live.set(seg, this.live.get(seg) + len);
+      this.words += words;
+      this.duration += duration;
+    } else if (op === 'del') {
+      const prev = this.entries.get(ts);
+      if (prev) {
+        this.drop(prev);
+        this.entries.delete(ts);
+        this.removeOrder(ts);
+      }
+    } else if (op === 'clear') {
+      for (const prev of this.entries.values()) this.drop(prev);
+      this.entries.clear();
+      this.order = [];
+    }
+  }
+
+  drop(location) {
+    this.live.set(location.seg, this.live.get(location.seg) - location.len);
+    this.words -= location.words;
+    this.duration -= location.duration;
+  }
+
+  // Dictations arrive in time order, so this is nearly always a push
+  insertOrder(ts) {
+    const order = this.order;
+    if (!order.length || order[order.length - 1] < ts) {
+      order.push(ts);
+      return;
+    }
+    let lo = 0;
+    let hi = order.length;
+    while (lo < hi) {
+      const mid = (lo + hi) >> 1;
+      if (order[mid] < ts) lo = mid + 1; else hi = mid;
+    }
+    order.splice(lo, 0, ts);
+  }
+
+  removeOrder(ts) {
+    const i = this.order.lastIndexOf(ts);
+    if (i !== -1) this.order.splice(i, 1);
+  }
+
+  // Index update is synchronous; the disk write is queued behind earlier ones
+  write(record) {
+    let seg = this.segments[this.segments.length - 1];
+    const line = `${JSON.stringify(record)}\n`;
+    const len = Buffer.byteLength(line);
+    if (this.sizes.get(seg) > 0 && this.sizes.get(seg) + len > this.segmentMaxBytes) {
+      seg += 1;
+      this.addSegment(seg);
+    }
+    const off = this.sizes.get(seg);
+    this.sizes.set(seg, off + len);
+    this.apply(record, seg, off, len);
+    const file = this.segmentPath(seg);
+    this.writes = this.writes
+      .then(() => fs.promises.appendFile(file, line))
+      .catch(e => console.warn('Failed to append history:', e.message));
+    this.scheduleIndexSave();
+    this.maybeCompact();
+  }
+
+  async append(entry) {
+    await this.open();
+    return this.addEntry(entry);
+  }
+
+  addEntry(entry) {
+    let ts = Number(entry.ts) || Date.now();
+    while (this.entries.has(ts)) ts += 1; // the timestamp is the entry's id
+    const record = { ...entry, op: 'add', ts };
+    this.write(record);
+    const stored = { ...entry, ts };
+    if (!this.latest || ts >= this.latest.ts) this.latest = stored;
+    return stored;
+  }
+
+  async update(ts, fields) {
+    await this.open();
+    const current = await this.readEntry(ts);
+    if (!current) return null;
+    const updated = { ...current, ...fields, ts };
+    this.write({ ...updated, op: 'edit' });
+    if (this.latest && this.latest.ts === ts) this.latest = updated;
+    return updated;
+  }
+
+  async remove(ts) {
+    await this.open();
+    if (!this.entries.has(ts)) return false;
+    this.write({ op: 'del', ts });
+    if (this.latest && this.latest.ts === ts) {
+      this.latest = this.order.length ? await this.readEntry(this.order[this.order.length - 1]) : null;
+    }
+    return true;
+  }
+
+  // Clearing is a privacy action: compact right away so the text leaves the disk
+  async clear() {
+    await this.open();
+    this.write({ op: 'clear' });
+    this.latest = null;
+    await this.compact();
+  }
+
+  async replaceAll(items) {
+    await this.open();
+    this.write({ op: 'clear' });
+    this.latest = null;
+    for (const item of [...(items || [])].sort((a, b) => a.ts - b.ts)) {
+      const { op, ...entry } = item;
+      this.addEntry(entry);
+    }
+    await this.compact();
+  }
+
+  last() {
+    return this.latest;
+  }
+
+  // Live timestamps, oldest first
+  keys() {
+    return this.order.slice();
+  }
+
+  stats() {
+    return { count: this.order.length, words: this.words, duration: this.duration };
+  }
+
+  // Newest first: offset 0 is the latest dictation
+  async page({ offset = 0, limit = 50 } = {}) {
+    await this.open();
+    const total = this.order.length;
+    const end = Math.max(0, total - Math.max(0, offset));
+    const start = Math.max(0, end - Math.max(0, limit));
+    const items = await this.readEntries(this.order.slice(start, end));
+    return { items: items.reverse(), total, offset, limit };
+  }
+
+  // Oldest first, the shape history.json had
+  async all() {
+    await this.open();
+    return this.readEntries(this.order.slice());
+  }
+
+  async readEntry(ts) {
+    const [entry] = await this.readEntries([ts]);
+    return entry || null;
+  }
+
+  async readEntries(timestamps) {
+    return (await this.readAligned(timestamps)).filter(Boolean);
+  }
+
+  // One result per timestamp, null where the entry is gone or unreadable. Reads in
+  // flight are tracked so compaction never deletes a segment out from under one
+  readAligned(timestamps) {
+    const read = this.readLocations(timestamps);
+    this.reads.add(read);
+    const done = () => this.reads.delete(read);
+    read.then(done, done);
+    return read;
+  }
+
+  async readLocations(timestamps) {
+    // Entries appended while we wait must be on disk too before their locations are used
+    let writes;
+    do {
+      writes = this.writes;
+      await writes;
+    } while (writes !== this.writes);
+    const bySegment = new Map();
+    timestamps.forEach((ts, i) => {
+      const location = this.entries.get(ts);
+      if (!location) return;
+      if (!bySegment.has(location.seg)) bySegment.set(location.seg, []);
+      bySegment.get(location.seg).push([i, ts, location]);
+    });
+    const out = new Array(timestamps.length).fill(null);
+    for (const [seg, wanted] of bySegment) {
+      try {
+        if (wanted.length > WHOLE_SEGMENT_READ) {
+          const data = await fs.promises.readFile(this.segmentPath(seg));
+          for (const [i, ts, { off, len }] of wanted) out[i] = this.decode(data.subarray(off, off + len), ts);
+        } else {
+          const handle = await fs.promises.open(this.segmentPath(seg), 'r');
+          try {
+            for (const [i, ts, { off, len }] of wanted) {
+              const buffer = Buffer.alloc(len);
+              await handle.read(buffer, 0, len, off);
+              out[i] = this.decode(buffer, ts);
+            }
+          } finally {
+            await handle.close();
+          }
+        }
+      } catch (e) {
+        console.warn(`Failed to read history segment ${segmentName(seg)}:`, e.message);
+      }
+    }
+    return out;
+  }
+
+  decode(buffer, ts) {
+    try {
+      const { op, ...entry } = JSON.parse(buffer.toString('utf8'));
+      return { ...entry, ts };
+    } catch (e) {
+      return null;
+    }
+  }
+
+  deadBytes() {
+    let dead = 0;
+    for (const seg of this.segments) dead += this.sizes.get(seg) - this.live.get(seg);
+    return dead;
+  }
+
+  liveBytes() {
+    let live = 0;
+    for (const seg of this.segments) live += this.live.get(seg);
+    return live;
+  }
+
+  maybeCompact() {
+    if (this.compaction || this.compactQueued) return;
+    const dead = this.deadBytes();
+    if (dead < this.compactMinDeadBytes || dead <= this.liveBytes()) return;
+    this.compactQueued = true;
+    this.runCompaction(() => {
+      this.compactQueued = false;
+      this.compact().catch(e => console.warn('History compaction failed:', e.message));
+    });
+  }
+
+  // Live entries of every segment up to the active one are copied into segment A+1 while
+  // new appends go to A+2, so replay order (and crash recovery) stays correct throughout
+  async compact() {
+    while (this.compaction) await this.compaction.catch(() => {});
+    this.compaction = this.compactSegments();
+    try {
+      await this.compaction;
+    } finally {
+      this.compaction = null;
+    }
+  }
+
+  async compactSegments() {
+    const cutoff = this.segments[this.segments.length - 1];
+    const target = cutoff + 1;
+    this.addSegment(cutoff + 2);
+    const old = this.segments.filter(seg => seg <= cutoff);
+    const moving = this.order.filter(ts => this.entries.get(ts).seg <= cutoff);
+    const records = await this.readAligned(moving);
+
+    const lines = [];
+    const placed = [];
+    let off = 0;
+    for (const [i, entry] of records.entries()) {
+      if (!entry) {
+        // Deleted while we read is fine; still indexed in an old segment means unreadable
+        const location = this.entries.get(moving[i]);
+        if (location && location.seg <= cutoff) throw new Error('unreadable entries, keeping old segments');
+        continue;
+      }
+      const line = `${JSON.stringify({ ...entry, op: 'add' })}\n`;
+      const len = Buffer.byteLength(line);
+      lines.push(line);
+      placed.push([entry.ts, off, len]);
+      off += len;
+    }
+    if (lines.length) {
+      const tmpPath = `${this.segmentPath(target)}.tmp`;
+      await fs.promises.writeFile(tmpPath, lines.join(''));
+      await fs.promises.rename(tmpPath, this.segmentPath(target));
+      this.addSegment(target);
+      this.sizes.set(target, off);
+    }
+
+    // Swap synchronously; entries edited or deleted meanwhile already point past the cutoff
+    for (const [ts, entryOff, len] of placed) {
+      const location = this.entries.get(ts);
+      if (!location || location.seg > cutoff) continue;
+      this.live.set(location.seg, this.live.get(location.seg) - location.len);
+      this.entries.set(ts, { ...location, seg: target, off: entryOff, len });
+      this.live.set(target, this.live.get(target) + len);
+    }
+    for (const seg of old) {
+      this.segments.splice(this.segments.indexOf(seg), 1);
+      this.sizes.delete(seg);
+      this.live.delete(seg);
+    }
+    await this.saveIndex();
+    await Promise.all([...this.reads].map(read => read.catch(() => {})));
+    for (const seg of old) {
+      await fs.promises.unlink(this.segmentPath(seg)).catch(() => {});
+    }
+  }
+
+  snapshotIndex() {
+    return JSON.stringify({
+      version: INDEX_VERSION,
+      segments: this.segments.map(seg => [seg, this.sizes.get(seg)]),
+      entries: this.order.map(ts => {
+        const { seg, off, len, words, duration } = this.entries.get(ts);
+        return [ts, seg, off, len, words, duration];
+      })
+    });
+  }
+
+  scheduleIndexSave() {
+    if (this.indexTimer) return;
+    this.indexTimer = setTimeout(() => {
+      this.indexTimer = null;
+      this.saveIndex().catch(e => console.warn('Failed to save history index:', e.message));
+    }, INDEX_SAVE_DELAY_MS);
+    if (this.indexTimer.unref) this.indexTimer.unref();
+  }
+
+  // Saves are chained so two never share the temp file
+  saveIndex() {
+    if (this.indexTimer) {
+      clearTimeout(this.indexTimer);
+      this.indexTimer = null;
+    }
+    this.indexSave = this.indexSave.catch(() => {}).then(() => this.writeIndex());
+    return this.indexSave;
+  }
+
+  async writeIndex() {
+    await this.writes;
+    const tmpPath = `${this.indexPath}.tmp`;
+    await fs.promises.writeFile(tmpPath, this.snapshotIndex());
+    await fs.promises.rename(tmpPath, this.indexPath);
+  }
+
+  // For will-quit. If queued appends never land the sizes won't match and the next
+  // start rebuilds the index from the segments instead
+  saveIndexSync() {
+    if (!this.opened) return;
+    if (this.indexTimer) {
+      clearTimeout(this.indexTimer);
+      this.indexTimer = null;
+    }
+    try {
+      const tmpPath = `${this.indexPath}.tmp`;
+      fs.writeFileSync(tmpPath, this.snapshotIndex());
+      fs.renameSync(tmpPath, this.indexPath);
+    } catch (e) {
+      console.warn('Failed to save history index:', e.message);
+    }
+  }
+
+  // One-time move of the old capped history.json into the store
+  async importLegacy() {
+    let items;
+    try {
+      items = JSON.parse(await fs.promises.readFile(this.legacyPath, 'utf8'));
+    } catch (e) {
+      return;
+    }
+    if (!Array.isArray(items)) return;
+    for (const item of items.filter(i => i && typeof i.text === 'string').sort((a, b) => a.ts - b.ts)) {
+      this.addEntry(item);
+    }
+    await this.saveIndex();
+    await fs.promises.rename(this.legacyPath, `${this.legacyPath}.migrated`).catch(() => {});
+  }
+}
+
+module.exports = { HistoryStore, countWords };
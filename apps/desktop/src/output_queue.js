@@ -0,0 +1,121 @@
+/**
+ * Output queue for SONU
+ * The single path from transcripts to keystrokes: text is injected strictly in the order
+ * it was queued, one injection at a time. Edits (backspaces plus text) that pile up while
+ * an injection is in flight are merged into one, and a growing backlog is reported so
+ * partials can be throttled at the decoder
+ */
+
+const EventEmitter = require('events');
+
+// Backlog (characters not yet injected) at which the decoder is asked to hold partials
+const HIGH_WATER_CHARS = 200;
+
+class OutputQueue extends EventEmitter {
+  // inject(text, { backspaces, utterance }) returns a promise that settles once the
+  // edit has been typed (or given up on)
+  constructor(options = {}) {
+    super();
+    this.inject = options.inject;
+    this.highWaterChars = options.highWaterChars ?? HIGH_WATER_CHARS;
+    this.items = []; // { backspaces, text, utterance } waiting, oldest first
+    this.inFlight = null; // item being injected
+    this.pressure = false;
+    this.idleWaiters = [];
+    this.stats = { queued: 0, injections: 0, coalesced: 0, dropped: 0, failed: 0 };
+  }
+
+  // Text of one utterance never interleaves with another's: only the newest waiting
+  // item can absorb a new edit, and only if it is from the same utterance
+  push(text, { utterance = null, backspaces = 0 } = {}) {
+    text = text || '';
+    if (!text && !backspaces) return;
+    this.stats.queued++;
+    const tail = this.items[this.items.length - 1];
+    if (tail && tail.utterance === utterance) {
+      // Backspaces first eat text that was never typed, then reach further back
+      const eaten = Math.min(backspaces, tail.text.length);
+      tail.text = tail.text.slice(0, tail.text.length - eaten) + text;
+      tail.backspaces += backspaces - eaten;
+      this.stats.coalesced++;
+    } else {
+      this.items.push({ backspaces, text, utterance });
+    }
+    this.updatePressure();
+    this.pump();
+  }
+
+  // Forget text of an utterance that hasn't started typing (e.g. it was cancelled)
+  dropUtterance(utterance) {
+    const before = this.items.length;
+    this.items = this.items.filter(item => item.utterance !== utterance);
+    this.stats.dropped += before - this.items.length;
+    this.updatePressure();
+    if (!this.items.length && !this.inFlight) this.settleIdle();
+  }
+
+  backlog() {
+    let chars = this.inFlight ? this.inFlight.backspaces + this.inFlight.text.length : 0;
+    for (const item of this.items) chars += item.backspaces + item.text.length;
+    return chars;
+  }
+
+  isIdle() {
+    return !this.inFlight && !this.items.length;
+  }
+
+  // Resolves once everything queued so far has been injected
+  whenIdle() {
+    if (this.isIdle()) return Promise.resolve();
+    return new Promise(resolve => this.idleWaiters.push(resolve));
+  }
+
+  pump() {
+    if (this.inFlight || !this.items.length) return;
+    const item = this.items.shift();
+    this.inFlight = item;
+    this.stats.injections++;
+    Promise.resolve()
+      .then(() => this.inject(item.text, { backspaces: item.backspaces, utterance: item.utterance }))
+      .then((ok) => {
+        if (ok === false) this.stats.failed++;
+      }, (error) => {
+        this.stats.failed++;
+        console.error('Text injection failed:', error);
+      })
+      .finally(() => {
+        this.inFlight = null;
+        this.updatePressure();
+        if (this.items.length) {
+          this.pump();
+        } else {
+          this.settleIdle();
+        }
+      });
+  }
+
+  // Emits 'pressure' (true) above the high-water mark and (false) once fully drained
+  updatePressure() {
+    const backlog = this.backlog();
+    if (!this.pressure && backlog > this.highWaterChars) {
+      this.pressure = true;
+      this.emit('pressure', true);
+    } else if (this.pressure && backlog === 0) {
+      this.pressure = false;
+      this.emit('pressure', false);
+    }
+  }
+
+  settleIdle() {
+    const waiters = this.idleWaiters;
+    this.idleWaiters = [];
+    for (const resolve of waiters) resolve();
+    this.emit('drain');
+  }
+
+  getStatus() {
+    return { ...this.stats, waiting: this.items.length, backlog: this.backlog(), pressure: this.pressure };
+  }
+}
+
+module.exports = { OutputQueue };
@@ -25,13 +25,17 @@ class PerformanceMonitor {
       audio: {
         bufferUnderruns: 0,
         sampleRate: 16000,
-        channels: 1
+        channels: 1,
+        captureLatency: 0,
+        avgCaptureLatency: 0,
+        captureLatencySamples: 0
       },
       ui: {
         renderTime: 0,
         interactionLatency: 0,
         themeSwitchTime: 0
-      }
+      },
+      sidecar: {}
     };
 
     this.isEnabled = true;
@@ -252,6 +256,37 @@ class PerformanceMonitor {
     this.metrics.audio.bufferUnderruns++;
   }
 
+  // Hotkey-to-first-sample latency reported by the whisper service
+  recordCaptureLatency(latency) {
+    if (!Number.isFinite(latency) || latency < 0) return;
+    const audio = this.metrics.audio;
+    audio.captureLatency = latency;
+    audio.captureLatencySamples = (audio.captureLatencySamples || 0) + 1;
+    audio.avgCaptureLatency += (latency - (audio.avgCaptureLatency || 0)) / audio.captureLatencySamples;
+  }
+
+  // Per-utterance breakdown from the whisper service's framed finals
+  recordUtteranceLatency(breakdown) {
+    const latency = breakdown && breakdown.release_to_final_ms;
+    if (!Number.isFinite(latency) || latency < 0) return;
+    const transcription = this.metrics.transcription;
+    transcription.lastUtterance = breakdown;
+    transcription.releaseToFinalSamples = (transcription.releaseToFinalSamples || 0) + 1;
+    transcription.avgReleaseToFinal = (transcription.avgReleaseToFinal || 0) +
+      (latency - (transcription.avgReleaseToFinal || 0)) / transcription.releaseToFinalSamples;
+  }
+
+  // Round trip and in-host time of one sidecar host call, per op
+  recordSidecarCall(op, roundTripMs, hostMs) {
+    if (!Number.isFinite(roundTripMs) || roundTripMs < 0) return;
+    const sidecar = this.metrics.sidecar || (this.metrics.sidecar = {});
+    const entry = sidecar[op] || (sidecar[op] = { calls: 0, avgRoundTrip: 0, avgHost: 0, lastRoundTrip: 0 });
+    entry.calls++;
+    entry.lastRoundTrip = roundTripMs;
+    entry.avgRoundTrip += (roundTripMs - entry.avgRoundTrip) / entry.calls;
+    if (Number.isFinite(hostMs)) entry.avgHost += (hostMs - entry.avgHost) / entry.calls;
+  }
+
   updateAudioConfig(sampleRate, channels) {
     this.metrics.audio.sampleRate = sampleRate;
     this.metrics.audio.channels = channels;
@@ -308,7 +343,8 @@ class PerformanceMonitor {
         warnings: this.metrics.memory.warnings || 0
       },
       audio: this.metrics.audio,
-      ui: this.metrics.ui
+      ui: this.metrics.ui,
+      sidecar: this.metrics.sidecar
     };
   }
 
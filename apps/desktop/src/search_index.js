@@ -0,0 +1,197 @@
+/**
+ * Search index for SONU
+ * In-memory inverted index over history, notes and snippets. Documents are added and
+ * removed one at a time as they change; queries match every bare word as a prefix and
+ * "quoted phrases" as consecutive words, newest results first, a page at a time
+ */
+
+// Deleted documents stay in the postings until they outnumber the live ones
+const MIN_DEAD_FOR_COMPACT = 1000;
+
+// Lowercased words with accents folded, so "Café" is found by "cafe"
+function tokenize(text) {
+  return String(text || '')
+    .normalize('NFKD')
+    .replace(/[\u0300-\u036f]/g, '')
+    .toLowerCase()
+    .match(/[\p{L}\p{N}]+/gu) || [];
+}
+
+// 'meet "next tuesday" tom' -> { words: ['meet', 'tom'], phrases: [['next', 'tuesday']] }
+function parseQuery(query) {
+  const words = [];
+  const phrases = [];
+  const text = String(query || '');
+  const quoted = /"([^"]*)"?/g;
+  let last = 0;
+  let match;
+  while ((match = quoted.exec(text)) !== null) {
+    words.push(...tokenize(text.slice(last, match.index)));
+    const phrase = tokenize(match[1]);
+    if (phrase.length > 1) phrases.push(phrase); else words.push(...phrase);
+    last = quoted.lastIndex;
+  }
+  words.push(...tokenize(text.slice(last)));
+  return { words, phrases };
+}
+
+function intersect(a, b) {
+  const out = [];
+  let i = 0;
+  let j = 0;
+  while (i < a.length && j < b.length) {
+    if (a[i] === b[j]) {
+      out.push(a[i]);
+      i++;
+      j++;
+    } else if (a[i] < b[j]) {
+      i++;
+    } else {
+      j++;
+    }
+  }
+  return out;
+}
+
+class SearchIndex {
+  constructor() {
+    this.reset();
+  }
+
+  reset() {
+    this.termIds = new Map(); // term -> id
+    this.terms = []; // id -> term
+    this.postings = []; // term id -> ascending doc numbers
+    this.sortedTerms = null; // for prefix ranges; rebuilt after new terms appear
+    this.docs = []; // doc number -> { key, kind, id, ts, tokens } or null once removed
+    this.docByKey = new Map(); // `${kind}:${id}` -> doc number
+    this.dead = 0;
+  }
+
+  get size() {
+    return this.docByKey.size;
+  }
+
+  termId(term) {
+    let id = this.termIds.get(term);
+    if (id === undefined) {
+      id = this.terms.length;
+      this.termIds.set(term, id);
+      this.terms.push(term);
+      this.postings.push([]);
+      this.sortedTerms = null;
+    }
+    return id;
+  }
+
+  // Adding an existing kind/id replaces it
+  add(kind, id, text, ts) {
+    const key = `${kind}:${id}`;
+    this.remove(kind, id);
+    const tokens = Uint32Array.from(tokenize(text), term => this.termId(term));
+    const doc = this.docs.length;
+    this.docs.push({ key, kind, id, ts: Number(ts) || 0, tokens });
+    this.docByKey.set(key, doc);
+    for (const term of new Set(tokens)) this.postings[term].push(doc);
+  }
+
+  remove(kind, id) {
+    const key = `${kind}:${id}`;
+    const doc = this.docByKey.get(key);
+    if (doc === undefined) return false;
+    this.docByKey.delete(key);
+    this.docs[doc] = null;
+    this.dead++;
+    if (this.dead >= MIN_DEAD_FOR_COMPACT && this.dead > this.docByKey.size) this.compact();
+    return true;
+  }
+
+  removeKind(kind) {
+    const ids = this.docs.filter(doc => doc && doc.kind === kind).map(doc => doc.id);
+    for (const id of ids) this.remove(kind, id);
+  }
+
+  // Renumbers live documents and drops postings of removed ones
+  compact() {
+    const live = this.docs.filter(Boolean);
+    const terms = this.terms;
+    this.reset();
+    for (const doc of live) {
+      const key = doc.key;
+      const tokens = Uint32Array.from(doc.tokens, term => this.termId(terms[term]));
+      const number = this.docs.length;
+      this.docs.push({ ...doc, tokens });
+      this.docByKey.set(key, number);
+      for (const term of new Set(tokens)) this.postings[term].push(number);
+    }
+  }
+
+  // Doc numbers containing a term that starts with `prefix`
+  prefixDocs(prefix) {
+    if (!this.sortedTerms) this.sortedTerms = [...this.terms].sort();
+    const sorted = this.sortedTerms;
+    let lo = 0;
+    let hi = sorted.length;
+    while (lo < hi) {
+      const mid = (lo + hi) >> 1;
+      if (sorted[mid] < prefix) lo = mid + 1; else hi = mid;
+    }
+    const lists = [];
+    for (let i = lo; i < sorted.length && sorted[i].startsWith(prefix); i++) {
+      lists.push(this.postings[this.termIds.get(sorted[i])]);
+    }
+    if (lists.length === 1) return lists[0];
+    const marks = new Uint8Array(this.docs.length);
+    for (const list of lists) for (const doc of list) marks[doc] = 1;
+    const out = [];
+    for (let doc = 0; doc < marks.length; doc++) if (marks[doc]) out.push(doc);
+    return out;
+  }
+
+  hasPhrase(tokens, phrase) {
+    outer:
+    for (let i = 0; i + phrase.length <= tokens.length; i++) {
+      for (let j = 0; j < phrase.length; j++) {
+        if (tokens[i + j] !== phrase[j]) continue outer;
+      }
+      return true;
+    }
+    return false;
+  }
+
+  // Returns { hits: [{ kind, id, ts }], total } - hits newest first
+  search(query, { kinds = null, offset = 0, limit = 50 } = {}) {
+    const { words, phrases } = parseQuery(query);
+    if (!words.length && !phrases.length) return { hits: [], total: 0 };
+
+    const clauses = [];
+    for (const word of words) clauses.push(this.prefixDocs(word));
+    const phraseIds = [];
+    for (const phrase of phrases) {
+      const ids = phrase.map(term => this.termIds.get(term));
+      if (ids.some(id => id === undefined)) return { hits: [], total: 0 };
+      phraseIds.push(ids);
+      for (const id of ids) clauses.push(this.postings[id]);
+    }
+    clauses.sort((a, b) => a.length - b.length);
+    let candidates = clauses[0];
+    for (let i = 1; i < clauses.length && candidates.length; i++) {
+      candidates = intersect(candidates, clauses[i]);
+    }
+
+    const wanted = kinds ? new Set(kinds) : null;
+    const matches = [];
+    for (const number of candidates) {
+      const doc = this.docs[number];
+      if (!doc || (wanted && !wanted.has(doc.kind))) continue;
+      if (phraseIds.every(ids => this.hasPhrase(doc.tokens, ids))) matches.push(doc);
+    }
+    matches.sort((a, b) => b.ts - a.ts);
+    const hits = matches
+      .slice(Math.max(0, offset), Math.max(0, offset) + Math.max(0, limit))
+      .map(({ kind, id, ts }) => ({ kind, id, ts }));
+    return { hits, total: matches.length };
+  }
+}
+
+module.exports = { SearchIndex, tokenize, parseQuery };
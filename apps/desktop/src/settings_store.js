@@ -0,0 +1,235 @@
+/**
+ * Settings store for SONU
+ * Loads data/settings.json once and serves reads from memory. Writes are batched and
+ * saved behind (temp file + rename), and edits made by other processes (the whisper
+ * tuner, a hand-edited file) are picked up through a directory watch
+ */
+
+const EventEmitter = require('events');
+const fs = require('fs');
+const path = require('path');
+
+const WRITE_DELAY_MS = 250;
+// Editors and os.replace() produce several events per save
+const RELOAD_DELAY_MS = 50;
+
+class SettingsStore extends EventEmitter {
+  // defaults double as the schema: a stored value whose type differs from its default
+  // (a hand-edited "preroll_ms": "500") reads as the default
+  constructor(options = {}) {
+    super();
+    this.filePath = options.filePath;
+    this.defaults = options.defaults || {};
+    this.writeDelayMs = options.writeDelayMs ?? WRITE_DELAY_MS;
+    this.values = {};
+    this.dirty = new Set(); // keys set here and not yet on disk
+    this.lastRaw = null; // file contents as last read or written, to skip our own writes
+    this.loaded = false;
+    this.exists = false;
+    this.writeTimer = null;
+    this.writing = null;
+    this.reloadTimer = null;
+    this.watcher = null;
+  }
+
+  // Synchronous so the first reads at startup already see the file
+  load() {
+    this.loaded = true;
+    try {
+      const raw = fs.readFileSync(this.filePath, 'utf8');
+      this.values = JSON.parse(raw);
+      this.lastRaw = raw;
+      this.exists = true;
+    } catch (e) {
+      if (e.code !== 'ENOENT') console.warn('Failed to load settings:', e.message);
+    }
+    return this;
+  }
+
+  get(key, fallback) {
+    if (!this.loaded) this.load();
+    const value = this.values[key];
+    const def = key in this.defaults ? this.defaults[key] : fallback;
+    if (value === undefined || value === null) return def;
+    if (def !== undefined && def !== null && typeof value !== typeof def) return def;
+    return value;
+  }
+
+  // Raw stored values; withDefaults fills in keys that were never saved
+  getAll(withDefaults = false) {
+    if (!this.loaded) this.load();
+    return withDefaults ? { ...this.defaults, ...this.values } : { ...this.values };
+  }
+
+  has(key) {
+    if (!this.loaded) this.load();
+    return this.exists && key in this.values;
+  }
+
+  // Applies the patch in memory now and schedules one write for the whole burst
+  set(patch) {
+    if (!this.loaded) this.load();
+    const changed = [];
+    for (const [key, value] of Object.entries(patch || {})) {
+      this.dirty.add(key);
+      if (JSON.stringify(this.values[key]) === JSON.stringify(value)) continue;
+      this.values[key] = value;
+      changed.push(key);
+    }
+    this.exists = true;
+    this.scheduleWrite();
+    if (changed.length) this.emit('change', changed, 'local');
+    return this.getAll();
+  }
+
+  scheduleWrite() {
+    if (this.writeTimer) return;
+    this.writeTimer = setTimeout(() => {
+      this.writeTimer = null;
+      this.flush().catch(e => console.warn('Failed to save settings:', e.message));
+    }, this.writeDelayMs);
+    if (this.writeTimer.unref) this.writeTimer.unref();
+  }
+
+  // Keys another process wrote since our last read survive; ours win where both changed
+  mergeDisk(raw) {
+    if (raw === null || raw === this.lastRaw) return;
+    let disk;
+    try {
+      disk = JSON.parse(raw);
+    } catch (e) {
+      return; // half-written by someone else; our copy is the better one
+    }
+    for (const key of Object.keys(disk)) {
+      if (!this.dirty.has(key)) this.values[key] = disk[key];
+    }
+  }
+
+  async flush() {
+    if (this.writeTimer) {
+      clearTimeout(this.writeTimer);
+      this.writeTimer = null;
+    }
+    // One write at a time; a set() during a write gets its own write afterwards
+    while (this.writing) await this.writing;
+    if (!this.dirty.size) return;
+    this.writing = this.writeAsync().finally(() => { this.writing = null; });
+    return this.writing;
+  }
+
+  async writeAsync() {
+    let current = null;
+    try {
+      current = await fs.promises.readFile(this.filePath, 'utf8');
+    } catch (e) {
+      // Not created yet
+    }
+    this.mergeDisk(current);
+    const pending = this.dirty;
+    this.dirty = new Set();
+    const raw = JSON.stringify(this.values, null, 2);
+    const tmpPath = `${this.filePath}.tmp`;
+    try {
+      await fs.promises.mkdir(path.dirname(this.filePath), { recursive: true });
+      await fs.promises.writeFile(tmpPath, raw);
+      this.lastRaw = raw;
+      await fs.promises.rename(tmpPath, this.filePath);
+    } catch (e) {
+      for (const key of pending) this.dirty.add(key);
+      throw e;
+    }
+  }
+
+  // For will-quit, where there is no event loop left to finish an async write
+  flushSync() {
+    if (this.writeTimer) {
+      clearTimeout(this.writeTimer);
+      this.writeTimer = null;
+    }
+    if (!this.dirty.size) return;
+    try {
+      let current = null;
+      try {
+        current = fs.readFileSync(this.filePath, 'utf8');
+      } catch (e) {
+        // Not created yet
+      }
+      this.mergeDisk(current);
+      const raw = JSON.stringify(this.values, null, 2);
+      const tmpPath = `${this.filePath}.tmp`;
+      fs.mkdirSync(path.dirname(this.filePath), { recursive: true });
+      fs.writeFileSync(tmpPath, raw);
+      fs.renameSync(tmpPath, this.filePath);
+      this.lastRaw = raw;
+      this.dirty.clear();
+    } catch (e) {
+      console.warn('Failed to save settings:', e.message);
+    }
+  }
+
+  // Watch the directory, not the file: a rename replaces the inode a file watch is on
+  watch() {
+    if (this.watcher) return;
+    const dir = path.dirname(this.filePath);
+    const name = path.basename(this.filePath);
+    try {
+      fs.mkdirSync(dir, { recursive: true });
+      this.watcher = fs.watch(dir, { persistent: false }, (_event, filename) => {
+        if (filename && filename.toString() !== name) return;
+        if (this.reloadTimer) clearTimeout(this.reloadTimer);
+        this.reloadTimer = setTimeout(() => {
+          this.reloadTimer = null;
+          this.reload();
+        }, RELOAD_DELAY_MS);
+      });
+      this.watcher.on('error', (e) => {
+        console.warn('Settings watch stopped:', e.message);
+        this.unwatch();
+      });
+    } catch (e) {
+      console.warn('Settings watch unavailable:', e.message);
+    }
+  }
+
+  unwatch() {
+    if (this.reloadTimer) clearTimeout(this.reloadTimer);
+    this.reloadTimer = null;
+    if (this.watcher) this.watcher.close();
+    this.watcher = null;
+  }
+
+  // Picks up an external edit; emits 'change' with the keys whose values differ
+  reload() {
+    let raw;
+    try {
+      raw = fs.readFileSync(this.filePath, 'utf8');
+    } catch (e) {
+      return [];
+    }
+    if (raw === this.lastRaw) return [];
+    let disk;
+    try {
+      disk = JSON.parse(raw);
+    } catch (e) {
+      return []; // mid-write; the rename that completes it fires another event
+    }
+    this.lastRaw = raw;
+    this.exists = true;
+    const changed = [];
+    const keys = new Set([...Object.keys(this.values), ...Object.keys(disk)]);
+    for (const key of keys) {
+      if (this.dirty.has(key)) continue;
+      if (JSON.stringify(this.values[key]) === JSON.stringify(disk[key])) continue;
+      if (key in disk) {
+        this.values[key] = disk[key];
+      } else {
+        delete this.values[key];
+      }
+      changed.push(key);
+    }
+    if (changed.length) this.emit('change', changed, 'external');
+    return changed;
+  }
+}
+
+module.exports = { SettingsStore };
@@ -0,0 +1,131 @@
+/**
+ * Transform cache for SONU
+ * Bounded LRU of finished style transformations (LLM or rule-based), keyed by the
+ * normalized transcript and the style settings, with optional write-behind persistence
+ */
+
+const fs = require('fs');
+const path = require('path');
+
+const DEFAULT_MAX_ENTRIES = 500;
+// Long dictations practically never repeat; keep the cache for phrases that do
+const DEFAULT_MAX_TEXT_LENGTH = 280;
+const SAVE_DELAY_MS = 2000;
+
+// Whisper varies whitespace between otherwise identical transcripts
+function normalizeTranscript(text) {
+  return String(text || '').trim().replace(/\s+/g, ' ');
+}
+
+class TransformCache {
+  constructor(options = {}) {
+    this.maxEntries = options.maxEntries || DEFAULT_MAX_ENTRIES;
+    this.maxTextLength = options.maxTextLength || DEFAULT_MAX_TEXT_LENGTH;
+    this.persistPath = options.persistPath || null;
+    this.entries = new Map(); // key -> transformed text, least recently used first
+    this.hits = 0;
+    this.misses = 0;
+    this.saveTimer = null;
+  }
+
+  // engine: 'llm' or 'rules' - the two produce different text for the same input
+  key(text, { engine, style, category }) {
+    const normalized = normalizeTranscript(text);
+    if (!normalized || normalized.length > this.maxTextLength) return null;
+    return `${engine}\u0000${style}\u0000${category}\u0000${normalized}`;
+  }
+
+  get(text, settings) {
+    const key = this.key(text, settings);
+    if (key === null) return undefined;
+    if (!this.entries.has(key)) {
+      this.misses++;
+      return undefined;
+    }
+    const value = this.entries.get(key);
+    // Re-insert to mark as most recently used
+    this.entries.delete(key);
+    this.entries.set(key, value);
+    this.hits++;
+    return value;
+  }
+
+  set(text, settings, value) {
+    const key = this.key(text, settings);
+    if (key === null || typeof value !== 'string') return;
+    this.entries.delete(key);
+    this.entries.set(key, value);
+    while (this.entries.size > this.maxEntries) {
+      this.entries.delete(this.entries.keys().next().value);
+    }
+    this.scheduleSave();
+  }
+
+  clear() {
+    this.entries.clear();
+    this.hits = 0;
+    this.misses = 0;
+    this.scheduleSave();
+  }
+
+  getStats() {
+    const lookups = this.hits + this.misses;
+    return {
+      size: this.entries.size,
+      maxEntries: this.maxEntries,
+      hits: this.hits,
+      misses: this.misses,
+      hitRate: lookups ? this.hits / lookups : 0,
+      persisted: !!this.persistPath
+    };
+  }
+
+  // Persistence is opt-in: entries contain dictated text
+  setPersistPath(persistPath) {
+    this.persistPath = persistPath || null;
+    if (this.persistPath) this.load();
+  }
+
+  load() {
+    if (!this.persistPath || !fs.existsSync(this.persistPath)) return;
+    try {
+      const saved = JSON.parse(fs.readFileSync(this.persistPath, 'utf8'));
+      for (const [key, value] of saved.entries || []) {
+        if (!this.entries.has(key)) this.entries.set(key, value);
+      }
+      while (this.entries.size > this.maxEntries) {
+        this.entries.delete(this.entries.keys().next().value);
+      }
+    } catch (e) {
+      console.warn('Failed to load transform cache:', e.message);
+    }
+  }
+
+  // Write-behind: coalesce bursts of inserts into one write
+  scheduleSave() {
+    if (!this.persistPath || this.saveTimer) return;
+    this.saveTimer = setTimeout(() => {
+      this.saveTimer = null;
+      this.save();
+    }, SAVE_DELAY_MS);
+    if (this.saveTimer.unref) this.saveTimer.unref();
+  }
+
+  save() {
+    if (!this.persistPath) return;
+    if (this.saveTimer) {
+      clearTimeout(this.saveTimer);
+      this.saveTimer = null;
+    }
+    try {
+      fs.mkdirSync(path.dirname(this.persistPath), { recursive: true });
+      const tmpPath = `${this.persistPath}.tmp`;
+      fs.writeFileSync(tmpPath, JSON.stringify({ version: 1, entries: [...this.entries] }));
+      fs.renameSync(tmpPath, this.persistPath);
+    } catch (e) {
+      console.warn('Failed to save transform cache:', e.message);
+    }
+  }
+}
+
+module.exports = { TransformCache, normalizeTranscript };
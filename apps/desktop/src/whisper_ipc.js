@@ -0,0 +1,80 @@
+/**
+ * Whisper service IPC for SONU
+ * Length-prefixed JSON frames between main.js and whisper_service.py, plus a parser
+ * for the legacy line protocol (PARTIAL: / EVENT: / bare final text)
+ */
+
+const HEADER_BYTES = 4;
+const MAX_FRAME_BYTES = 16 * 1024 * 1024;
+
+// Frame = 4-byte big-endian body length + UTF-8 JSON body
+function encodeFrame(message) {
+  const body = Buffer.from(JSON.stringify(message), 'utf8');
+  const header = Buffer.alloc(HEADER_BYTES);
+  header.writeUInt32BE(body.length, 0);
+  return Buffer.concat([header, body]);
+}
+
+// A frame whose body is not valid JSON is skipped (its length still says where the next
+// one starts). A length past MAX_FRAME_BYTES means the stream itself is corrupt - stray
+// bytes on stdout - and there is no way to find the next frame boundary, so the decoder
+// sets error and ignores further input; the caller restarts the process
+class FrameDecoder {
+  constructor() {
+    this.reset();
+  }
+
+  // Append a stdout chunk and return every complete message it finished
+  push(chunk) {
+    if (this.error) return [];
+    this.buffer = this.buffer.length ? Buffer.concat([this.buffer, chunk]) : chunk;
+    const messages = [];
+    let offset = 0;
+    while (this.buffer.length - offset >= HEADER_BYTES) {
+      const size = this.buffer.readUInt32BE(offset);
+      if (size > MAX_FRAME_BYTES) {
+        this.error = new Error(`Frame of ${size} bytes exceeds limit`);
+        this.buffer = Buffer.alloc(0);
+        return messages;
+      }
+      if (this.buffer.length - offset - HEADER_BYTES < size) break;
+      const start = offset + HEADER_BYTES;
+      try {
+        messages.push(JSON.parse(this.buffer.toString('utf8', start, start + size)));
+      } catch (e) {
+        this.skipped++;
+        this.lastSkipError = e;
+      }
+      offset = start + size;
+    }
+    this.buffer = this.buffer.subarray(offset);
+    return messages;
+  }
+
+  reset() {
+    this.buffer = Buffer.alloc(0);
+    this.error = null;
+    this.skipped = 0;
+    this.lastSkipError = null;
+  }
+}
+
+// Legacy text protocol: turn one stdout line into the same message shape as a frame
+function parseTextLine(line) {
+  const raw = line.trim();
+  if (!raw) return null;
+  if (raw.startsWith('PARTIAL:')) {
+    return { type: 'partial', text: raw.slice(8).trim() };
+  }
+  if (raw.startsWith('EVENT:')) {
+    const [name, ...args] = raw.slice(6).trim().split(/\s+/);
+    return {
+      type: 'event',
+      name: (name || '').toUpperCase(),
+      args: args.map((arg) => (arg !== '' && Number.isFinite(Number(arg)) ? Number(arg) : arg))
+    };
+  }
+  return { type: 'final', text: raw };
+}
+
+module.exports = { encodeFrame, FrameDecoder, parseTextLine };
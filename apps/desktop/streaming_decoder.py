@@ -0,0 +1,109 @@
+"""
+Streaming decoding for SONU
+Incremental transcription that keeps a committed prefix (local agreement between
+consecutive hypotheses) and only re-decodes the audio after it
+"""
+
+import re
+import threading
+
+
+def normalize_word(word):
+    return re.sub(r"[^\w']", "", word.lower())
+
+
+class LocalAgreementDecoder:
+    """Commit the words two consecutive hypotheses agree on; decode only what follows.
+
+    ``transcribe(samples, prompt)`` must return ``[(word, start_s, end_s), ...]``
+    with times relative to ``samples``. Positions are absolute sample indices in
+    the capture ring: each pass calls ``fetch(commit_point)``, which returns the
+    uncommitted tail and the index it starts at, so committed audio is never
+    decoded again. ``finish`` uses ``final_transcribe`` when given, so the last
+    pass can run with more expensive settings than the partial passes.
+
+    ``update`` and ``finish`` hold an internal lock for the whole decode, so a
+    final never races the partial pass that is updating the committed prefix.
+    """
+
+    def __init__(self, transcribe, rate, prompt_chars=200, max_tail_seconds=20.0, final_transcribe=None):
+        self._transcribe = transcribe
+        self._final_transcribe = final_transcribe or transcribe
+        self.rate = rate
+        self.prompt_chars = prompt_chars
+        # Without agreement for this long, commit all but the newest word so the tail stays bounded
+        self.max_tail = int(max_tail_seconds * rate)
+        self._lock = threading.Lock()
+        self.reset(0)
+
+    def reset(self, start):
+        with self._lock:
+            self.committed = []
+            self.committed_words = []  # (word, begin, end) in absolute sample indices
+            self.commit_point = start
+            self.hypothesis = []
+
+    def committed_text(self):
+        return "".join(self.committed).strip()
+
+    def timed_words(self):
+        """Committed then tentative words as ``(word, begin, end)`` sample indices."""
+        with self._lock:
+            return list(self.committed_words) + list(self.hypothesis)
+
+    def update(self, fetch):
+        """Decode the uncommitted tail and extend the committed prefix.
+
+        Returns ``(committed_text, tentative_text)``.
+        """
+        with self._lock:
+            samples, offset = fetch(self.commit_point)
+            words = self._decode(samples, offset, self._transcribe)
+            agreed = 0
+            limit = min(len(words), len(self.hypothesis))
+            while agreed < limit and normalize_word(words[agreed][0]) == normalize_word(self.hypothesis[agreed][0]):
+                agreed += 1
+            self._commit(words[:agreed])
+            pending = words[agreed:]
+
+            end = offset + samples.size
+            if end - self.commit_point > self.max_tail:
+                if len(pending) > 1:
+                    self._commit(pending[:-1])
+                    pending = pending[-1:]
+                elif not pending:
+                    # Nothing recognised (silence/noise): drop all but the last second
+                    self.commit_point = max(self.commit_point, end - self.rate)
+
+            self.hypothesis = pending
+            return self.committed_text(), "".join(w[0] for w in pending).strip()
+
+    def finish(self, fetch):
+        """Decode the remaining uncommitted tail once and return the full transcript."""
+        with self._lock:
+            samples, offset = fetch(self.commit_point)
+            words = self._decode(samples, offset, self._final_transcribe)
+            self._commit(words)
+            self.hypothesis = []
+            return self.committed_text()
+
+    def _commit(self, words):
+        if not words:
+            return
+        self.committed.extend(w[0] for w in words)
+        self.committed_words.extend(words)
+        self.commit_point = max(self.commit_point, words[-1][2])
+
+    def _decode(self, samples, offset, transcribe):
+        if samples is None or samples.size == 0:
+            return []
+        # The committed text is the decoder's context for the trimmed audio
+        prompt = self.committed_text()[-self.prompt_chars:] or None
+        words = []
+        for text, start, end in transcribe(samples, prompt):
+            begin = offset + int(start * self.rate)
+            finish = offset + int(end * self.rate)
+            if finish <= self.commit_point:
+                continue  # overlaps audio that is already committed
+            words.append((text, begin, finish))
+        return words
@@ -6,6 +6,7 @@ import platform
 import json
 import sys
 import os
+import time
 
 try:
     import psutil
@@ -167,6 +168,248 @@ def suggest_model():
         return "base"  # Default fallback
 
 
+# Approximate resident memory of a loaded faster-whisper model on CPU (MB)
+MODEL_MEMORY_MB = {
+    "tiny": 150,
+    "base": 300,
+    "small": 700,
+    "medium": 1800,
+    "large": 3500
+}
+CASCADE_DRAFT_MODEL = "tiny"
+# Memory that must stay free for the OS, Electron and the LLM service
+CASCADE_HEADROOM_MB = 1536
+CASCADE_MIN_RAM_GB = 8
+
+
+def model_memory_mb(model):
+    """Resident size for a model name; variants map to their family, unknown names to the largest"""
+    name = str(model or "").lower()
+    if name.startswith("distil-"):
+        name = name[len("distil-"):]
+    if name.endswith(".en"):
+        name = name[:-len(".en")]
+    if name.startswith("large"):
+        name = "large"
+    return MODEL_MEMORY_MB.get(name, max(MODEL_MEMORY_MB.values()))
+
+
+def plan_cascade(final_model, profile=None):
+    """Decide whether a resident draft model for partials fits next to the final model"""
+    draft = CASCADE_DRAFT_MODEL
+    final_mb = model_memory_mb(final_model)
+    draft_mb = MODEL_MEMORY_MB[draft]
+    plan = {
+        "enabled": False,
+        "draft": draft,
+        "final": final_model,
+        "draft_mb": draft_mb,
+        "final_mb": final_mb,
+        "available_mb": None,
+        "reason": ""
+    }
+
+    if final_model == draft:
+        plan["reason"] = "Final model is already the draft model"
+        return plan
+
+    profile = profile or get_system_profile()
+    if profile.get("ram_gb", 0) < CASCADE_MIN_RAM_GB:
+        plan["reason"] = f"Needs at least {CASCADE_MIN_RAM_GB} GB RAM"
+        return plan
+
+    if psutil:
+        try:
+            # The final model is already resident, so only the draft must fit
+            available_mb = round(psutil.virtual_memory().available / (1024**2))
+            plan["available_mb"] = available_mb
+            if available_mb - draft_mb < CASCADE_HEADROOM_MB:
+                plan["reason"] = f"Only {available_mb} MB free"
+                return plan
+        except:
+            pass
+
+    plan["enabled"] = True
+    plan["reason"] = f"Draft '{draft}' ({draft_mb} MB) drives partials, '{final_model}' ({final_mb} MB) produces finals"
+    return plan
+
+
+# Host tuning: benchmark faster-whisper configs and keep the fastest per model. Only the
+# model config is tuned; beam widths stay with the decode profiles (finals are never narrowed)
+SETTINGS_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)), "data", "settings.json")
+TUNE_COMPUTE_TYPES = ["int8", "float32"]
+# Configs within this factor of the fastest are ranked by peak memory instead
+TUNE_RTF_TOLERANCE = 1.05
+# Short read-speech recording (16 kHz mono 16-bit) decoded by every benchmark run; when
+# it is not installed the built-in synthetic clip below stands in
+TUNE_CLIP_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)), "assets", "tuning", "speech.wav")
+TUNE_CLIP_SECONDS = 6
+
+
+def synthetic_speech_clip(seconds=TUNE_CLIP_SECONDS, rate=16000):
+    """Deterministic voiced-syllable clip (pitch + formants), the fallback when no recording ships"""
+    import numpy as np
+    t = np.arange(int(seconds * rate), dtype=np.float32) / rate
+    pitch = 120 + 20 * np.sin(2 * np.pi * 0.5 * t)
+    phase = 2 * np.pi * np.cumsum(pitch) / rate
+    voice = sum(np.sin(k * phase) / k for k in range(1, 12))
+    # Formant colouring that changes every syllable
+    formants = np.array([700, 300, 500, 400, 600], dtype=np.float32)
+    syllable = (t * 4).astype(int)
+    voice = voice * (1 + 0.5 * np.sin(2 * np.pi * formants[syllable % len(formants)] * t))
+    envelope = np.clip(np.sin(np.pi * (t * 4 % 1)), 0, 1) ** 0.5
+    clip = voice * envelope
+    return (0.3 * clip / np.max(np.abs(clip))).astype(np.float32)
+
+
+def tuning_clip_path(path=None):
+    """Recording to benchmark with, or None for the built-in clip"""
+    if path:
+        return path
+    return TUNE_CLIP_PATH if os.path.exists(TUNE_CLIP_PATH) else None
+
+
+def load_clip(path=None):
+    path = tuning_clip_path(path)
+    if not path:
+        return synthetic_speech_clip()
+    import wave
+    import numpy as np
+    with wave.open(path, "rb") as wf:
+        if wf.getsampwidth() != 2 or wf.getframerate() != 16000 or wf.getnchannels() != 1:
+            raise ValueError("Tuning clip must be 16 kHz mono 16-bit WAV")
+        data = wf.readframes(wf.getnframes())
+    return np.frombuffer(data, dtype=np.int16).astype(np.float32) / 32768.0
+
+
+def peak_rss_mb():
+    """Peak resident memory of this process in MB"""
+    try:
+        import resource
+        peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+        # kB on Linux, bytes on macOS
+        return round(peak / (1024**2 if sys.platform == "darwin" else 1024))
+    except ImportError:
+        if psutil:
+            info = psutil.Process().memory_info()
+            return round(getattr(info, "peak_wset", info.rss) / (1024**2))
+        return None
+
+
+def tune_candidates():
+    logical = os.cpu_count() or 1
+    physical = logical
+    if psutil:
+        try:
+            physical = psutil.cpu_count(logical=False) or logical
+        except:
+            pass
+    threads = sorted({max(1, physical // 2), physical, logical})
+    return [{"compute_type": c, "cpu_threads": n} for c in TUNE_COMPUTE_TYPES for n in threads]
+
+
+def benchmark_config(model, compute_type, cpu_threads, clip_path=None):
+    """Load one config and time the clip with the service's decode profiles (runs in its own process)"""
+    from faster_whisper import WhisperModel
+    from decode_profiles import DEFAULT_PROFILES, decode_options
+    clip_path = tuning_clip_path(clip_path)
+    clip = load_clip(clip_path)
+    audio_seconds = clip.size / 16000
+    started = time.time()
+    whisper = WhisperModel(model, device="cpu", compute_type=compute_type, cpu_threads=cpu_threads)
+    load_seconds = time.time() - started
+    # First decode pays lazy initialisation
+    list(whisper.transcribe(clip[:16000], beam_size=1, vad_filter=False)[0])
+    rtf = {}
+    for role, profile in DEFAULT_PROFILES.items():
+        started = time.time()
+        options = decode_options(profile)
+        if not clip_path:
+            # VAD would rightly find no speech in the synthetic clip and skip the decode
+            options["vad_filter"] = False
+            options.pop("vad_parameters", None)
+        segments, _ = whisper.transcribe(clip, condition_on_previous_text=False, **options)
+        list(segments)
+        rtf[role] = round((time.time() - started) / audio_seconds, 4)
+    return {
+        "compute_type": compute_type,
+        "cpu_threads": cpu_threads,
+        "load_seconds": round(load_seconds, 2),
+        "rtf": rtf,
+        "peak_rss_mb": peak_rss_mb(),
+        "clip": "speech" if clip_path else "builtin"
+    }
+
+
+def choose_tuning(results):
+    """Config with the fastest final decode (lowest memory among near-ties)"""
+    results = [r for r in results if "rtf" in r]
+    if not results:
+        return None
+    fastest = min(r["rtf"]["final"] for r in results)
+    close = [r for r in results if r["rtf"]["final"] <= fastest * TUNE_RTF_TOLERANCE]
+    best = min(close, key=lambda r: (r.get("peak_rss_mb") or 0, r["rtf"]["final"]))
+    return {
+        "compute_type": best["compute_type"],
+        "cpu_threads": best["cpu_threads"],
+        "rtf": best["rtf"]["final"],
+        "peak_rss_mb": best.get("peak_rss_mb"),
+        "clip": best.get("clip"),
+        "tuned_at": int(time.time())
+    }
+
+
+def read_settings(path=SETTINGS_PATH):
+    try:
+        with open(path, "r", encoding="utf-8") as f:
+            return json.load(f)
+    except Exception:
+        return {}
+
+
+def load_tuning(model, path=SETTINGS_PATH):
+    """Tuned WhisperModel/decode config for a model, or None if it was never tuned"""
+    return read_settings(path).get("whisper_tuning", {}).get(model)
+
+
+def save_tuning(model, tuning, path=SETTINGS_PATH):
+    settings = read_settings(path)
+    settings.setdefault("whisper_tuning", {})[model] = tuning
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    tmp_path = path + ".tmp"
+    with open(tmp_path, "w", encoding="utf-8") as f:
+        json.dump(settings, f, indent=2)
+    os.replace(tmp_path, path)
+
+
+def tune(model, clip_path=None, path=SETTINGS_PATH):
+    """Benchmark every candidate config in a fresh process and store the best one"""
+    import subprocess
+    if clip_path and not os.path.exists(clip_path):
+        return {"model": model, "best": None, "results": [], "error": f"No tuning clip at {clip_path}"}
+    results = []
+    for candidate in tune_candidates():
+        args = [sys.executable, os.path.abspath(__file__), "tune-run", model,
+                candidate["compute_type"], str(candidate["cpu_threads"])]
+        if clip_path:
+            args.append(clip_path)
+        try:
+            # A fresh process per config keeps peak RSS and thread pools separate
+            proc = subprocess.run(args, capture_output=True, text=True, timeout=600)
+            result = json.loads(proc.stdout.strip().splitlines()[-1])
+        except Exception as e:
+            result = {**candidate, "error": str(e)}
+        results.append(result)
+        sys.stderr.write(f"tune {model}: {json.dumps(result)}\n")
+        sys.stderr.flush()
+    best = choose_tuning(results)
+    if not best:
+        errors = sorted({r["error"] for r in results if "error" in r})
+        return {"model": model, "best": None, "results": results, "error": "; ".join(errors) or "no results"}
+    save_tuning(model, best, path)
+    return {"model": model, "best": best, "results": results}
+
+
 def list_microphones():
     """List available microphone devices"""
     try:
@@ -201,6 +444,22 @@ if __name__ == "__main__":
     elif len(sys.argv) > 1 and sys.argv[1] == "profile":
         profile = get_system_profile()
         print(json.dumps(profile, indent=2))
+    elif len(sys.argv) > 1 and sys.argv[1] == "tune":
+        # tune [model] [clip.wav]
+        model = sys.argv[2] if len(sys.argv) > 2 else suggest_model()
+        clip_path = sys.argv[3] if len(sys.argv) > 3 else None
+        print(json.dumps(tune(model, clip_path), indent=2))
+    elif len(sys.argv) > 1 and sys.argv[1] == "tune-run":
+        # Internal: one benchmark per process, see tune()
+        clip_path = sys.argv[5] if len(sys.argv) > 5 else None
+        try:
+            result = benchmark_config(sys.argv[2], sys.argv[3], int(sys.argv[4]), clip_path)
+        except Exception as e:
+            result = {"compute_type": sys.argv[3], "cpu_threads": int(sys.argv[4]), "error": str(e)}
+        print(json.dumps(result))
+    elif len(sys.argv) > 1 and sys.argv[1] == "cascade-plan":
+        final_model = sys.argv[2] if len(sys.argv) > 2 else suggest_model()
+        print(json.dumps(plan_cascade(final_model), indent=2))
     elif len(sys.argv) > 1 and sys.argv[1] == "list-microphones":
         devices = list_microphones()
         print(json.dumps(devices, indent=2))
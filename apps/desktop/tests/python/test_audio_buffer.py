@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+Unit tests for audio_buffer.py
+"""
+
+import pytest
+import sys
+import os
+
+import numpy as np
+
+# Add parent directory to path for imports
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+from audio_buffer import PcmRingBuffer
+
+RATE = 1000
+
+
+def pcm(start, count):
+    """int16 ramp so every sample is identifiable after conversion"""
+    return (np.arange(start, start + count) % 30000).astype(np.int16).tobytes()
+
+
+def expected(start, count):
+    return (np.arange(start, start + count) % 30000).astype(np.float32) / 32768.0
+
+
+class TestPcmRingBuffer:
+    """Test the SPSC capture ring"""
+
+    def test_tail_is_a_contiguous_view_across_wraparound(self):
+        ring = PcmRingBuffer(seconds=2, rate=RATE, headroom_seconds=0.1)
+        ring.mark_start()
+        for i in range(0, 3500, 250):
+            ring.write_int16(pcm(i, 250))
+
+        tail = ring.tail(1.5)
+        assert tail.size == 1500
+        assert np.shares_memory(tail, ring._data)
+        np.testing.assert_allclose(tail, expected(2000, 1500))
+
+    def test_tail_is_limited_to_current_recording(self):
+        ring = PcmRingBuffer(seconds=2, rate=RATE)
+        ring.write_int16(pcm(0, 500))
+        ring.mark_start()
+        ring.write_int16(pcm(500, 200))
+
+        np.testing.assert_allclose(ring.tail(1), expected(500, 200))
+        assert ring.recording_length() == 200
+
+    def test_short_recording_is_returned_without_copy(self):
+        ring = PcmRingBuffer(seconds=2, rate=RATE)
+        ring.mark_start()
+        ring.write_int16(pcm(0, 900))
+
+        rec = ring.recording()
+        assert np.shares_memory(rec, ring._data)
+        np.testing.assert_allclose(rec, expected(0, 900))
+
+    def test_long_recording_spills_to_arena(self):
+        ring = PcmRingBuffer(seconds=1, rate=RATE)
+        ring.mark_start()
+        for i in range(0, 5000, 300):
+            ring.write_int16(pcm(i, 300))
+
+        rec = ring.recording()
+        assert rec.size == 5100
+        np.testing.assert_allclose(rec, expected(0, 5100))
+
+        # Arena keeps its allocation for the next recording
+        arena = ring._arena
+        ring.mark_start()
+        for i in range(0, 3000, 300):
+            ring.write_int16(pcm(i, 300))
+        assert ring._arena is arena
+        np.testing.assert_allclose(ring.recording(), expected(0, 3000))
+
+    def test_start_reaches_back_into_preroll_and_stop_freezes_the_end(self):
+        ring = PcmRingBuffer(seconds=2, rate=RATE)
+        ring.write_int16(pcm(0, 500))
+        ring.mark_start(backfill=300)
+        ring.write_int16(pcm(500, 200))
+        ring.mark_stop()
+        # Pre-roll keeps filling after the recording ended
+        ring.write_int16(pcm(700, 400))
+
+        assert ring.recording_length() == 500
+        np.testing.assert_allclose(ring.recording(), expected(200, 500))
+        np.testing.assert_allclose(ring.tail(0.1), expected(600, 100))
+
+    def test_idle_preroll_writes_do_not_grow_the_arena(self):
+        ring = PcmRingBuffer(seconds=1, rate=RATE)
+        ring.mark_start()
+        for i in range(0, 1500, 300):
+            ring.write_int16(pcm(i, 300))
+        ring.mark_stop()
+        for i in range(1500, 9000, 300):
+            ring.write_int16(pcm(i, 300))
+
+        assert ring._arena_len == 1500
+        np.testing.assert_allclose(ring.recording(), expected(0, 1500))
+
+    def test_without_spill_only_the_ring_is_kept(self):
+        ring = PcmRingBuffer(seconds=1, rate=RATE, spill=False)
+        ring.mark_start()
+        for i in range(0, 3000, 300):
+            ring.write_int16(pcm(i, 300))
+
+        rec = ring.recording()
+        assert rec.size == 1000
+        np.testing.assert_allclose(rec, expected(2000, 1000))
+        assert ring._arena.size == 0
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+"""
+Unit tests for cpu_budget.py
+"""
+
+import pytest
+import sys
+import os
+from unittest.mock import patch
+
+# Add parent directory to path for imports
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+from cpu_budget import apply_affinity, capped_threads, parse_cpu_list, thread_budget
+
+
+class TestCpuBudget:
+    def test_parse_cpu_list(self):
+        assert parse_cpu_list("1-3,6") == {1, 2, 3, 6}
+        assert parse_cpu_list("") == set()
+        assert parse_cpu_list("a-b") == set()
+
+    def test_thread_budget_from_environment(self):
+        with patch.dict(os.environ, {"SONU_WHISPER_THREADS": "6"}):
+            assert thread_budget("SONU_WHISPER_THREADS") == 6
+        with patch.dict(os.environ, {"SONU_WHISPER_THREADS": "lots"}):
+            assert thread_budget("SONU_WHISPER_THREADS") == 0
+
+    def test_tuned_threads_are_capped_by_budget(self):
+        assert capped_threads(8, 3) == 3
+        assert capped_threads(2, 3) == 2
+        assert capped_threads(8, 0) == 8
+        assert capped_threads(0, 3) == 3
+
+    @pytest.mark.skipif(not hasattr(os, "sched_setaffinity"), reason="Linux only")
+    def test_affinity_limited_to_available_cpus(self):
+        current = os.sched_getaffinity(0)
+        target = min(current)
+        try:
+            with patch.dict(os.environ, {"SONU_CPU_AFFINITY": f"{target},4096"}):
+                assert apply_affinity() == {target}
+            assert os.sched_getaffinity(0) == {target}
+        finally:
+            os.sched_setaffinity(0, current)
+
+
+if __name__ == '__main__':
+    pytest.main([__file__])
@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+"""
+Unit tests for decode_profiles.py
+"""
+
+import pytest
+import sys
+import os
+
+# Add parent directory to path for imports
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+from decode_profiles import DECODE_PROFILES, LatencyGovernor, beam_cost, decode_options
+
+
+class TestDecodeOptions:
+    def test_profile_copy(self):
+        options = decode_options("accurate")
+        options["beam_size"] = 1
+        assert DECODE_PROFILES["accurate"]["beam_size"] == 5
+
+    def test_narrower_beam(self):
+        options = decode_options("accurate", beam=2)
+        assert options["beam_size"] == 2
+        assert options["best_of"] == 2
+
+    def test_beam_never_widened(self):
+        assert decode_options("fast", beam=5)["beam_size"] == 1
+
+
+class TestLatencyGovernor:
+    def test_defaults_before_measurements(self):
+        governor = LatencyGovernor()
+        assert governor.beam(3) == 3
+        assert governor.cadence() == governor.base_cadence
+
+    def test_fast_machine_keeps_profile(self):
+        governor = LatencyGovernor()
+        # 5 s of audio in 0.1 s at beam 3
+        governor.observe(5.0, 0.1, 3)
+        assert governor.beam(3) == 3
+        assert governor.cadence() == governor.base_cadence
+
+    def test_slow_machine_narrows_beam(self):
+        governor = LatencyGovernor()
+        # Greedy-equivalent RTF 0.1: beam 3 would need 0.8 s of a 0.72 s budget
+        governor.observe(5.0, 0.5 * beam_cost(3), 3)
+        assert governor.beam(3) == 2
+
+    def test_very_slow_machine_stretches_cadence(self):
+        governor = LatencyGovernor()
+        governor.observe(5.0, 2.0, 1)
+        assert governor.beam(3) == 1
+        assert governor.cadence() > governor.base_cadence
+        assert governor.cadence() <= governor.max_cadence
+
+    def test_disabled(self):
+        governor = LatencyGovernor()
+        governor.observe(5.0, 2.0, 1)
+        governor.enabled = False
+        assert governor.beam(3) == 3
+        assert governor.cadence() == governor.base_cadence
+
+    def test_moving_average(self):
+        governor = LatencyGovernor(smoothing=0.5)
+        governor.observe(1.0, 0.2, 1)
+        governor.observe(1.0, 0.4, 1)
+        assert governor.rtf == pytest.approx(0.3)
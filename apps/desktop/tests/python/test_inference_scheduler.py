@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""
+Unit tests for inference_scheduler.py
+"""
+
+import pytest
+import sys
+import os
+import threading
+
+# Add parent directory to path for imports
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+from inference_scheduler import (
+    InferenceScheduler, DecodeCancelled,
+    PRIORITY_FINAL, PRIORITY_PARTIAL, PRIORITY_BACKGROUND
+)
+
+
+def blocker(scheduler):
+    """Occupy the worker until the returned event is set"""
+    started = threading.Event()
+    release = threading.Event()
+
+    def job(_):
+        started.set()
+        release.wait(5)
+        return "blocker"
+
+    scheduler.submit(PRIORITY_BACKGROUND, job)
+    assert started.wait(5)
+    return release
+
+
+class TestInferenceScheduler:
+    def test_run_returns_result(self):
+        scheduler = InferenceScheduler()
+        assert scheduler.run(PRIORITY_FINAL, lambda job: 42) == 42
+
+    def test_priority_order(self):
+        scheduler = InferenceScheduler()
+        release = blocker(scheduler)
+        order = []
+        jobs = [
+            scheduler.submit(PRIORITY_BACKGROUND, lambda job: order.append("background")),
+            scheduler.submit(PRIORITY_PARTIAL, lambda job: order.append("partial")),
+        ]
+        release.set()
+        for job in jobs:
+            job.future.result(5)
+        assert order == ["partial", "background"]
+
+    def test_same_key_coalesces(self):
+        scheduler = InferenceScheduler()
+        release = blocker(scheduler)
+        ran = []
+        first = scheduler.submit(PRIORITY_PARTIAL, lambda job: ran.append(1), key="partial")
+        second = scheduler.submit(PRIORITY_PARTIAL, lambda job: ran.append(2), key="partial")
+        release.set()
+        second.future.result(5)
+        assert first.cancelled
+        assert ran == [2]
+        assert scheduler.stats["coalesced"] == 1
+
+    def test_final_cancels_queued_partials(self):
+        scheduler = InferenceScheduler()
+        release = blocker(scheduler)
+        partial = scheduler.submit(PRIORITY_PARTIAL, lambda job: "partial", key="partial")
+        final = scheduler.submit(PRIORITY_FINAL, lambda job: "final")
+        release.set()
+        assert final.future.result(5) == "final"
+        assert partial.cancelled
+        assert scheduler.stats["cancelled"] == 1
+
+    def test_final_preempts_running_partial(self):
+        scheduler = InferenceScheduler()
+        started = threading.Event()
+        preempted = threading.Event()
+
+        def slow_partial(job):
+            started.set()
+            for _ in range(500):
+                try:
+                    scheduler.check_preempted()
+                except DecodeCancelled:
+                    preempted.set()
+                    raise
+                threading.Event().wait(0.01)
+            return "partial"
+
+        partial = scheduler.submit(PRIORITY_PARTIAL, slow_partial, key="partial")
+        assert started.wait(5)
+        assert scheduler.run(PRIORITY_FINAL, lambda job: "final") == "final"
+        assert preempted.is_set()
+        with pytest.raises(Exception):
+            partial.future.result(5)
+        assert scheduler.stats["preempted"] == 1
+
+    def test_check_preempted_is_noop_off_worker(self):
+        scheduler = InferenceScheduler()
+        scheduler.check_preempted()
+
+    def test_job_exception_propagates(self):
+        scheduler = InferenceScheduler()
+
+        def boom(job):
+            raise ValueError("boom")
+
+        with pytest.raises(ValueError):
+            scheduler.run(PRIORITY_FINAL, boom)
+        # Worker survives a failing job
+        assert scheduler.run(PRIORITY_FINAL, lambda job: "ok") == "ok"
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""
+Unit tests for ipc_protocol.py
+"""
+
+import pytest
+import sys
+import os
+import io
+import subprocess
+
+# Add parent directory to path for imports
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+from ipc_protocol import Channel, encode_frame, read_frame, read_commands
+
+
+class FakeStdout(io.StringIO):
+    def __init__(self):
+        super().__init__()
+        self.buffer = io.BytesIO()
+
+
+class FakeStdin:
+    def __init__(self, data):
+        self.buffer = io.BytesIO(data)
+
+
+def frames(data):
+    stream = io.BytesIO(data)
+    out = []
+    while True:
+        message = read_frame(stream)
+        if message is None:
+            return out
+        out.append(message)
+
+
+class TestFraming:
+    def test_round_trip(self):
+        message = {"type": "final", "text": "héllo", "request_id": 3}
+        assert frames(encode_frame(message)) == [message]
+
+    def test_truncated_frame_is_eof(self):
+        assert frames(encode_frame({"type": "partial"})[:-1]) == []
+
+    def test_read_framed_commands(self):
+        stdin = FakeStdin(encode_frame({"id": 1, "cmd": "START 5"}) + encode_frame({"id": 2, "cmd": "STOP"}))
+        assert list(read_commands(True, stdin)) == [("START 5", 1), ("STOP", 2)]
+
+    def test_read_text_commands(self):
+        assert list(read_commands(False, io.StringIO("START\nSTOP\n"))) == [("START\n", None), ("STOP\n", None)]
+
+
+class TestChannel:
+    def test_framed_messages(self, monkeypatch):
+        out = FakeStdout()
+        monkeypatch.setattr(sys, 'stdout', out)
+        channel = Channel(framed=True, out=out.buffer)
+        channel.partial("hello", request_id=4)
+        channel.event("CAPTURE_LATENCY", 42.0, 3.1)
+        channel.final("hello world", segments=[{"text": "hello world", "start_ms": 0, "end_ms": 900}])
+        messages = frames(out.buffer.getvalue())
+        assert [m["type"] for m in messages] == ["partial", "event", "final"]
+        assert [m["seq"] for m in messages] == [1, 2, 3]
+        assert messages[0]["request_id"] == 4
+        assert messages[1]["args"] == [42.0, 3.1]
+        assert messages[2]["segments"][0]["end_ms"] == 900
+        assert out.getvalue() == ""
+
+    def test_framed_channel_keeps_other_stdout_writes_out_of_the_stream(self):
+        script = (
+            "import os, sys\n"
+            "from ipc_protocol import Channel\n"
+            "channel = Channel(framed=True)\n"
+            "print('stray print')\n"
+            "sys.stdout.flush()\n"
+            "os.write(1, b'native library output\\n')\n"
+            "channel.event('READY')\n"
+        )
+        proc = subprocess.run([sys.executable, "-c", script], capture_output=True, timeout=30,
+                              cwd=os.path.join(os.path.dirname(__file__), '..', '..'))
+        assert [m["name"] for m in frames(proc.stdout)] == ["READY"]
+        assert b"stray print" in proc.stderr
+        assert b"native library output" in proc.stderr
+
+    def test_text_mode_writes_legacy_lines(self, monkeypatch):
+        out = FakeStdout()
+        monkeypatch.setattr(sys, 'stdout', out)
+        channel = Channel(framed=False)
+        channel.partial("hello", request_id=4)
+        channel.event("CAPTURE_LATENCY", 42.0, 3.1)
+        channel.event("CASCADE", "ON", "tiny", 850)
+        channel.final("hello world")
+        assert out.getvalue().splitlines() == [
+            "PARTIAL: hello",
+            "EVENT: CAPTURE_LATENCY 42.0 3.1",
+            "EVENT: CASCADE ON tiny 850",
+            "hello world",
+        ]
+        assert out.buffer.getvalue() == b""
@@ -0,0 +1,237 @@
+#!/usr/bin/env python3
+"""
+Unit tests for llm_service.py request queue
+"""
+
+import pytest
+import sys
+import os
+import threading
+from unittest.mock import patch
+
+# Add parent directory to path for imports
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+import llm_service
+from llm_service import PrefixStateCache, StreamCleaner, TransformQueue, build_prompt, clean_output, prompt_prefix
+
+
+class Recorder:
+    def __init__(self):
+        self.responses = {}
+        self.done = threading.Event()
+        self.expected = 0
+
+    def __call__(self, request_id, **fields):
+        self.responses[request_id] = fields
+        if len(self.responses) >= self.expected:
+            self.done.set()
+
+
+def request(request_id, text="hello", style="formal", category="personal"):
+    return {"id": request_id, "op": "transform", "text": text, "style": style, "category": category}
+
+
+class TestTransformQueue:
+    def test_transform_result(self):
+        respond = Recorder()
+        respond.expected = 1
+        queue = TransformQueue(respond)
+        with patch.object(llm_service, 'run_transform', return_value=("Hello.", None)):
+            queue.start()
+            queue.submit(request(1))
+            assert respond.done.wait(5)
+        assert respond.responses[1]["ok"]
+        assert respond.responses[1]["text"] == "Hello."
+
+    def test_identical_queued_requests_share_one_evaluation(self):
+        respond = Recorder()
+        respond.expected = 3
+        queue = TransformQueue(respond)
+        release = threading.Event()
+        calls = []
+
+        def fake_transform(text, style, category, should_stop=None, on_text=None):
+            calls.append(text)
+            release.wait(5)
+            return text.upper(), None
+
+        with patch.object(llm_service, 'run_transform', side_effect=fake_transform):
+            queue.start()
+            queue.submit(request(1, "first"))
+            # Queued behind the running request, identical to each other
+            queue.submit(request(2, "second"))
+            queue.submit(request(3, "second"))
+            release.set()
+            assert respond.done.wait(5)
+        assert calls == ["first", "second"]
+        assert respond.responses[3]["text"] == "SECOND"
+        assert queue.stats["batched"] == 1
+
+    def test_rejects_beyond_in_flight_limit(self):
+        respond = Recorder()
+        queue = TransformQueue(respond, max_in_flight=1)
+        queue.submit(request(1))
+        queue.submit(request(2))
+        assert respond.responses[2] == {"ok": False, "error": "busy"}
+
+    def test_cancel_queued_request(self):
+        respond = Recorder()
+        queue = TransformQueue(respond)
+        queue.submit(request(1))
+        queue.cancel(1)
+        assert respond.responses[1] == {"ok": False, "error": "cancelled"}
+        # Unknown ids are ignored
+        queue.cancel(99)
+        assert 99 not in respond.responses
+
+    def test_cancel_running_request_stops_generation(self):
+        respond = Recorder()
+        respond.expected = 1
+        queue = TransformQueue(respond)
+        started = threading.Event()
+        stopped = threading.Event()
+
+        def fake_transform(text, style, category, should_stop=None, on_text=None):
+            started.set()
+            while not should_stop():
+                threading.Event().wait(0.01)
+            stopped.set()
+            return None, "cancelled"
+
+        with patch.object(llm_service, 'run_transform', side_effect=fake_transform):
+            queue.start()
+            queue.submit(request(1))
+            assert started.wait(5)
+            queue.cancel(1)
+            assert stopped.wait(5)
+        assert respond.responses[1] == {"ok": False, "error": "cancelled"}
+
+    def test_cancel_after_answer_is_ignored(self):
+        respond = Recorder()
+        respond.expected = 3
+        queue = TransformQueue(respond)
+        hold = threading.Event()
+        release = threading.Event()
+        calls = []
+
+        def fake_transform(text, style, category, should_stop=None, on_text=None):
+            calls.append(text)
+            if text == "first":
+                hold.wait(5)
+            if text == "third":
+                release.wait(5)
+            return text.upper(), None
+
+        with patch.object(llm_service, 'run_transform', side_effect=fake_transform):
+            queue.start()
+            queue.submit(request(1, "first"))
+            # One batch of two groups: "second" is answered while "third" still runs
+            queue.submit(request(2, "second"))
+            queue.submit(request(3, "third"))
+            hold.set()
+            while "third" not in calls:
+                threading.Event().wait(0.01)
+            queue.cancel(2)
+            release.set()
+            assert respond.done.wait(5)
+        assert respond.responses[2]["text"] == "SECOND"
+        assert queue.stats["cancelled"] == 0
+        assert not queue._cancelled
+
+    def test_stream_request_gets_tokens_before_result(self):
+        respond = Recorder()
+        respond.expected = 1
+        tokens = []
+        queue = TransformQueue(respond, stream=lambda request_id, text: tokens.append((request_id, text)))
+
+        def fake_transform(text, style, category, should_stop=None, on_text=None):
+            for piece in ("Hey,", " can you", " send it?"):
+                on_text(piece)
+            return "Hey, can you send it?", None
+
+        streamed = dict(request(1), stream=True)
+        with patch.object(llm_service, 'run_transform', side_effect=fake_transform):
+            queue.start()
+            queue.submit(streamed)
+            assert respond.done.wait(5)
+        assert tokens == [(1, "Hey,"), (1, " can you"), (1, " send it?")]
+        assert respond.responses[1]["text"] == "Hey, can you send it?"
+        assert respond.responses[1]["first_ms"] is not None
+
+
+class TestStreamCleaner:
+    def feed_all(self, pieces):
+        cleaner = StreamCleaner()
+        emitted = [cleaner.feed(p) for p in pieces]
+        return cleaner, emitted
+
+    def test_matches_clean_output(self):
+        pieces = ["  ", " Hey", ",", " can", " you ", " send", " it?", "  ", "\nNote: rewritten"]
+        cleaner, _ = self.feed_all(pieces)
+        assert cleaner.text == clean_output("".join(pieces))
+
+    def test_trailing_space_is_held_until_more_text(self):
+        cleaner, emitted = self.feed_all(["Hello ", "world", "  "])
+        assert emitted == ["Hello", " world", ""]
+        assert cleaner.text == "Hello world"
+
+    def test_stops_at_newline(self):
+        cleaner, emitted = self.feed_all(["Done.\n", "Explanation"])
+        assert emitted == ["Done.", ""]
+
+
+class FakeLlama:
+    """Records evaluated tokens; a "token" is one character of the prompt."""
+
+    def __init__(self):
+        self.tokens = []
+        self.evaluated = 0
+
+    def tokenize(self, data):
+        return list(data.decode("utf-8"))
+
+    def reset(self):
+        self.tokens = []
+
+    def eval(self, tokens):
+        self.evaluated += len(tokens)
+        self.tokens.extend(tokens)
+
+    def save_state(self):
+        return list(self.tokens)
+
+    def load_state(self, state):
+        self.tokens = list(state)
+
+
+class TestPrefixStateCache:
+    def test_prompt_starts_with_prefix(self):
+        assert build_prompt("hi there", "casual", "work") == prompt_prefix("casual", "work") + 'hi there"'
+
+    def test_prefix_evaluated_once_per_style_and_category(self):
+        llm = FakeLlama()
+        cache = PrefixStateCache()
+        cache.restore(llm, "formal", "work")
+        first = llm.evaluated
+        llm.eval(list("user text"))
+        cache.restore(llm, "formal", "work")
+        assert llm.evaluated == first + len("user text")
+        assert "".join(llm.tokens) == prompt_prefix("formal", "work")
+        assert cache.stats == {"hits": 1, "misses": 1, "failed": 0}
+
+    def test_least_recently_used_state_is_evicted(self):
+        llm = FakeLlama()
+        cache = PrefixStateCache(max_entries=2)
+        cache.restore(llm, "formal", "work")
+        cache.restore(llm, "casual", "work")
+        cache.restore(llm, "formal", "work")
+        cache.restore(llm, "excited", "email")
+        assert len(cache) == 2
+        cache.restore(llm, "casual", "work")
+        assert cache.stats["misses"] == 4
+
+    def test_backend_without_state_support_falls_back(self):
+        cache = PrefixStateCache()
+        assert cache.restore(object(), "formal", "work") is False
+        assert cache.stats["failed"] == 1
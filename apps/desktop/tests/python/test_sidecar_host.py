@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""
+Unit tests for sidecar_host.py dispatch, caching and module loading
+"""
+
+import pytest
+import sys
+import os
+import threading
+import types
+
+# Add parent directory to path for imports
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+from sidecar_host import SidecarHost
+
+
+class Recorder:
+    def __init__(self, expected=1):
+        self.responses = {}
+        self.done = threading.Event()
+        self.expected = expected
+
+    def __call__(self, request_id, **fields):
+        self.responses[request_id] = fields
+        if len(self.responses) >= self.expected:
+            self.done.set()
+
+
+def fake_modules():
+    imports = []
+    profile_calls = []
+
+    def importer(name):
+        imports.append(name)
+        if name == "system_utils":
+            def get_system_profile():
+                profile_calls.append(1)
+                return {"cpu_cores": 8}
+            return types.SimpleNamespace(get_system_profile=get_system_profile, list_microphones=lambda: [])
+        raise ImportError(name)
+
+    return importer, imports, profile_calls
+
+
+OPS = {
+    "system_profile": (lambda modules, args: modules("system_utils").get_system_profile(), True),
+    "list_microphones": (lambda modules, args: modules("system_utils").list_microphones(), False),
+    "translate": (lambda modules, args: modules("translation_service").translate_text(args["text"]), False),
+}
+
+
+class TestSidecarHost:
+    def test_hardware_profile_is_computed_once(self):
+        importer, _, profile_calls = fake_modules()
+        respond = Recorder(expected=2)
+        host = SidecarHost(respond, ops=OPS, importer=importer)
+        host.submit(1, "system_profile")
+        host.submit(2, "system_profile")
+        assert respond.done.wait(5)
+        host.shutdown()
+        assert respond.responses[1]["result"] == respond.responses[2]["result"] == {"cpu_cores": 8}
+        assert (respond.responses[1]["cached"], respond.responses[2]["cached"]) == (False, True)
+        assert len(profile_calls) == 1
+
+    def test_modules_are_imported_once(self):
+        importer, imports, _ = fake_modules()
+        host = SidecarHost(Recorder(), ops=OPS, importer=importer)
+        host.call("list_microphones")
+        host.call("list_microphones")
+        host.call("system_profile")
+        assert imports == ["system_utils"]
+
+    def test_results_carry_id_and_latency(self):
+        importer, _, _ = fake_modules()
+        respond = Recorder(expected=2)
+        host = SidecarHost(respond, ops=OPS, importer=importer)
+        host.submit(7, "list_microphones")
+        host.submit(8, "system_profile")
+        assert respond.done.wait(5)
+        host.shutdown()
+        assert respond.responses[7]["result"] == []
+        assert respond.responses[8]["result"] == {"cpu_cores": 8}
+        assert all(r["ms"] >= 0 for r in respond.responses.values())
+
+    def test_failed_call_reports_error(self):
+        importer, _, _ = fake_modules()
+        respond = Recorder()
+        host = SidecarHost(respond, ops=OPS, importer=importer)
+        host.submit(3, "translate", {"text": "hi"})
+        assert respond.done.wait(5)
+        host.shutdown()
+        assert not respond.responses[3]["ok"]
+        assert "ImportError" in respond.responses[3]["error"]
+        assert host.stats["failed"] == 1
+
+    def test_unknown_op(self):
+        respond = Recorder()
+        host = SidecarHost(respond, ops=OPS, importer=lambda name: None)
+        host.submit(4, "reboot")
+        assert respond.responses[4] == {"ok": False, "error": "unknown_op", "ms": 0.0, "cached": False}
+
+    def test_stats_lists_loaded_modules(self):
+        importer, _, _ = fake_modules()
+        respond = Recorder()
+        host = SidecarHost(respond, ops=OPS, importer=importer)
+        host.call("system_profile")
+        host.submit(5, "stats")
+        snapshot = respond.responses[5]["result"]
+        assert snapshot["modules"] == ["system_utils"]
+        assert snapshot["cached_ops"] == ["system_profile"]
+
+    def test_slow_import_does_not_block_other_modules(self):
+        release = threading.Event()
+        importing = threading.Event()
+
+        def importer(name):
+            if name == "translation_service":
+                importing.set()
+                release.wait(5)
+                return types.SimpleNamespace(translate_text=lambda text: text)
+            return types.SimpleNamespace(list_microphones=lambda: [])
+
+        respond = Recorder(expected=2)
+        host = SidecarHost(respond, ops=OPS, importer=importer)
+        host.submit(1, "translate", {"text": "hi"})
+        assert importing.wait(5)
+        # Stats and another module's call are answered while translation_service imports
+        host.submit(2, "stats")
+        assert respond.responses[2]["result"]["modules"] == []
+        host.submit(3, "list_microphones")
+        assert respond.done.wait(5)
+        respond.done.clear()
+        respond.expected = 3
+        assert respond.responses[3]["result"] == []
+        assert 1 not in respond.responses
+        release.set()
+        assert respond.done.wait(5)
+        host.shutdown()
+        assert respond.responses[1]["result"] == "hi"
+
+if __name__ == '__main__':
+    pytest.main([__file__])
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""
+Unit tests for streaming_decoder.py
+"""
+
+import pytest
+import sys
+import os
+
+import numpy as np
+
+# Add parent directory to path for imports
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+from streaming_decoder import LocalAgreementDecoder
+
+RATE = 100
+# One word per second of "audio"
+SCRIPT = [" the", " quick", " brown", " fox", " jumps"]
+
+
+class FakeModel:
+    """Recognises SCRIPT words whose full second lies in the decoded window"""
+
+    def __init__(self):
+        self.calls = []
+
+    def __call__(self, samples, prompt):
+        offset = int(samples[0]) if samples.size else 0
+        self.calls.append((offset, samples.size, prompt))
+        words = []
+        for i, word in enumerate(SCRIPT):
+            start, end = i * RATE, (i + 1) * RATE
+            if start >= offset and end <= offset + samples.size:
+                words.append((word, (start - offset) / RATE, (end - offset) / RATE))
+        return words
+
+
+def fetcher(audio_len):
+    # Each sample holds its own absolute index so the fake model knows where a slice starts
+    audio = np.arange(audio_len, dtype=np.float32)
+
+    def fetch(begin):
+        return audio[begin:], begin
+    return fetch
+
+
+class TestLocalAgreementDecoder:
+
+    def test_commits_only_words_two_hypotheses_agree_on(self):
+        model = FakeModel()
+        decoder = LocalAgreementDecoder(model, RATE)
+
+        committed, tentative = decoder.update(fetcher(2 * RATE))
+        assert committed == ""
+        assert tentative == "the quick"
+
+        committed, tentative = decoder.update(fetcher(3 * RATE))
+        assert committed == "the quick"
+        assert tentative == "brown"
+        assert decoder.commit_point == 2 * RATE
+
+    def test_finish_decodes_only_the_uncommitted_tail(self):
+        model = FakeModel()
+        decoder = LocalAgreementDecoder(model, RATE)
+        decoder.update(fetcher(2 * RATE))
+        decoder.update(fetcher(3 * RATE))
+
+        text = decoder.finish(fetcher(5 * RATE))
+
+        assert text == "the quick brown fox jumps"
+        offset, size, prompt = model.calls[-1]
+        assert offset == 2 * RATE
+        assert size == 3 * RATE
+        assert prompt == "the quick"
+
+    def test_reset_starts_a_new_utterance(self):
+        decoder = LocalAgreementDecoder(FakeModel(), RATE)
+        decoder.update(fetcher(2 * RATE))
+        decoder.update(fetcher(3 * RATE))
+        decoder.reset(4 * RATE)
+
+        assert decoder.committed_text() == ""
+        assert decoder.finish(fetcher(5 * RATE)) == "jumps"
+
+    def test_timed_words_cover_committed_and_tentative(self):
+        decoder = LocalAgreementDecoder(FakeModel(), RATE)
+        decoder.update(fetcher(2 * RATE))
+        decoder.update(fetcher(3 * RATE))
+
+        assert decoder.timed_words() == [
+            (" the", 0, RATE), (" quick", RATE, 2 * RATE), (" brown", 2 * RATE, 3 * RATE)]
+
+    def test_silence_does_not_grow_the_tail_forever(self):
+        decoder = LocalAgreementDecoder(lambda samples, prompt: [], RATE, max_tail_seconds=3)
+        decoder.update(fetcher(10 * RATE))
+
+        assert decoder.commit_point == 9 * RATE
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
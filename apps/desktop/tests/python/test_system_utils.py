@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""
+Unit tests for system_utils.py cascade planning and host tuning
+"""
+
+import pytest
+import sys
+import os
+from unittest.mock import patch, Mock
+
+# Add parent directory to path for imports
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+import system_utils
+from system_utils import plan_cascade, choose_tuning, save_tuning, load_tuning, tune, load_clip, synthetic_speech_clip
+
+
+def fake_psutil(available_gb):
+    psutil = Mock()
+    psutil.virtual_memory.return_value = Mock(available=available_gb * 1024**3)
+    return psutil
+
+
+class TestPlanCascade:
+    def test_enabled_with_enough_memory(self):
+        with patch.object(system_utils, 'psutil', fake_psutil(6)):
+            plan = plan_cascade("small", profile={"ram_gb": 16})
+        assert plan["enabled"]
+        assert plan["draft"] == "tiny"
+        assert plan["final_mb"] > plan["draft_mb"]
+
+    def test_disabled_for_tiny_final(self):
+        plan = plan_cascade("tiny", profile={"ram_gb": 32})
+        assert not plan["enabled"]
+
+    def test_disabled_on_low_ram(self):
+        plan = plan_cascade("small", profile={"ram_gb": 4})
+        assert not plan["enabled"]
+
+    def test_disabled_when_memory_is_taken(self):
+        with patch.object(system_utils, 'psutil', fake_psutil(1)):
+            plan = plan_cascade("medium", profile={"ram_gb": 16})
+        assert not plan["enabled"]
+        assert plan["available_mb"] == 1024
+
+    def test_model_variants_use_their_family_size(self):
+        plan = plan_cascade("large-v3", profile={"ram_gb": 4})
+        assert plan["final_mb"] == system_utils.MODEL_MEMORY_MB["large"]
+        assert system_utils.model_memory_mb("small.en") == system_utils.MODEL_MEMORY_MB["small"]
+        assert system_utils.model_memory_mb("custom-finetune") == system_utils.MODEL_MEMORY_MB["large"]
+
+
+def result(compute_type, threads, final, partial, rss):
+    return {"compute_type": compute_type, "cpu_threads": threads,
+            "rtf": {"final": final, "partial": partial}, "peak_rss_mb": rss}
+
+
+class TestTuning:
+    def test_choose_fastest_config(self):
+        best = choose_tuning([
+            result("float32", 4, 0.40, 0.30, 900),
+            result("int8", 4, 0.20, 0.15, 500),
+        ])
+        assert best["compute_type"] == "int8"
+        assert best["rtf"] == 0.20
+
+    def test_near_tie_prefers_less_memory(self):
+        best = choose_tuning([
+            result("float32", 8, 0.200, 0.1, 900),
+            result("int8", 8, 0.204, 0.1, 400),
+        ])
+        assert best["compute_type"] == "int8"
+
+    def test_beam_width_is_not_tuned(self):
+        # A slow host keeps the decode profile's final beam
+        best = choose_tuning([result("int8", 2, 0.9, 0.5, 500)])
+        assert "beam_size" not in best
+
+    def test_failed_runs_are_ignored(self):
+        assert choose_tuning([{"compute_type": "int8", "cpu_threads": 2, "error": "boom"}]) is None
+
+    def test_save_keeps_other_settings(self, tmp_path):
+        path = str(tmp_path / "settings.json")
+        with open(path, "w") as f:
+            f.write('{"theme": "dark"}')
+        save_tuning("base", {"compute_type": "int8", "cpu_threads": 4}, path)
+        assert load_tuning("base", path)["cpu_threads"] == 4
+        assert load_tuning("small", path) is None
+        assert system_utils.read_settings(path)["theme"] == "dark"
+
+    def test_missing_explicit_clip_is_an_error(self, tmp_path):
+        report = tune("base", str(tmp_path / "missing.wav"), str(tmp_path / "settings.json"))
+        assert report["best"] is None
+        assert "No tuning clip" in report["error"]
+
+    def test_tune_stores_a_result_with_the_shipped_assets(self, tmp_path):
+        path = str(tmp_path / "settings.json")
+        runs = []
+
+        def fake_run(args, **kwargs):
+            runs.append(args)
+            _, compute_type, threads = args[-3:]
+            rtf = 0.2 if compute_type == "int8" else 0.4
+            line = '{"compute_type": "%s", "cpu_threads": %s, "rtf": {"final": %s, "partial": 0.1}, ' \
+                   '"peak_rss_mb": 500, "clip": "builtin"}' % (compute_type, threads, rtf)
+            return Mock(stdout=line + "\n")
+
+        with patch('subprocess.run', side_effect=fake_run):
+            report = tune("base", path=path)
+        # No clip argument: each run picks the shipped recording or the built-in clip
+        assert all(args[2] == "tune-run" and len(args) == 6 for args in runs)
+        assert report["best"]["compute_type"] == "int8"
+        assert load_tuning("base", path)["compute_type"] == "int8"
+
+    def test_failed_runs_report_an_error(self, tmp_path):
+        with patch('subprocess.run', return_value=Mock(stdout="")):
+            report = tune("base", path=str(tmp_path / "settings.json"))
+        assert report["best"] is None
+        assert report["error"]
+        assert load_tuning("base", str(tmp_path / "settings.json")) is None
+
+    def test_builtin_clip_stands_in_for_a_missing_recording(self, tmp_path):
+        with patch.object(system_utils, 'TUNE_CLIP_PATH', str(tmp_path / "speech.wav")):
+            clip = load_clip()
+        assert clip.size == 16000 * system_utils.TUNE_CLIP_SECONDS
+        assert abs(synthetic_speech_clip(seconds=1)).max() <= 0.31
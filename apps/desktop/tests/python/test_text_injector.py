@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""
+Unit tests for text_injector.py keysym mapping and focus handling
+"""
+
+import pytest
+import sys
+import os
+
+# Add parent directory to path for imports
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+from text_injector import (ActiveWindowWatcher, TextInjector, XTestBackend, XTestUnavailable,
+                           keysym_for, parse_wm_class)
+
+
+class FakeBackend:
+    """Focus moves to the next window in ``focus_sequence`` on every poll."""
+
+    def __init__(self, focus_sequence, skipped=0, parents=None):
+        self.focus_sequence = list(focus_sequence)
+        self.parents = parents or {}  # child window -> parent, below the toplevels
+        self.skipped = skipped
+        self.focus_requests = []
+        self.typed = []
+        self.synced = 0
+
+    def focused_window(self):
+        if len(self.focus_sequence) > 1:
+            return self.focus_sequence.pop(0)
+        return self.focus_sequence[0]
+
+    def within(self, window, ancestor):
+        while window:
+            if window == ancestor:
+                return True
+            window = self.parents.get(window)
+        return False
+
+    def set_focus(self, window):
+        self.focus_requests.append(window)
+
+    def type_text(self, text):
+        self.typed.append(text)
+        return self.skipped
+
+    def sync(self):
+        self.synced += 1
+
+
+class FakeClock:
+    def __init__(self):
+        self.now = 0.0
+
+    def __call__(self):
+        return self.now
+
+    def sleep(self, seconds):
+        self.now += seconds
+
+
+def make_injector(backend):
+    responses = []
+    clock = FakeClock()
+    injector = TextInjector(backend, lambda request_id, **fields: responses.append((request_id, fields)),
+                            clock=clock, sleep=clock.sleep)
+    return injector, responses
+
+
+class TestKeysyms:
+    def test_latin1_maps_directly(self):
+        assert keysym_for('a') == ord('a')
+        assert keysym_for('A') == ord('A')
+        assert keysym_for('é') == 0xE9
+
+    def test_unicode_uses_offset_keysyms(self):
+        assert keysym_for('€') == 0x010020AC
+        assert keysym_for('ł') == 0x01000142
+
+    def test_control_characters(self):
+        assert keysym_for('\n') == 0xFF0D
+        assert keysym_for('\t') == 0xFF09
+        assert keysym_for('\b') == 0xFF08
+
+
+class TestTextInjector:
+    def test_types_once_target_has_focus(self):
+        backend = FakeBackend([55, 55, 42])
+        injector, responses = make_injector(backend)
+        injector.handle(1, 'type', {'text': 'hello', 'window': 42})
+        assert backend.focus_requests == [42]
+        assert backend.typed == ['hello']
+        assert backend.synced == 1
+        request_id, fields = responses[0]
+        assert request_id == 1
+        assert fields['ok'] is True
+        assert fields['result'] == {'delivered': 5, 'skipped': 0, 'backspaces': 0}
+        assert injector.stats['focus_waits'] == 1
+
+    def test_without_target_waits_until_focus_leaves_own_windows(self):
+        backend = FakeBackend([7, 0, 99])
+        injector, responses = make_injector(backend)
+        injector.handle(2, 'type', {'text': 'hi', 'avoid': [7]})
+        assert backend.focus_requests == []
+        assert backend.typed == ['hi']
+        assert responses[0][1]['ok'] is True
+
+    def test_focus_on_a_child_of_the_target_counts(self):
+        # Java/toolkit focus proxy 421 inside client 42; 71 inside SONU's window 7
+        backend = FakeBackend([421], parents={421: 42, 71: 7})
+        injector, responses = make_injector(backend)
+        injector.handle(8, 'type', {'text': 'hi', 'window': 42})
+        assert backend.focus_requests == []
+        assert responses[0][1]['ok'] is True
+        backend = FakeBackend([71, 421], parents={421: 42, 71: 7})
+        injector, responses = make_injector(backend)
+        injector.handle(9, 'type', {'text': 'hi', 'avoid': [7]})
+        assert injector.stats['focus_waits'] == 1
+        assert backend.typed == ['hi']
+
+    def test_focus_timeout_types_nothing(self):
+        backend = FakeBackend([7])
+        injector, responses = make_injector(backend)
+        injector.handle(3, 'type', {'text': 'lost', 'window': 42, 'timeout_ms': 20})
+        assert backend.typed == []
+        assert responses[0][1]['ok'] is False
+        assert responses[0][1]['error'] == 'focus_timeout'
+        assert injector.stats['focus_timeouts'] == 1
+
+    def test_reports_untypeable_characters(self):
+        backend = FakeBackend([42], skipped=1)
+        injector, responses = make_injector(backend)
+        injector.handle(4, 'type', {'text': 'a€', 'window': 42})
+        assert responses[0][1]['result'] == {'delivered': 1, 'skipped': 1, 'backspaces': 0}
+
+    def test_backspaces_go_out_with_the_text(self):
+        backend = FakeBackend([42])
+        injector, responses = make_injector(backend)
+        injector.handle(7, 'type', {'text': 'ed', 'backspaces': 3, 'window': 42})
+        assert backend.typed == ['\b\b\bed']
+        assert responses[0][1]['result']['backspaces'] == 3
+
+    def test_focus_and_unknown_ops(self):
+        injector, responses = make_injector(FakeBackend([42]))
+        injector.handle(5, 'focus')
+        injector.handle(6, 'paste')
+        assert responses[0][1]['result'] == {'window': 42}
+        assert responses[1][1]['ok'] is False
+        assert responses[1][1]['error'] == 'unknown_op'
+
+
+class TestActiveWindowWatcher:
+    def test_app_name_is_the_wm_class(self):
+        assert parse_wm_class(b'slack\x00Slack\x00') == 'Slack'
+        assert parse_wm_class(b'') == ''
+
+    def test_reports_only_changes(self):
+        seen = []
+        watcher = ActiveWindowWatcher(None, ':0', seen.append)
+        watcher.report({'window': 1, 'app': 'Slack', 'title': 'general'})
+        watcher.report({'window': 1, 'app': 'Slack', 'title': 'general'})
+        watcher.report({'window': 1, 'app': 'Slack', 'title': 'random'})
+        assert [info['title'] for info in seen] == ['general', 'random']
+
+
+class TestBackendAvailability:
+    def test_no_display_is_unavailable(self, monkeypatch):
+        monkeypatch.delenv('DISPLAY', raising=False)
+        with pytest.raises(XTestUnavailable):
+            XTestBackend()
+
+
+if __name__ == '__main__':
+    pytest.main([__file__, '-v'])
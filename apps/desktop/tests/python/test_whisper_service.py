@@ -11,6 +11,8 @@ import threading
 from unittest.mock import Mock, patch, MagicMock
 import time
 
+import numpy as np
+
 # Add parent directory to path for imports
 sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
 
@@ -24,6 +26,7 @@ from whisper_service import (
     audio_capture_loop, transcribe_frames, transcribe_recent_seconds,
     main
 )
+import whisper_service
 
 
 class TestComboParsing:
@@ -78,36 +81,60 @@ class TestTranscription:
     """Test transcription functionality"""
 
     @patch('whisper_service.model')
-    @patch('whisper_service.frames', [b'test_data'])
-    @patch('whisper_service.audio')
-    @patch('tempfile.mkstemp')
-    @patch('wave.open')
-    @patch('os.remove')
-    def test_transcribe_frames(self, mock_remove, mock_wave_open, mock_mkstemp,
-                              mock_audio, mock_model):
-        """Test frame transcription"""
-        # Setup mocks
-        mock_mkstemp.return_value = (123, '/tmp/test.wav')
-        mock_wave_file = Mock()
-        mock_wave_open.return_value = mock_wave_file
+    def test_transcribe_frames(self, mock_model):
+        """Test frame transcription passes the in-memory buffer to the model"""
+        whisper_service.pcm_ring.mark_start()
+        whisper_service.pcm_ring.write_int16(np.full(1600, 16384, dtype=np.int16).tobytes())
         mock_model.transcribe.return_value = ([Mock(text="test transcription")], {})
 
         result = transcribe_frames()
 
         assert result == "test transcription"
-        mock_wave_file.setnchannels.assert_called_with(1)
-        mock_wave_file.setframerate.assert_called_with(16000)
-        mock_model.transcribe.assert_called_once()
+        samples = mock_model.transcribe.call_args[0][0]
+        assert samples.dtype == np.float32
+        assert samples.size == 1600
+        assert samples[0] == pytest.approx(0.5)
+        whisper_service.pcm_ring.mark_start()
 
-    @patch('whisper_service.transcribe_frames')
+    @patch('whisper_service.transcribe_audio')
     def test_transcribe_recent_seconds(self, mock_transcribe):
-        """Test recent seconds transcription"""
+        """Test recent seconds transcription uses only the tail of the ring"""
         mock_transcribe.return_value = "recent transcription"
+        whisper_service.pcm_ring.mark_start()
+        whisper_service.pcm_ring.write_int16(np.zeros(16000 * 5, dtype=np.int16).tobytes())
 
-        result = transcribe_recent_seconds([b'data'] * 100, seconds=2)
+        result = transcribe_recent_seconds(seconds=2)
 
         assert result == "recent transcription"
-        mock_transcribe.assert_called_once()
+        assert mock_transcribe.call_args[0][0].size == 16000 * 2
+        whisper_service.pcm_ring.mark_start()
+
+
+class TestModelSwap:
+    """Test LOAD_MODEL hot swapping"""
+
+    @patch('whisper_service.inference')
+    @patch('whisper_service.WhisperModel')
+    def test_load_model_swaps_and_reports_ready(self, mock_whisper_model, mock_inference, capsys):
+        old_model, old_size = whisper_service.model, whisper_service.model_size
+        new_model = Mock()
+        mock_whisper_model.return_value = new_model
+        try:
+            whisper_service.load_model("small")
+            assert whisper_service.model is new_model
+            assert whisper_service.model_size == "small"
+            assert "EVENT: READY" in capsys.readouterr().out
+        finally:
+            whisper_service.model, whisper_service.model_size = old_model, old_size
+
+    @patch('whisper_service.WhisperModel')
+    def test_failed_load_keeps_old_model(self, mock_whisper_model, capsys):
+        old_model, old_size = whisper_service.model, whisper_service.model_size
+        mock_whisper_model.side_effect = RuntimeError("missing")
+        whisper_service.load_model("medium")
+        assert whisper_service.model is old_model
+        assert whisper_service.model_size == old_size
+        assert "EVENT: LOAD_FAILED medium" in capsys.readouterr().out
 
 
 class TestRecordingLogic:
@@ -138,6 +165,39 @@ class TestRecordingLogic:
         mock_transcribe.assert_called_once()
         mock_stdout.write.assert_called_with("test result\n")
 
+    def test_start_waits_for_the_hold_release_final(self):
+        """A START during a hold-release final must not re-mark the ring or swap the request id"""
+        decoding = threading.Event()
+        proceed = threading.Event()
+        finals = []
+
+        def slow_final(request_id=None):
+            decoding.set()
+            proceed.wait(5)
+            finals.append((whisper_service.utterance_request_id, whisper_service.pcm_ring.recording_start))
+
+        whisper_service.set_recording(True, request_id=7)
+        start = whisper_service.pcm_ring.recording_start
+        with patch('whisper_service.emit_final', side_effect=slow_final), \
+             patch('whisper_service.start_stream'), \
+             patch('whisper_service.ipc'), \
+             patch('whisper_service.time.sleep'):
+            release = threading.Thread(target=whisper_service.finish_hold_recording)
+            release.start()
+            assert decoding.wait(5)
+            begin = threading.Thread(target=whisper_service.begin_recording, kwargs={"request_id": 8})
+            begin.start()
+            time.sleep(0.05)
+            assert begin.is_alive()
+            proceed.set()
+            release.join(5)
+            begin.join(5)
+
+        assert finals == [(7, start)]
+        assert whisper_service.utterance_request_id == 8
+        assert whisper_service.recording_flag
+        whisper_service.set_recording(False)
+
 
 class TestMainLoop:
     """Test main service loop"""
@@ -173,7 +233,7 @@ class TestIntegration:
         """Test that service initializes without errors"""
         # Reset global state
         whisper_service.recording_flag = False
-        whisper_service.frames = []
+        whisper_service.pcm_ring.mark_start()
         whisper_service.stream = None
         whisper_service.hold_mode = False
         whisper_service.hold_keys_combo = "ctrl+shift+space"
@@ -181,7 +241,7 @@ class TestIntegration:
 
         # Should not raise exceptions
         assert whisper_service.recording_flag == False
-        assert whisper_service.frames == []
+        assert whisper_service.pcm_ring.recording_length() == 0
         assert whisper_service.stream == None
 
     @patch('whisper_service.combo_pressed')
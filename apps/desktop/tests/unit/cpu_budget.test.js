@@ -0,0 +1,43 @@
+const os = require('os');
+const { CpuBudget } = require('../../src/cpu_budget.js');
+
+describe('CPU Budget Tests', () => {
+  test('reserves a core and gives the LLM half of the rest', () => {
+    const budget = new CpuBudget({ cores: 8, platform: 'linux' });
+    expect(budget.plan.whisper.threads).toBe(7);
+    expect(budget.plan.llm.threads).toBe(3);
+    expect(budget.envFor('llm')).toEqual({ SONU_LLM_THREADS: '3', SONU_CPU_AFFINITY: '1-7' });
+  });
+
+  test('uses every core on small machines and skips affinity elsewhere', () => {
+    const small = new CpuBudget({ cores: 2, platform: 'linux' });
+    expect(small.plan.whisper.threads).toBe(2);
+    expect(small.plan.llm.threads).toBe(1);
+    expect(small.envFor('whisper')).toEqual({ SONU_WHISPER_THREADS: '2' });
+    const windows = new CpuBudget({ cores: 8, platform: 'win32' });
+    expect(windows.envFor('whisper')).toEqual({ SONU_WHISPER_THREADS: '7' });
+  });
+
+  test('ranks priorities whisper > llm > background', () => {
+    const { plan } = new CpuBudget({ cores: 8 });
+    expect(plan.whisper.priority).toBe(os.constants.priority.PRIORITY_NORMAL);
+    expect(plan.llm.priority).toBeGreaterThan(plan.whisper.priority);
+    expect(plan.background.priority).toBeGreaterThan(plan.llm.priority);
+  });
+
+  test('defers background work until the dictation is done', () => {
+    const budget = new CpuBudget({ cores: 4 });
+    const ran = [];
+    budget.setPhase('capture');
+    budget.whenIdle(() => ran.push('tune'));
+    budget.setPhase('decode');
+    budget.setPhase('transform');
+    expect(ran).toEqual([]);
+    budget.endPhase('decode'); // stale: a new phase already started
+    expect(ran).toEqual([]);
+    budget.endPhase('transform');
+    expect(ran).toEqual(['tune']);
+    budget.whenIdle(() => ran.push('warm'));
+    expect(ran).toEqual(['tune', 'warm']);
+  });
+});
@@ -0,0 +1,41 @@
+const { planEdit, alignWords } = require('../../src/edit_script.js');
+
+describe('Edit Script Tests', () => {
+  test('appends without backspaces when the hypothesis only grows', () => {
+    expect(planEdit('I want to go', 'I want to go home')).toMatchObject({ backspaces: 0, text: ' home' });
+  });
+
+  test('erases back to the common prefix and retypes the rest', () => {
+    const plan = planEdit('I want to go home', 'I wanted to go home');
+    expect(plan).toMatchObject({ backspaces: 11, text: 'ed to go home', screen: 'I wanted to go home' });
+  });
+
+  test('caps how far back a rewrite reaches', () => {
+    const screen = 'the quick brown fox jumps over the lazy dog and then some more words here';
+    const next = 'a quick brown fox jumps over the lazy dog and then sum more words here today';
+    const plan = planEdit(screen, next, { maxBackspaces: 20 });
+    // "the" is past the cap and stays; "some more words here" is rewritten
+    expect(plan).toMatchObject({ backspaces: 19, text: 'um more words here today' });
+    expect(plan.screen).toBe('the quick brown fox jumps over the lazy dog and then sum more words here today');
+  });
+
+  test('without backspaces, types only words after the aligned end of the screen', () => {
+    const plan = planEdit('one two three four five six', 'one two tree for five six seven', { maxBackspaces: 0 });
+    expect(plan).toMatchObject({ backspaces: 0, text: ' seven' });
+  });
+
+  test('aligns by word timestamps when they match the text', () => {
+    const plan = planEdit('hello world foo', 'hello word foo bar', {
+      maxBackspaces: 6,
+      screenTimes: [['hello', 0, 300], ['world', 300, 600], ['foo', 600, 900]],
+      nextTimes: [['hello', 0, 300], ['word', 310, 600], ['foo', 600, 880], ['bar', 900, 1200]]
+    });
+    expect(plan).toMatchObject({ backspaces: 6, text: 'd foo bar', screen: 'hello word foo bar' });
+    expect(plan.times.length).toBe(4);
+  });
+
+  test('word alignment maps substitutions and drops', () => {
+    expect(alignWords(['a', 'b', 'c', 'd'], ['a', 'c', 'd'])).toEqual([0, -1, 1, 2]);
+    expect(alignWords(['a', 'b', 'c'], ['a', 'x', 'c'])).toEqual([0, 1, 2]);
+  });
+});
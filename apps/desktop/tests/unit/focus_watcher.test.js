@@ -0,0 +1,64 @@
+const EventEmitter = require('events');
+const { FocusWatcher, categorize } = require('../../src/focus_watcher.js');
+
+// Child process stand-in whose stdout the test writes to
+function fakeSpawn() {
+  const spawned = [];
+  const spawn = (command, args) => {
+    const child = new EventEmitter();
+    child.stdout = new EventEmitter();
+    child.stderr = new EventEmitter();
+    child.kill = () => child.emit('exit', null);
+    spawned.push({ command, args, child });
+    return child;
+  };
+  return { spawn, spawned };
+}
+
+describe('Focus Watcher Tests', () => {
+  test('maps app names and window titles to categories', () => {
+    expect(categorize('firefox', 'Inbox - Gmail')).toBe('email');
+    expect(categorize('Slack', 'general')).toBe('work');
+    expect(categorize('Telegram', '')).toBe('personal');
+    expect(categorize('code', 'main.js')).toBe(null);
+  });
+
+  test('serves the category from memory and reports changes', () => {
+    const watcher = new FocusWatcher({ platform: 'linux' });
+    const changes = [];
+    watcher.on('change', info => changes.push(info.category));
+    expect(watcher.category()).toBe(null);
+    watcher.update({ window: 7, app: 'Slack', title: 'general' });
+    watcher.update({ window: 7, app: 'Slack', title: 'random' });
+    watcher.update({ window: 9, app: 'Thunderbird', title: 'Inbox' });
+    expect(watcher.category()).toBe('email');
+    expect(changes).toEqual(['work', 'email']);
+  });
+
+  test('ignores focus moving to our own windows', () => {
+    const watcher = new FocusWatcher({ platform: 'linux', ignore: ({ window }) => window === 1 });
+    watcher.update({ window: 5, app: 'Slack', title: '' });
+    watcher.update({ window: 1, app: 'SONU', title: 'SONU' });
+    expect(watcher.current.window).toBe(5);
+    expect(watcher.category()).toBe('work');
+  });
+
+  test('reads tab-separated lines from the helper script', () => {
+    const { spawn, spawned } = fakeSpawn();
+    const watcher = new FocusWatcher({ platform: 'darwin', spawn });
+    watcher.start();
+    expect(spawned[0].command).toBe('osascript');
+    spawned[0].child.stderr.emit('data', Buffer.from('412\tMail\tInbox\n412\tMa'));
+    expect(watcher.category()).toBe('email');
+    spawned[0].child.stderr.emit('data', Buffer.from('il\tDrafts\n'));
+    expect(watcher.current.title).toBe('Drafts');
+    watcher.stop();
+    expect(watcher.child).toBe(null);
+  });
+
+  test('starts no helper on Linux', () => {
+    const { spawn, spawned } = fakeSpawn();
+    new FocusWatcher({ platform: 'linux', spawn }).start();
+    expect(spawned.length).toBe(0);
+  });
+});
@@ -0,0 +1,96 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { HistoryStore } = require('../../src/history_store.js');
+
+function tempDir() {
+  return fs.mkdtempSync(path.join(os.tmpdir(), 'sonu-history-'));
+}
+
+async function cleanup(store, dir) {
+  await store.writes;
+  fs.rmSync(dir, { recursive: true, force: true });
+}
+
+describe('History Store Tests', () => {
+  test('appends and pages newest first', async () => {
+    const dir = tempDir();
+    const store = new HistoryStore({ dir });
+    for (let i = 0; i < 5; i++) await store.append({ text: `note ${i}`, ts: 1000 + i });
+    const page = await store.page({ offset: 1, limit: 2 });
+    expect(page.total).toBe(5);
+    expect(page.items.map(e => e.text)).toEqual(['note 3', 'note 2']);
+    expect(store.last().text).toBe('note 4');
+    expect(store.stats()).toEqual({ count: 5, words: 10, duration: 0 });
+    await cleanup(store, dir);
+  });
+
+  test('gives entries with the same timestamp distinct ids', async () => {
+    const dir = tempDir();
+    const store = new HistoryStore({ dir });
+    const first = await store.append({ text: 'one', ts: 5000 });
+    const second = await store.append({ text: 'two', ts: 5000 });
+    expect(second.ts).toBe(first.ts + 1);
+    await cleanup(store, dir);
+  });
+
+  test('edits and deletes survive a reopen with or without the index', async () => {
+    const dir = tempDir();
+    const store = new HistoryStore({ dir });
+    await store.append({ text: 'first draft', ts: 1 });
+    await store.append({ text: 'second', ts: 2 });
+    await store.append({ text: 'third', ts: 3 });
+    await store.update(1, { text: 'first final' });
+    await store.remove(3);
+    await store.saveIndex();
+    await store.append({ text: 'after index', ts: 4 });
+    await store.writes;
+
+    const reopened = new HistoryStore({ dir });
+    expect((await reopened.all()).map(e => e.text)).toEqual(['first final', 'second', 'after index']);
+    expect(reopened.last().text).toBe('after index');
+
+    fs.unlinkSync(path.join(dir, 'index.json'));
+    const rebuilt = new HistoryStore({ dir });
+    expect((await rebuilt.all()).map(e => e.text)).toEqual(['first final', 'second', 'after index']);
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  test('drops a torn last record', async () => {
+    const dir = tempDir();
+    const store = new HistoryStore({ dir });
+    await store.append({ text: 'kept', ts: 1 });
+    await store.writes;
+    fs.appendFileSync(path.join(dir, '00000001.jsonl'), '{"op":"add","ts":2,"te');
+    const reopened = new HistoryStore({ dir });
+    expect((await reopened.all()).map(e => e.text)).toEqual(['kept']);
+    await reopened.append({ text: 'next', ts: 3 });
+    expect((await new HistoryStore({ dir }).all()).map(e => e.text)).toEqual(['kept', 'next']);
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  test('compacts once dead records outweigh live ones', async () => {
+    const dir = tempDir();
+    const store = new HistoryStore({ dir, segmentMaxBytes: 200, compactMinDeadBytes: 100 });
+    for (let i = 0; i < 10; i++) await store.append({ text: `entry number ${i}`, ts: i + 1 });
+    for (let i = 1; i <= 8; i++) await store.remove(i);
+    await store.compact();
+    expect(store.deadBytes()).toBe(0);
+    expect((await store.all()).map(e => e.ts)).toEqual([9, 10]);
+    const segments = fs.readdirSync(dir).filter(name => name.endsWith('.jsonl'));
+    expect(segments.length).toBe(1);
+    expect((await new HistoryStore({ dir }).all()).map(e => e.ts)).toEqual([9, 10]);
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  test('imports the old history.json once', async () => {
+    const dir = tempDir();
+    const legacyPath = path.join(dir, 'history.json');
+    fs.writeFileSync(legacyPath, JSON.stringify([{ text: 'old one', ts: 10 }, { text: 'old two', ts: 20 }]));
+    const store = new HistoryStore({ dir: path.join(dir, 'history'), legacyPath });
+    expect((await store.all()).map(e => e.text)).toEqual(['old one', 'old two']);
+    expect(fs.existsSync(legacyPath)).toBe(false);
+    expect(fs.existsSync(`${legacyPath}.migrated`)).toBe(true);
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+});
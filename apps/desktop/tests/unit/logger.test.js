@@ -0,0 +1,97 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { Logger, parseLevels } = require('../../logger.js');
+
+function tempLogger(options = {}) {
+  const logsDir = fs.mkdtempSync(path.join(os.tmpdir(), 'sonu-logs-'));
+  const originalLog = console.log;
+  console.log = () => {};
+  const logger = new Logger({ logsDir, console: false, flushIntervalMs: 60000, ...options });
+  console.log = originalLog;
+  return logger;
+}
+
+function readLines(logger, category) {
+  const day = new Date().toISOString().split('T')[0];
+  return fs.readFileSync(path.join(logger.logsDir, `${category}-${day}.log`), 'utf8')
+    .split('\n').filter(Boolean).map(line => JSON.parse(line));
+}
+
+describe('Logger Tests', () => {
+  test('buffers calls and writes one JSON line per entry on flush', async () => {
+    const logger = tempLogger();
+    logger.typing('Typed chunk', { chars: 12, nested: { ok: true } });
+    expect(logger.count).toBe(2); // plus the start record
+    await logger.flush();
+    expect(logger.count).toBe(0);
+    const typing = readLines(logger, 'typing');
+    expect(typing.length).toBe(1);
+    expect(typing[0]).toMatchObject({ level: 'info', cat: 'typing', msg: 'Typed chunk', data: { chars: 12, nested: { ok: true } } });
+    // Category entries are mirrored into the main log
+    expect(readLines(logger, 'main').map(e => e.msg)).toEqual(['Logger started', 'Typed chunk']);
+  });
+
+  test('filters by per-category level before buffering', async () => {
+    const logger = tempLogger({ levels: { typing: 'warn', main: 'debug' } });
+    logger.typing('dropped');
+    logger.typingError('kept', new Error('no focus'));
+    logger.debug('debug kept');
+    expect(logger.isEnabled('typing', 'info')).toBe(false);
+    expect(logger.isEnabled('main', 'debug')).toBe(true);
+    await logger.flush();
+    const typing = readLines(logger, 'typing');
+    expect(typing.length).toBe(1);
+    expect(typing[0].data.message).toBe('no focus');
+  });
+
+  test('parses level specs from the environment format', () => {
+    expect(parseLevels('typing=warn, whisper=debug,bogus=info,main=loud')).toEqual({ typing: 'warn', whisper: 'debug' });
+    expect(parseLevels('error').download).toBe('error');
+  });
+
+  test('drops the oldest entries when the ring is full and says so', async () => {
+    const logger = tempLogger({ ringCapacity: 3 });
+    for (let i = 0; i < 5; i++) logger.info(`entry ${i}`);
+    await logger.flush();
+    const messages = readLines(logger, 'main').map(e => e.msg);
+    expect(messages).toEqual(['Log buffer full, 3 entries dropped', 'entry 2', 'entry 3', 'entry 4']);
+  });
+
+  test('rotates a file that grows past the size limit', async () => {
+    const logger = tempLogger({ maxFileBytes: 200, maxRotatedFiles: 2 });
+    for (let round = 0; round < 4; round++) {
+      logger.download('Downloaded block', { round, padding: 'x'.repeat(120) });
+      await logger.flush();
+    }
+    const day = new Date().toISOString().split('T')[0];
+    const names = fs.readdirSync(logger.logsDir).filter(n => n.startsWith('download-')).sort();
+    expect(names).toEqual([`download-${day}.1.log`, `download-${day}.2.log`, `download-${day}.log`]);
+    expect(readLines(logger, 'download')[0].data.round).toBe(3);
+  });
+
+  test('flushSync writes pending entries before returning', () => {
+    const logger = tempLogger();
+    logger.whisper('Service exited', { code: 0 });
+    logger.flushSync();
+    expect(readLines(logger, 'whisper')[0].msg).toBe('Service exited');
+  });
+
+  test('flushSync writes batches whose async append has not finished', async () => {
+    const logger = tempLogger();
+    logger.typing('Last words before quit');
+    const writing = logger.flush();
+    expect(logger.pending.length).toBeGreaterThan(0);
+    logger.flushSync();
+    expect(readLines(logger, 'typing')[0].msg).toBe('Last words before quit');
+    await writing;
+    expect(logger.pending.length).toBe(0);
+  });
+
+  test('recent logs include entries not yet flushed', async () => {
+    const logger = tempLogger();
+    logger.info('just now');
+    const recent = await logger.getRecentLogs('main', 1);
+    expect(JSON.parse(recent).msg).toBe('just now');
+  });
+});
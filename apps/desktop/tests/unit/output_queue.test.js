@@ -0,0 +1,116 @@
+const { OutputQueue } = require('../../src/output_queue.js');
+
+// inject() stays pending until the test releases it, like a paste waiting for focus
+function gatedInjector() {
+  const calls = [];
+  const inject = (text) => new Promise(resolve => calls.push({ text, done: () => resolve(true) }));
+  return { calls, inject };
+}
+
+const tick = () => new Promise(resolve => setImmediate(resolve));
+
+describe('Output Queue Tests', () => {
+  test('injects one item at a time in queue order', async () => {
+    const { calls, inject } = gatedInjector();
+    const queue = new OutputQueue({ inject });
+    queue.push('Hello', { utterance: 1 });
+    queue.push(' there', { utterance: 2 });
+    await tick();
+    expect(calls.map(c => c.text)).toEqual(['Hello']);
+    calls[0].done();
+    await tick();
+    expect(calls.map(c => c.text)).toEqual(['Hello', ' there']);
+    calls[1].done();
+    await queue.whenIdle();
+    expect(queue.isIdle()).toBe(true);
+  });
+
+  test('merges deltas of one utterance that arrive during an injection', async () => {
+    const { calls, inject } = gatedInjector();
+    const queue = new OutputQueue({ inject });
+    queue.push('one', { utterance: 1 });
+    queue.push(' two', { utterance: 1 });
+    queue.push(' three', { utterance: 1 });
+    queue.push('Next', { utterance: 2 });
+    queue.push(' words', { utterance: 2 });
+    await tick();
+    calls[0].done();
+    await tick();
+    calls[1].done();
+    await tick();
+    calls[2].done();
+    await queue.whenIdle();
+    expect(calls.map(c => c.text)).toEqual(['one', ' two three', 'Next words']);
+    expect(queue.getStatus().coalesced).toBe(2);
+  });
+
+  test('reports back-pressure above the high-water mark until drained', async () => {
+    const { calls, inject } = gatedInjector();
+    const queue = new OutputQueue({ inject, highWaterChars: 10 });
+    const pressure = [];
+    queue.on('pressure', busy => pressure.push(busy));
+    queue.push('short', { utterance: 1 });
+    queue.push(' and a much longer tail', { utterance: 1 });
+    expect(pressure).toEqual([true]);
+    await tick();
+    calls[0].done();
+    await tick();
+    expect(pressure).toEqual([true]);
+    calls[1].done();
+    await queue.whenIdle();
+    expect(pressure).toEqual([true, false]);
+  });
+
+  test('keeps going after a failed injection', async () => {
+    let attempts = 0;
+    const queue = new OutputQueue({
+      inject: () => {
+        attempts++;
+        if (attempts === 1) throw new Error('no focus');
+        return true;
+      }
+    });
+    const originalError = console.error;
+    console.error = () => {};
+    queue.push('a', { utterance: 1 });
+    queue.push('b', { utterance: 2 });
+    await queue.whenIdle();
+    console.error = originalError;
+    expect(attempts).toBe(2);
+    expect(queue.getStatus().failed).toBe(1);
+  });
+
+  test('merges corrections, letting backspaces cancel text not typed yet', async () => {
+    const calls = [];
+    let release;
+    const queue = new OutputQueue({
+      inject: (text, { backspaces }) => new Promise((resolve) => {
+        calls.push({ text, backspaces });
+        release = () => resolve(true);
+      })
+    });
+    queue.push('I want', { utterance: 1 });
+    queue.push(' to go', { utterance: 1 });
+    // "I want to go" -> "I wanted to go home", then the last 15 characters erased
+    queue.push('ed to go home', { utterance: 1, backspaces: 6 });
+    queue.push('', { utterance: 1, backspaces: 15 });
+    await tick();
+    release();
+    await tick();
+    release();
+    await queue.whenIdle();
+    expect(calls).toEqual([{ text: 'I want', backspaces: 0 }, { text: '', backspaces: 2 }]);
+  });
+
+  test('drops waiting text of a cancelled utterance', async () => {
+    const { calls, inject } = gatedInjector();
+    const queue = new OutputQueue({ inject });
+    queue.push('keep', { utterance: 1 });
+    queue.push('cancelled', { utterance: 2 });
+    queue.dropUtterance(2);
+    await tick();
+    calls[0].done();
+    await queue.whenIdle();
+    expect(calls.map(c => c.text)).toEqual(['keep']);
+  });
+});
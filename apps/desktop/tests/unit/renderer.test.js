@@ -63,6 +63,9 @@ describe('Renderer Tests', () => {
       onHotkeyRegistered: jest.fn(),
       onHotkeyError: jest.fn(),
       getHistory: jest.fn(() => Promise.resolve([])),
+      getHistoryPage: jest.fn(() => Promise.resolve({ items: [], total: 0, offset: 0, limit: 100 })),
+      getHistoryStats: jest.fn(() => Promise.resolve({ count: 0, words: 0, duration: 0 })),
+      updateHistoryItem: jest.fn(() => Promise.resolve(true)),
       clearHistory: jest.fn(() => Promise.resolve([])),
       onHistoryAppend: jest.fn(),
       copyToClipboard: jest.fn(),
@@ -168,7 +171,7 @@ describe('Renderer Tests', () => {
         { text: 'Test transcription 2', ts: Date.now() - 1000 }
       ];
 
-      mockIpcRenderer.getHistory.mockResolvedValue(mockHistory);
+      mockIpcRenderer.getHistoryPage.mockResolvedValue({ items: mockHistory, total: 2, offset: 0, limit: 100 });
 
       require('../../renderer.js');
 
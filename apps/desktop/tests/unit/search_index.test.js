@@ -0,0 +1,54 @@
+const { SearchIndex, tokenize, parseQuery } = require('../../src/search_index.js');
+
+function ids(result) {
+  return result.hits.map(hit => hit.id);
+}
+
+describe('Search Index Tests', () => {
+  test('tokenizes case- and accent-insensitively', () => {
+    expect(tokenize('Café, it\'s 2 PM!')).toEqual(['cafe', 'it', 's', '2', 'pm']);
+  });
+
+  test('splits quoted phrases from words', () => {
+    expect(parseQuery('meet "next tuesday" tom')).toEqual({ words: ['meet', 'tom'], phrases: [['next', 'tuesday']] });
+  });
+
+  test('matches every word as a prefix, newest first', () => {
+    const index = new SearchIndex();
+    index.add('history', 1, 'Meeting with Tom tomorrow', 100);
+    index.add('history', 2, 'Tomatoes for the meeting', 300);
+    index.add('notes', 'a', 'Call Tom about the budget', 200);
+    expect(ids(index.search('meet tom'))).toEqual([2, 1]);
+    expect(ids(index.search('tom'))).toEqual([2, 'a', 1]);
+    expect(index.search('tom', { kinds: ['notes'] }).total).toBe(1);
+  });
+
+  test('requires phrase words to be adjacent and in order', () => {
+    const index = new SearchIndex();
+    index.add('history', 1, 'see you next tuesday', 1);
+    index.add('history', 2, 'tuesday is next', 2);
+    expect(ids(index.search('"next tuesday"'))).toEqual([1]);
+    expect(index.search('"next friday"').total).toBe(0);
+  });
+
+  test('replaces and removes documents', () => {
+    const index = new SearchIndex();
+    index.add('snippets', 's1', 'old address', 1);
+    index.add('snippets', 's1', 'new address', 1);
+    expect(index.search('old').total).toBe(0);
+    expect(index.search('new').total).toBe(1);
+    index.remove('snippets', 's1');
+    expect(index.search('address').total).toBe(0);
+    expect(index.size).toBe(0);
+  });
+
+  test('pages results and survives compaction', () => {
+    const index = new SearchIndex();
+    for (let i = 0; i < 3000; i++) index.add('history', i, `entry ${i % 2 ? 'odd' : 'even'}`, i);
+    for (let i = 0; i < 2000; i++) index.remove('history', i);
+    const page = index.search('odd', { offset: 10, limit: 5 });
+    expect(page.total).toBe(500);
+    expect(ids(page)).toEqual([2979, 2977, 2975, 2973, 2971]);
+    expect(index.docs.length).toBe(1499); // compacted once 1501 of 3000 were dead
+  });
+});
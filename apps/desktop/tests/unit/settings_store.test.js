@@ -0,0 +1,75 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { SettingsStore } = require('../../src/settings_store.js');
+
+function tempSettings(contents) {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'sonu-settings-'));
+  const filePath = path.join(dir, 'settings.json');
+  if (contents) fs.writeFileSync(filePath, JSON.stringify(contents));
+  return { dir, filePath };
+}
+
+describe('Settings Store Tests', () => {
+  test('serves defaults and ignores values of the wrong type', () => {
+    const { dir, filePath } = tempSettings({ text_style: 'formal', preroll_ms: '500' });
+    const store = new SettingsStore({ filePath, defaults: { text_style: 'none', preroll_ms: 500, llm_processing: false } }).load();
+    expect(store.get('text_style')).toBe('formal');
+    expect(store.get('preroll_ms')).toBe(500);
+    expect(store.get('llm_processing')).toBe(false);
+    expect(store.get('model_download_path', null)).toBe(null);
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  test('batches writes and reports changed keys', async () => {
+    const { dir, filePath } = tempSettings();
+    const store = new SettingsStore({ filePath }).load();
+    const changes = [];
+    store.on('change', keys => changes.push(keys));
+    store.set({ text_style: 'casual' });
+    store.set({ text_style: 'casual', low_latency: true });
+    expect(changes).toEqual([['text_style'], ['low_latency']]);
+    expect(fs.existsSync(filePath)).toBe(false);
+    await store.flush();
+    expect(JSON.parse(fs.readFileSync(filePath, 'utf8'))).toEqual({ text_style: 'casual', low_latency: true });
+    expect(fs.existsSync(`${filePath}.tmp`)).toBe(false);
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  test('keeps keys another process wrote before the flush', async () => {
+    const { dir, filePath } = tempSettings({ text_style: 'none' });
+    const store = new SettingsStore({ filePath }).load();
+    store.set({ text_style: 'formal' });
+    fs.writeFileSync(filePath, JSON.stringify({ text_style: 'none', whisper_tuning: { small: { beam_size: 1 } } }));
+    await store.flush();
+    expect(JSON.parse(fs.readFileSync(filePath, 'utf8'))).toEqual({
+      text_style: 'formal',
+      whisper_tuning: { small: { beam_size: 1 } }
+    });
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  test('reloads external edits but not its own writes', async () => {
+    const { dir, filePath } = tempSettings({ continuous_dictation: false });
+    const store = new SettingsStore({ filePath }).load();
+    store.set({ text_style: 'formal' });
+    await store.flush();
+    expect(store.reload()).toEqual([]);
+    fs.writeFileSync(filePath, JSON.stringify({ continuous_dictation: true, text_style: 'formal' }));
+    const changes = [];
+    store.on('change', (keys, source) => changes.push([keys, source]));
+    expect(store.reload()).toEqual(['continuous_dictation']);
+    expect(store.get('continuous_dictation')).toBe(true);
+    expect(changes).toEqual([[['continuous_dictation'], 'external']]);
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  test('flushes synchronously on quit', () => {
+    const { dir, filePath } = tempSettings();
+    const store = new SettingsStore({ filePath }).load();
+    store.set({ widgetPosition: { x: 10, y: 20 } });
+    store.flushSync();
+    expect(JSON.parse(fs.readFileSync(filePath, 'utf8'))).toEqual({ widgetPosition: { x: 10, y: 20 } });
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+});
@@ -0,0 +1,57 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { TransformCache, normalizeTranscript } = require('../../src/transform_cache.js');
+
+const FORMAL = { engine: 'rules', style: 'formal', category: 'work' };
+
+describe('Transform Cache Tests', () => {
+  test('normalizes whitespace in transcripts', () => {
+    expect(normalizeTranscript('  thanks   so\nmuch ')).toBe('thanks so much');
+  });
+
+  test('returns cached transformations and counts hits', () => {
+    const cache = new TransformCache();
+    expect(cache.get('thanks so much', FORMAL)).toBeUndefined();
+    cache.set('thanks so much', FORMAL, 'Thanks so much.');
+    expect(cache.get(' thanks  so much', FORMAL)).toBe('Thanks so much.');
+    expect(cache.getStats()).toMatchObject({ size: 1, hits: 1, misses: 1, hitRate: 0.5 });
+  });
+
+  test('keys on engine, style and category', () => {
+    const cache = new TransformCache();
+    cache.set('see you', FORMAL, 'See you.');
+    expect(cache.get('see you', { ...FORMAL, style: 'casual' })).toBeUndefined();
+    expect(cache.get('see you', { ...FORMAL, engine: 'llm' })).toBeUndefined();
+    expect(cache.get('see you', { ...FORMAL, category: 'email' })).toBeUndefined();
+  });
+
+  test('evicts the least recently used entry', () => {
+    const cache = new TransformCache({ maxEntries: 2 });
+    cache.set('one', FORMAL, 'One.');
+    cache.set('two', FORMAL, 'Two.');
+    cache.get('one', FORMAL);
+    cache.set('three', FORMAL, 'Three.');
+    expect(cache.get('two', FORMAL)).toBeUndefined();
+    expect(cache.get('one', FORMAL)).toBe('One.');
+  });
+
+  test('skips long dictations', () => {
+    const cache = new TransformCache({ maxTextLength: 10 });
+    cache.set('this one is far too long', FORMAL, 'x');
+    expect(cache.getStats().size).toBe(0);
+  });
+
+  test('persists and reloads entries', () => {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'sonu-cache-'));
+    const persistPath = path.join(dir, 'transform-cache.json');
+    const cache = new TransformCache({ persistPath });
+    cache.set('sounds good', FORMAL, 'Sounds good.');
+    cache.save();
+
+    const reloaded = new TransformCache();
+    reloaded.setPersistPath(persistPath);
+    expect(reloaded.get('sounds good', FORMAL)).toBe('Sounds good.');
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+});
@@ -0,0 +1,67 @@
+const { encodeFrame, FrameDecoder, parseTextLine } = require('../../src/whisper_ipc.js');
+
+describe('Whisper IPC Tests', () => {
+  describe('Framed protocol', () => {
+    test('round-trips a message', () => {
+      const decoder = new FrameDecoder();
+      const message = { type: 'final', seq: 3, text: 'héllo wörld', request_id: 7 };
+      expect(decoder.push(encodeFrame(message))).toEqual([message]);
+    });
+
+    test('reassembles frames split across chunks', () => {
+      const decoder = new FrameDecoder();
+      const frame = encodeFrame({ type: 'partial', text: 'hello' });
+      expect(decoder.push(frame.subarray(0, 2))).toEqual([]);
+      expect(decoder.push(frame.subarray(2, 9))).toEqual([]);
+      expect(decoder.push(frame.subarray(9))).toEqual([{ type: 'partial', text: 'hello' }]);
+    });
+
+    test('returns every frame in one chunk', () => {
+      const decoder = new FrameDecoder();
+      const chunk = Buffer.concat([
+        encodeFrame({ type: 'event', name: 'RELEASE', args: [] }),
+        encodeFrame({ type: 'final', text: 'done' })
+      ]);
+      expect(decoder.push(chunk).map((m) => m.type)).toEqual(['event', 'final']);
+    });
+
+    test('skips a frame with a bad body and keeps the ones around it', () => {
+      const decoder = new FrameDecoder();
+      const bad = Buffer.from('{"type":');
+      const header = Buffer.alloc(4);
+      header.writeUInt32BE(bad.length, 0);
+      const chunk = Buffer.concat([
+        encodeFrame({ type: 'partial', text: 'a' }),
+        header, bad,
+        encodeFrame({ type: 'final', text: 'done' })
+      ]);
+      expect(decoder.push(chunk).map((m) => m.type)).toEqual(['partial', 'final']);
+      expect(decoder.skipped).toBe(1);
+      expect(decoder.error).toBe(null);
+    });
+
+    test('flags a corrupt stream but returns the frames decoded before it', () => {
+      const decoder = new FrameDecoder();
+      const chunk = Buffer.concat([
+        encodeFrame({ type: 'final', text: 'kept' }),
+        Buffer.from('stray print output\n')
+      ]);
+      expect(decoder.push(chunk)).toEqual([{ type: 'final', text: 'kept' }]);
+      expect(decoder.error).toBeTruthy();
+      // Nothing after the corruption can be trusted until the process is restarted
+      expect(decoder.push(encodeFrame({ type: 'final', text: 'lost' }))).toEqual([]);
+      decoder.reset();
+      expect(decoder.push(encodeFrame({ type: 'final', text: 'new' }))).toEqual([{ type: 'final', text: 'new' }]);
+    });
+  });
+
+  describe('Text protocol', () => {
+    test('parses partials, events and finals', () => {
+      expect(parseTextLine('PARTIAL: hello there')).toEqual({ type: 'partial', text: 'hello there' });
+      expect(parseTextLine('EVENT: CAPTURE_LATENCY 42.0 3.1')).toEqual({ type: 'event', name: 'CAPTURE_LATENCY', args: [42, 3.1] });
+      expect(parseTextLine('EVENT: CASCADE ON tiny 850')).toEqual({ type: 'event', name: 'CASCADE', args: ['ON', 'tiny', 850] });
+      expect(parseTextLine('Final text.')).toEqual({ type: 'final', text: 'Final text.' });
+      expect(parseTextLine('   ')).toBeNull();
+    });
+  });
+});
@@ -0,0 +1,446 @@
+#!/usr/bin/env python3
+"""
+Text injector for SONU
+Types text into the window that had focus when dictation started, through the X server's
+XTest extension, and confirms the keystrokes reached the server instead of sleeping and
+hoping focus has moved back. Also reports focus changes (_NET_ACTIVE_WINDOW) as they
+happen, for context detection
+"""
+
+import ctypes
+import ctypes.util
+import os
+import sys
+import threading
+import time
+
+from ipc_protocol import Channel, read_frame
+
+# X11 constants
+CURRENT_TIME = 0
+REVERT_TO_PARENT = 2
+NO_SYMBOL = 0
+POINTER_ROOT = 1
+XK_SHIFT_L = 0xFFE1
+PROPERTY_NOTIFY = 28
+PROPERTY_CHANGE_MASK = 1 << 22
+XA_STRING = 31
+XA_WM_NAME = 39
+XA_WM_CLASS = 67
+SPECIAL_KEYSYMS = {"\n": 0xFF0D, "\r": 0xFF0D, "\t": 0xFF09, "\b": 0xFF08}
+
+# Polling XGetInputFocus is a round trip of well under a millisecond
+FOCUS_POLL_S = 0.002
+FOCUS_TIMEOUT_MS = 500
+
+
+def keysym_for(char):
+    """X keysym for one character: Latin-1 maps 1:1, everything else is 0x01000000 + code point."""
+    if char in SPECIAL_KEYSYMS:
+        return SPECIAL_KEYSYMS[char]
+    code = ord(char)
+    if 0x20 <= code <= 0x7E or 0xA0 <= code <= 0xFF:
+        return code
+    return 0x01000000 | code
+
+
+def parse_wm_class(raw):
+    """WM_CLASS is ``instance\\0class\\0``; the class ("Slack", "Thunderbird") names the app."""
+    parts = [p for p in raw.decode("utf-8", "replace").split("\0") if p]
+    return parts[-1] if parts else ""
+
+
+class XTestUnavailable(Exception):
+    pass
+
+
+class XPropertyEvent(ctypes.Structure):
+    _fields_ = [("type", ctypes.c_int), ("serial", ctypes.c_ulong), ("send_event", ctypes.c_int),
+                ("display", ctypes.c_void_p), ("window", ctypes.c_ulong), ("atom", ctypes.c_ulong),
+                ("time", ctypes.c_ulong), ("state", ctypes.c_int)]
+
+
+class XEvent(ctypes.Union):
+    _fields_ = [("type", ctypes.c_int), ("xproperty", XPropertyEvent), ("pad", ctypes.c_long * 24)]
+
+
+# Xlib's default handler exits the process on any error, e.g. a window that closed
+# between the focus event and our property read
+X_ERROR_HANDLER = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p)
+_ignore_x_errors = X_ERROR_HANDLER(lambda display, event: 0)
+
+
+class XTestBackend:
+    """Fake key events through libXtst on the session's X display.
+
+    Characters the current layout has no key for are typed by temporarily
+    binding their keysym to a spare keycode, the way xdotool does.
+    """
+
+    def __init__(self, display_name=None):
+        display_name = display_name or os.environ.get("DISPLAY")
+        if not display_name:
+            raise XTestUnavailable("no X display (Wayland-only session?)")
+        x11_path = ctypes.util.find_library("X11")
+        xtst_path = ctypes.util.find_library("Xtst")
+        if not x11_path or not xtst_path:
+            raise XTestUnavailable("libX11/libXtst not installed")
+        self.x11 = ctypes.CDLL(x11_path)
+        # The focus watcher uses Xlib from a second thread (on its own connection)
+        self.x11.XInitThreads()
+        self.xtst = ctypes.CDLL(xtst_path)
+        self._declare()
+        self.x11.XSetErrorHandler(_ignore_x_errors)
+        self.display_name = display_name
+        self.display = self.x11.XOpenDisplay(display_name.encode())
+        if not self.display:
+            raise XTestUnavailable(f"cannot open display {display_name}")
+        dummy = ctypes.c_int()
+        if not self.xtst.XTestQueryExtension(self.display, ctypes.byref(dummy), ctypes.byref(dummy),
+                                             ctypes.byref(dummy), ctypes.byref(dummy)):
+            self.close()
+            raise XTestUnavailable("XTest extension missing")
+        self.shift = self.x11.XKeysymToKeycode(self.display, XK_SHIFT_L)
+        self.keys = {}  # keysym -> (keycode, needs shift)
+        self.scratch = 0
+        self.load_keymap()
+
+    def _declare(self):
+        x11, xtst = self.x11, self.xtst
+        x11.XOpenDisplay.restype = ctypes.c_void_p
+        x11.XOpenDisplay.argtypes = [ctypes.c_char_p]
+        x11.XCloseDisplay.argtypes = [ctypes.c_void_p]
+        x11.XSync.argtypes = [ctypes.c_void_p, ctypes.c_int]
+        x11.XFlush.argtypes = [ctypes.c_void_p]
+        x11.XGetInputFocus.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_ulong), ctypes.POINTER(ctypes.c_int)]
+        x11.XSetInputFocus.argtypes = [ctypes.c_void_p, ctypes.c_ulong, ctypes.c_int, ctypes.c_ulong]
+        x11.XQueryTree.argtypes = [ctypes.c_void_p, ctypes.c_ulong, ctypes.POINTER(ctypes.c_ulong),
+                                   ctypes.POINTER(ctypes.c_ulong), ctypes.POINTER(ctypes.POINTER(ctypes.c_ulong)),
+                                   ctypes.POINTER(ctypes.c_uint)]
+        x11.XKeysymToKeycode.restype = ctypes.c_ubyte
+        x11.XKeysymToKeycode.argtypes = [ctypes.c_void_p, ctypes.c_ulong]
+        x11.XDisplayKeycodes.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_int), ctypes.POINTER(ctypes.c_int)]
+        x11.XGetKeyboardMapping.restype = ctypes.POINTER(ctypes.c_ulong)
+        x11.XGetKeyboardMapping.argtypes = [ctypes.c_void_p, ctypes.c_ubyte, ctypes.c_int, ctypes.POINTER(ctypes.c_int)]
+        x11.XChangeKeyboardMapping.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int,
+                                               ctypes.POINTER(ctypes.c_ulong), ctypes.c_int]
+        x11.XFree.argtypes = [ctypes.c_void_p]
+        x11.XSetErrorHandler.argtypes = [X_ERROR_HANDLER]
+        x11.XDefaultRootWindow.restype = ctypes.c_ulong
+        x11.XDefaultRootWindow.argtypes = [ctypes.c_void_p]
+        x11.XInternAtom.restype = ctypes.c_ulong
+        x11.XInternAtom.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int]
+        x11.XSelectInput.argtypes = [ctypes.c_void_p, ctypes.c_ulong, ctypes.c_long]
+        x11.XNextEvent.argtypes = [ctypes.c_void_p, ctypes.POINTER(XEvent)]
+        x11.XGetWindowProperty.argtypes = [
+            ctypes.c_void_p, ctypes.c_ulong, ctypes.c_ulong, ctypes.c_long, ctypes.c_long, ctypes.c_int,
+            ctypes.c_ulong, ctypes.POINTER(ctypes.c_ulong), ctypes.POINTER(ctypes.c_int),
+            ctypes.POINTER(ctypes.c_ulong), ctypes.POINTER(ctypes.c_ulong),
+            ctypes.POINTER(ctypes.POINTER(ctypes.c_ubyte))]
+        xtst.XTestQueryExtension.argtypes = [ctypes.c_void_p] + [ctypes.POINTER(ctypes.c_int)] * 4
+        xtst.XTestFakeKeyEvent.argtypes = [ctypes.c_void_p, ctypes.c_uint, ctypes.c_int, ctypes.c_ulong]
+
+    def load_keymap(self):
+        """Keysyms reachable from the current layout, plus a keycode with nothing bound."""
+        low, high = ctypes.c_int(), ctypes.c_int()
+        self.x11.XDisplayKeycodes(self.display, ctypes.byref(low), ctypes.byref(high))
+        count = high.value - low.value + 1
+        per = ctypes.c_int()
+        mapping = self.x11.XGetKeyboardMapping(self.display, low.value, count, ctypes.byref(per))
+        if not mapping:
+            return
+        try:
+            self.keys = {}
+            self.scratch = 0
+            for i in range(count):
+                keycode = low.value + i
+                syms = [mapping[i * per.value + j] for j in range(per.value)]
+                if not any(syms):
+                    self.scratch = keycode  # the highest empty one, least likely to be wanted
+                for level, keysym in enumerate(syms[:2]):
+                    if keysym and keysym not in self.keys:
+                        self.keys[keysym] = (keycode, level == 1)
+        finally:
+            self.x11.XFree(mapping)
+
+    def focused_window(self):
+        window = ctypes.c_ulong()
+        revert = ctypes.c_int()
+        self.x11.XGetInputFocus(self.display, ctypes.byref(window), ctypes.byref(revert))
+        return window.value
+
+    def within(self, window, ancestor):
+        """True if ``window`` is ``ancestor`` or one of its descendants.
+
+        Focus often sits on a child of the toplevel client (toolkit focus proxies,
+        Java), while _NET_ACTIVE_WINDOW names the client itself.
+        """
+        root, parent = ctypes.c_ulong(), ctypes.c_ulong()
+        children = ctypes.POINTER(ctypes.c_ulong)()
+        count = ctypes.c_uint()
+        while window > POINTER_ROOT:
+            if window == ancestor:
+                return True
+            if not self.x11.XQueryTree(self.display, window, ctypes.byref(root), ctypes.byref(parent),
+                                       ctypes.byref(children), ctypes.byref(count)):
+                return False
+            if children:
+                self.x11.XFree(children)
+            if parent.value == root.value:
+                return False
+            window = parent.value
+        return False
+
+    def set_focus(self, window):
+        self.x11.XSetInputFocus(self.display, window, REVERT_TO_PARENT, CURRENT_TIME)
+        self.x11.XFlush(self.display)
+
+    def _tap(self, keycode, shift):
+        fake = self.xtst.XTestFakeKeyEvent
+        if shift:
+            fake(self.display, self.shift, 1, CURRENT_TIME)
+        fake(self.display, keycode, 1, CURRENT_TIME)
+        fake(self.display, keycode, 0, CURRENT_TIME)
+        if shift:
+            fake(self.display, self.shift, 0, CURRENT_TIME)
+
+    def _bind_scratch(self, keysym):
+        syms = (ctypes.c_ulong * 1)(keysym)
+        self.x11.XChangeKeyboardMapping(self.display, self.scratch, 1, syms, 1)
+        # Clients must see the new mapping before the key event that uses it
+        self.x11.XSync(self.display, 0)
+
+    def type_text(self, text):
+        """Send every character; returns how many could not be typed."""
+        skipped = 0
+        bound = None
+        try:
+            for char in text:
+                keysym = keysym_for(char)
+                key = self.keys.get(keysym)
+                if key:
+                    self._tap(*key)
+                    continue
+                if not self.scratch:
+                    skipped += 1
+                    continue
+                if bound != keysym:
+                    self._bind_scratch(keysym)
+                    bound = keysym
+                self._tap(self.scratch, False)
+                # Held until the server has the events, or a rebind could overtake them
+                self.x11.XSync(self.display, 0)
+        finally:
+            if bound is not None:
+                self._bind_scratch(NO_SYMBOL)
+        return skipped
+
+    def sync(self):
+        """Round trip to the server: every queued event has been processed when this returns."""
+        self.x11.XSync(self.display, 0)
+
+    def close(self):
+        if self.display:
+            self.x11.XCloseDisplay(self.display)
+            self.display = None
+
+
+class ActiveWindowWatcher:
+    """Calls ``on_change({window, app, title})`` whenever the active window or its title changes.
+
+    Event driven: the root window's ``_NET_ACTIVE_WINDOW`` and the active
+    window's title properties are watched on a connection of its own, on a
+    daemon thread, so nothing is polled and the injector's requests never wait
+    on it. Window managers without EWMH never send the event; nothing is reported.
+    """
+
+    def __init__(self, x11, display_name, on_change):
+        self.x11 = x11
+        self.display_name = display_name
+        self.on_change = on_change
+        self.display = None
+        self.active = 0
+        self.last = None
+
+    def start(self):
+        self.display = self.x11.XOpenDisplay(self.display_name.encode())
+        if not self.display:
+            return False
+        threading.Thread(target=self._run, name="focus-watch", daemon=True).start()
+        return True
+
+    def _atom(self, name):
+        return self.x11.XInternAtom(self.display, name, 0)
+
+    def _property(self, window, atom, length=1024):
+        """Raw bytes of a window property, or None."""
+        actual_type = ctypes.c_ulong()
+        actual_format = ctypes.c_int()
+        nitems = ctypes.c_ulong()
+        after = ctypes.c_ulong()
+        data = ctypes.POINTER(ctypes.c_ubyte)()
+        status = self.x11.XGetWindowProperty(
+            self.display, window, atom, 0, length, 0, 0, ctypes.byref(actual_type),
+            ctypes.byref(actual_format), ctypes.byref(nitems), ctypes.byref(after), ctypes.byref(data))
+        if status != 0 or not data:
+            return None
+        try:
+            if actual_format.value == 32:
+                # Format-32 items are C longs, whatever their size
+                return bytes(ctypes.string_at(data, nitems.value * ctypes.sizeof(ctypes.c_long)))
+            return bytes(ctypes.string_at(data, nitems.value * (actual_format.value // 8)))
+        finally:
+            self.x11.XFree(data)
+
+    def _active_window(self):
+        raw = self._property(self.root, self.net_active, 1)
+        if not raw:
+            return 0
+        return ctypes.c_ulong.from_buffer_copy(raw[:ctypes.sizeof(ctypes.c_ulong)]).value
+
+    def describe(self, window):
+        if not window:
+            return {"window": 0, "app": "", "title": ""}
+        title = self._property(window, self.net_wm_name) or self._property(window, XA_WM_NAME) or b""
+        return {
+            "window": window,
+            "app": parse_wm_class(self._property(window, XA_WM_CLASS) or b""),
+            "title": title.decode("utf-8", "replace"),
+        }
+
+    def report(self, info):
+        if info != self.last:
+            self.last = info
+            self.on_change(info)
+
+    def _follow(self, window):
+        """Watch the new active window's title instead of the old one's."""
+        if self.active:
+            self.x11.XSelectInput(self.display, self.active, 0)
+        self.active = window
+        if window:
+            self.x11.XSelectInput(self.display, window, PROPERTY_CHANGE_MASK)
+
+    def _run(self):
+        self.root = self.x11.XDefaultRootWindow(self.display)
+        self.net_active = self._atom(b"_NET_ACTIVE_WINDOW")
+        self.net_wm_name = self._atom(b"_NET_WM_NAME")
+        self.x11.XSelectInput(self.display, self.root, PROPERTY_CHANGE_MASK)
+        self._follow(self._active_window())
+        self.report(self.describe(self.active))
+        event = XEvent()
+        while True:
+            self.x11.XNextEvent(self.display, ctypes.byref(event))
+            if event.type != PROPERTY_NOTIFY:
+                continue
+            changed = event.xproperty
+            if changed.window == self.root and changed.atom == self.net_active:
+                window = self._active_window()
+                if window != self.active:
+                    self._follow(window)
+                self.report(self.describe(window))
+            elif changed.window == self.active and changed.atom in (self.net_wm_name, XA_WM_NAME):
+                self.report(self.describe(self.active))
+
+
+class TextInjector:
+    """Serves ``{id, op, args}`` requests one at a time, in arrival order.
+
+    ``focus`` reports the focused window. ``type`` takes ``text``, an optional
+    number of ``backspaces`` to press first (corrections), and either the
+    ``window`` to type into or the ``avoid`` list of SONU's own windows; it
+    waits for focus to land (bounded by ``timeout_ms``) instead of a fixed
+    sleep, types, and answers once the X server has processed the events.
+    """
+
+    def __init__(self, backend, respond, clock=time.monotonic, sleep=time.sleep):
+        self.backend = backend
+        self._respond = respond
+        self._clock = clock
+        self._sleep = sleep
+        self.stats = {"typed": 0, "chars": 0, "focus_waits": 0, "focus_timeouts": 0}
+
+    def wait_focus(self, window=0, avoid=(), timeout_ms=FOCUS_TIMEOUT_MS):
+        """True once ``window`` or a child of it (without one, anything outside ``avoid``) has focus."""
+        within = self.backend.within
+        if window and not within(self.backend.focused_window(), window):
+            self.backend.set_focus(window)
+        deadline = self._clock() + timeout_ms / 1000.0
+        waited = False
+        while True:
+            focused = self.backend.focused_window()
+            if window:
+                ready = within(focused, window)
+            else:
+                ready = focused > POINTER_ROOT and not any(within(focused, own) for own in avoid)
+            if ready:
+                if waited:
+                    self.stats["focus_waits"] += 1
+                return True
+            if self._clock() >= deadline:
+                self.stats["focus_timeouts"] += 1
+                return False
+            waited = True
+            self._sleep(FOCUS_POLL_S)
+
+    def handle(self, request_id, op, args=None):
+        args = args or {}
+        started = time.perf_counter()
+        try:
+            if op == "focus":
+                fields = {"ok": True, "result": {"window": self.backend.focused_window()}}
+            elif op == "type":
+                fields = self._type(args)
+            elif op == "stats":
+                fields = {"ok": True, "result": dict(self.stats)}
+            else:
+                fields = {"ok": False, "error": "unknown_op"}
+        except Exception as e:
+            fields = {"ok": False, "error": f"{type(e).__name__}: {e}"}
+        ms = round((time.perf_counter() - started) * 1000.0, 3)
+        self._respond(request_id, ms=ms, **fields)
+
+    def _type(self, args):
+        text = args.get("text") or ""
+        backspaces = max(0, int(args.get("backspaces") or 0))
+        window = int(args.get("window") or 0)
+        avoid = {int(w) for w in args.get("avoid") or ()}
+        if not self.wait_focus(window, avoid, args.get("timeout_ms", FOCUS_TIMEOUT_MS)):
+            return {"ok": False, "error": "focus_timeout"}
+        # One batch: the erase and the retype reach the window together
+        skipped = self.backend.type_text("\b" * backspaces + text)
+        self.backend.sync()
+        self.stats["typed"] += 1
+        self.stats["chars"] += len(text) - skipped
+        return {"ok": True, "result": {"delivered": len(text) - skipped, "skipped": skipped,
+                                       "backspaces": backspaces}}
+
+
+def main():
+    channel = Channel(framed=True)
+    try:
+        backend = XTestBackend()
+    except (XTestUnavailable, OSError) as e:
+        channel.event("UNAVAILABLE", reason=str(e))
+        return
+    injector = TextInjector(backend, lambda request_id, **fields: channel.send("result", id=request_id, **fields))
+    channel.event("READY")
+    watcher = ActiveWindowWatcher(backend.x11, backend.display_name, lambda info: channel.event("FOCUS", **info))
+    if not watcher.start():
+        sys.stderr.write("Focus watcher unavailable: cannot open a second display connection\n")
+        sys.stderr.flush()
+    while True:
+        try:
+            message = read_frame(sys.stdin.buffer)
+        except ValueError as e:
+            sys.stderr.write(f"ERROR: bad frame: {e}\n")
+            sys.stderr.flush()
+            break
+        if message is None:
+            break  # main.js closed stdin
+        injector.handle(message.get("id"), message.get("op"), message.get("args"))
+    backend.close()
+
+
+if __name__ == "__main__":
+    main()
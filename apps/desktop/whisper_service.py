@@ -1,13 +1,20 @@
+import gc
 import sys
 import threading
 import time
-import wave
 import os
-import tempfile
 
 import numpy as np
 import keyboard
 
+from audio_buffer import PcmRingBuffer
+from streaming_decoder import LocalAgreementDecoder
+from inference_scheduler import InferenceScheduler, PRIORITY_FINAL, PRIORITY_PARTIAL, PRIORITY_BACKGROUND
+from decode_profiles import DECODE_PROFILES, DEFAULT_PROFILES, LatencyGovernor, decode_options
+from system_utils import plan_cascade, load_tuning
+from ipc_protocol import Channel, monotonic_ms, read_commands
+from cpu_budget import apply_affinity, capped_threads, thread_budget
+
 # Optional: pynput for typing (alternative to robotjs)
 try:
     from pynput.keyboard import Controller as KeyboardController
@@ -32,40 +39,120 @@ except Exception as e:
     raise
 
 
+# "framed": length-prefixed JSON messages with request IDs and timestamps (used by main.js);
+# "text": the legacy PARTIAL:/EVENT:/bare-text line protocol
+IPC_FRAMED = os.environ.get("SONU_IPC", "text").lower() == "framed"
+ipc = Channel(framed=IPC_FRAMED)
+
 CHUNK = 1024
 FORMAT = pyaudio.paInt16
 CHANNELS = 1
 RATE = 16000
 
+# Capture ring: 30 s of float32 audio shared lock-free between capture and inference.
+# Longer recordings spill into a reusable arena (disable with SONU_AUDIO_SPILL=0).
+RING_SECONDS = 30
+AUDIO_SPILL = os.environ.get("SONU_AUDIO_SPILL", "1") != "0"
+# Audio kept from before START so the first syllable survives hotkey/IPC delays
+# (0 disables pre-roll; adjustable at runtime with SET_PREROLL_MS)
+MAX_PREROLL_MS = 2000
+preroll_ms = max(0, min(MAX_PREROLL_MS, int(os.environ.get("SONU_PREROLL_MS", "500"))))
+
 recording_flag = False
-frames = []
+pcm_ring = PcmRingBuffer(RING_SECONDS, RATE, spill=AUDIO_SPILL)
 audio = pyaudio.PyAudio()
 stream = None
 lock = threading.Lock()
 last_partial_text = ""
 
+# "callback" lets PortAudio push audio into the service; "blocking" keeps a reader thread
+CAPTURE_MODE = os.environ.get("SONU_CAPTURE_MODE", "callback").lower()
+# Signalled on START/STOP so idle threads sleep instead of polling
+recording_changed = threading.Condition(lock)
+# Signalled for every captured chunk while recording
+audio_available = threading.Condition()
+start_requested_at = None
+start_hotkey_ms = None
+first_sample_at = None
+utterance_id = 0  # bumped on every START so stale partials can be dropped
+utterance_request_id = None  # request ID of the START that began the current utterance
+utterance_times = {}  # monotonic ms: start, first_sample, stop, decode_start, decode_end
+# Cleared while a hold-release final decodes the ring and streamer; START waits for it
+final_idle = threading.Event()
+final_idle.set()
+
+# "streaming": partials extend a committed prefix and the final only decodes the
+# uncommitted tail; "window": re-decode the last 5 s per partial and everything at the end
+decoder_mode = os.environ.get("SONU_DECODER", "streaming").lower()
+
+# Set by main.js while typing lags behind (SET_OUTPUT_BUSY): partials are held so the
+# typer only has the backlog to catch up on; finals are never held
+output_busy = False
+
+# Named decode profile per role ("partial"/"final"); see decode_profiles.py
+decode_profiles = {
+    role: os.environ.get(f"SONU_{role.upper()}_PROFILE", default).lower()
+    for role, default in DEFAULT_PROFILES.items()
+}
+for role, name in decode_profiles.items():
+    if name not in DECODE_PROFILES:
+        decode_profiles[role] = DEFAULT_PROFILES[role]
+# Sizes partial beam width and cadence to this machine's real-time factor
+governor = LatencyGovernor()
+governor.enabled = os.environ.get("SONU_GOVERNOR", "1") != "0"
+
 model_size = os.environ.get("WHISPER_MODEL", "base")
 
+# Per-model config measured by `system_utils.py tune` (SONU_TUNING=0 uses library defaults)
+use_tuning = os.environ.get("SONU_TUNING", "1") != "0"
+
+# CPU budget from main.js (src/cpu_budget.js): decode threads (0 = library default) and,
+# on Linux, the cores this process may run on
+WHISPER_THREADS = thread_budget("SONU_WHISPER_THREADS")
+apply_affinity()
+
+
+def create_model(name):
+    """WhisperModel for ``name`` with this host's tuned compute type and thread count.
+
+    The tuned thread count was measured with the machine to itself, so it is
+    capped by the budget main.js assigns (SONU_WHISPER_THREADS).
+    """
+    tuning = load_tuning(name) if use_tuning else None
+    if not tuning:
+        if WHISPER_THREADS:
+            return WhisperModel(name, device="cpu", cpu_threads=WHISPER_THREADS)
+        return WhisperModel(name, device="cpu")
+    threads = capped_threads(tuning["cpu_threads"], WHISPER_THREADS)
+    sys.stderr.write(f"Using tuned config for '{name}': {tuning['compute_type']}, "
+                     f"{threads} threads\n")
+    sys.stderr.flush()
+    return WhisperModel(name, device="cpu", compute_type=tuning["compute_type"],
+                        cpu_threads=threads)
+
 # Pre-load model immediately on startup for instant dictation (like Wispr Flow)
 # This ensures zero delay on first hotkey press
 try:
     sys.stderr.write(f"Loading Whisper model '{model_size}'...\n")
     sys.stderr.flush()
-    model = WhisperModel(model_size, device="cpu")
+    model = create_model(model_size)
     sys.stderr.write(f"✓ Whisper model '{model_size}' loaded successfully\n")
     sys.stderr.flush()
     # Send READY event to Electron immediately after model loads
-    sys.stdout.write("EVENT: READY\n")
-    sys.stdout.flush()
+    ipc.event("READY", model=model_size)
 except Exception as e:
     sys.stderr.write(f"✗ Failed to load Whisper model: {e}\n")
     sys.stderr.write("Please ensure faster-whisper is installed: pip install faster-whisper\n")
     sys.stderr.flush()
     # Send ERROR event to Electron
-    sys.stdout.write("EVENT: ERROR\n")
-    sys.stdout.flush()
+    ipc.event("ERROR", model=model_size, error=str(e))
     raise
 
+# Opt-in cascade: a resident draft model drives PARTIAL events while `model` produces finals
+cascade_requested = os.environ.get("SONU_CASCADE", "0") == "1"
+draft_model = None
+draft_loading = threading.Lock()
+
 hold_mode = False
 hold_keys_combo = "ctrl+shift+space"  # python keyboard combo string
 combo_keys = ['ctrl', 'shift', 'space']
@@ -117,7 +204,12 @@ def start_stream():
         return
     try:
         # Start stream immediately for instant recording (like Wispr Flow)
-        stream = audio.open(format=FORMAT, channels=CHANNELS, rate=RATE, input=True, frames_per_buffer=CHUNK)
+        if CAPTURE_MODE == "callback":
+            # PortAudio pushes chunks into the ring from its own thread - nothing polls
+            stream = audio.open(format=FORMAT, channels=CHANNELS, rate=RATE, input=True,
+                                frames_per_buffer=CHUNK, stream_callback=capture_callback)
+        else:
+            stream = audio.open(format=FORMAT, channels=CHANNELS, rate=RATE, input=True, frames_per_buffer=CHUNK)
         stream.start_stream()
         # Stream is now ready for instant recording
     except Exception as e:
@@ -134,14 +226,158 @@ def stop_stream():
         stream = None
 
 
+def set_recording(active, hotkey_ms=None, request_id=None):
+    """Flip the recording flag and wake every thread waiting for a state change."""
+    global recording_flag, start_requested_at, start_hotkey_ms, first_sample_at, utterance_id
+    global utterance_request_id, utterance_times
+    if not active:
+        # Freeze the utterance end; the ring keeps filling as pre-roll for the next one
+        pcm_ring.mark_stop()
+    with recording_changed:
+        if recording_flag and not active:
+            utterance_times["stop"] = monotonic_ms()
+        recording_flag = active
+        if active:
+            utterance_id += 1
+            utterance_request_id = request_id
+            utterance_times = {"start": monotonic_ms()}
+            start_requested_at = time.time()
+            start_hotkey_ms = hotkey_ms
+            first_sample_at = None
+        recording_changed.notify_all()
+    with audio_available:
+        audio_available.notify_all()
+
+
+def note_captured_chunk(data):
+    """Store one captured chunk and wake the release watcher. Runs on the capture thread."""
+    global first_sample_at
+    pcm_ring.write_int16(data)
+    if first_sample_at is None:
+        first_sample_at = time.time()
+        utterance_times["first_sample"] = monotonic_ms()
+    with audio_available:
+        audio_available.notify()
+
+
+def capture_callback(in_data, frame_count, time_info, status):
+    if recording_flag:
+        note_captured_chunk(in_data)
+    elif preroll_ms:
+        # Idle: keep the pre-roll history warm without waking anyone
+        pcm_ring.write_int16(in_data)
+    return (None, pyaudio.paContinue)
+
+
+def begin_recording(hotkey_ms=None, request_id=None):
+    """Start a new utterance once any hold-release final has finished with the ring and streamer."""
+    final_idle.wait()
+    # Ensure stream is started
+    start_stream()
+    # Seed the recording with the pre-roll captured before the hotkey reached us
+    pcm_ring.mark_start(backfill=preroll_ms * RATE // 1000)
+    streamer.reset(pcm_ring.recording_start)
+    with lock:
+        globals()['last_partial_text'] = ""
+    set_recording(True, hotkey_ms, request_id)
+
+
+def report_capture_latency():
+    """Emit hotkey-to-first-sample latency once per recording."""
+    global start_requested_at
+    with lock:
+        requested_at = start_requested_at
+        hotkey_ms = start_hotkey_ms
+        first_at = first_sample_at
+        if requested_at is None or first_at is None:
+            return
+        start_requested_at = None
+    start_ms = (first_at - requested_at) * 1000.0
+    # Hotkey timestamp comes from Electron's wall clock; without it report START-to-sample only
+    hotkey_latency = (first_at * 1000.0 - hotkey_ms) if hotkey_ms else -1
+    sys.stderr.write(f"Capture latency: hotkey->first sample {hotkey_latency:.1f} ms, START->first sample {start_ms:.1f} ms\n")
+    sys.stderr.flush()
+    try:
+        ipc.event("CAPTURE_LATENCY", float(hotkey_latency), float(start_ms),
+                  request_id=utterance_request_id, utterance=utterance_id)
+    except Exception:
+        pass
+
+
+def finish_hold_recording():
+    """Key combo released in hold mode: stop, notify Electron and emit the final text."""
+    # A START arriving meanwhile would re-mark the ring and reset the streamer under the final
+    final_idle.clear()
+    try:
+        set_recording(False)
+        # Notify Electron IMMEDIATELY so UI can hide instantly on release
+        # This must happen BEFORE any transcription delay
+        try:
+            ipc.event("RELEASE", request_id=utterance_request_id, utterance=utterance_id)
+        except Exception:
+            pass
+        # Minimal delay to capture final audio chunk (reduced from 0.1s to 0.05s)
+        time.sleep(0.05)
+        emit_final()
+    finally:
+        final_idle.set()
+
+
+def emit_final(request_id=None):
+    """Decode the utterance that just ended and send the final text with its metadata."""
+    meta = {}
+    text = final_transcript(meta)
+    # Fallback to last partial if final transcription is empty
+    if not text:
+        try:
+            with lock:
+                text = last_partial_text
+        except Exception:
+            pass
+    with lock:
+        globals()['last_partial_text'] = ""
+    if text:
+        ipc.final(
+            text,
+            request_id=utterance_request_id,
+            stop_request_id=request_id,
+            utterance=utterance_id,
+            audio_ms=round(pcm_ring.recording_length() * 1000 / RATE),
+            times=dict(utterance_times),
+            **meta
+        )
+
+
+def check_hold_release():
+    # If in hold mode, stop when key combo is released
+    try:
+        report_capture_latency()
+        if hold_mode and recording_flag and not combo_pressed():
+            # Release detected -> stop immediately
+            finish_hold_recording()
+    except Exception as e:
+        sys.stderr.write(f"Release detection error: {e}\n")
+        sys.stderr.flush()
+
+
+def release_watch_loop():
+    """Callback mode: sleep until a chunk arrives, then check the hold combo once per chunk."""
+    while True:
+        with audio_available:
+            while not recording_flag:
+                audio_available.wait()
+            audio_available.wait()
+        check_hold_release()
+
+
 def audio_capture_loop():
-  global frames
-  while True:
-        with lock:
-            active = recording_flag
-        if not active:
-            time.sleep(0.001)  # Minimal sleep for fastest response
-            continue
+    """Blocking mode fallback: read the stream on this thread while recording."""
+    while True:
+        if not recording_flag and not preroll_ms:
+            # Sleep until START instead of polling the flag
+            with recording_changed:
+                while not recording_flag and not preroll_ms:
+                    recording_changed.wait()
         try:
             data = stream.read(CHUNK, exception_on_overflow=False)
         except Exception as e:
@@ -149,116 +385,260 @@ def audio_capture_loop():
             sys.stderr.flush()
             time.sleep(0.05)
             continue
-        with lock:
-            frames.append(data)
+        if not recording_flag:
+            pcm_ring.write_int16(data)
+            continue
+        note_captured_chunk(data)
+        check_hold_release()
+
+
+def model_for(role):
+    draft = draft_model
+    if role == "partial" and draft is not None:
+        return draft
+    return model
+
+
+def load_draft_model():
+    """Load the cascade draft model off the inference worker, if the memory plan allows it."""
+    global draft_model
+    if not draft_loading.acquire(blocking=False):
+        return  # already loading
+    try:
+        _load_draft_model()
+    finally:
+        draft_loading.release()
+
 
-        # If in hold mode, stop when key combo is released
+def _load_draft_model():
+    global draft_model
+    plan = plan_cascade(model_size)
+    if not plan["enabled"]:
+        sys.stderr.write(f"Cascade disabled: {plan['reason']}\n")
+        sys.stderr.flush()
+        ipc.event("CASCADE", "OFF")
+        return
+    try:
+        draft = draft_model or create_model(plan["draft"])
+    except Exception as e:
+        sys.stderr.write(f"✗ Failed to load draft model '{plan['draft']}': {e}\n")
+        sys.stderr.flush()
+        ipc.event("CASCADE", "OFF")
+        return
+    if not cascade_requested:
+        return  # switched off while loading
+    draft_model = draft
+    # Partial timings so far were measured on the other model
+    governor.reset()
+    sys.stderr.write(f"✓ Cascade on: {plan['reason']}\n")
+    sys.stderr.flush()
+    # Resident memory of both models, in MB
+    ipc.event("CASCADE", "ON", plan["draft"], plan["draft_mb"] + plan["final_mb"])
+
+
+def set_cascade(active):
+    global cascade_requested, draft_model
+    cascade_requested = active
+    if active:
+        if draft_model is None:
+            threading.Thread(target=load_draft_model, daemon=True).start()
+        return
+    if draft_model is not None:
+        # Dropping the reference frees the draft model's memory
+        draft_model = None
+        governor.reset()
+        ipc.event("CASCADE", "OFF")
+
+
+model_loading = threading.Lock()
+
+
+def load_model(name):
+    """Load ``name`` while the current model keeps serving, then swap it in (LOAD_MODEL)."""
+    global model, model_size
+    with model_loading:
+        if name == model_size:
+            ipc.event("READY", model=name)
+            return
         try:
-            with lock:
-                hm = hold_mode
-            if hm and active:
-                if not combo_pressed():
-                    # Release detected -> stop immediately
-                    with lock:
-                        globals()['recording_flag'] = False
-                    # Notify Electron IMMEDIATELY so UI can hide instantly on release
-                    # This must happen BEFORE any transcription delay
-                    try:
-                        sys.stdout.write("EVENT: RELEASE\n")
-                        sys.stdout.flush()
-                    except Exception:
-                        pass
-                    # Minimal delay to capture final audio chunk (reduced from 0.1s to 0.05s)
-                    time.sleep(0.05)
-                    text = transcribe_frames()
-                    # Fallback to last partial if final transcription is empty
-                    if not text:
-                        try:
-                            with lock:
-                                text = last_partial_text
-                        except Exception:
-                            pass
-                    with lock:
-                        frames = []
-                        globals()['frames'] = frames
-                        globals()['last_partial_text'] = ""
-                    if text:
-                        sys.stdout.write(text + "\n")
-                        sys.stdout.flush()
+            sys.stderr.write(f"Loading Whisper model '{name}'...\n")
+            sys.stderr.flush()
+            new_model = create_model(name)
         except Exception as e:
-            sys.stderr.write(f"Release detection error: {e}\n")
+            sys.stderr.write(f"✗ Failed to load Whisper model '{name}': {e}\n")
             sys.stderr.flush()
+            # The previous model is still loaded and serving
+            ipc.event("LOAD_FAILED", name, error=str(e))
+            return
+        with lock:
+            # Decodes already running keep their reference to the old model
+            old_model = model
+            model = new_model
+            model_size = name
+        del old_model
+        gc.collect()
+        # Timings so far were measured on the old model
+        governor.reset()
+        if draft_model is not None and not plan_cascade(name)["enabled"]:
+            set_cascade(False)
+        sys.stderr.write(f"✓ Whisper model '{name}' loaded successfully\n")
+        sys.stderr.flush()
+        ipc.event("READY", model=name)
+        inference.submit(PRIORITY_BACKGROUND, warm_up_model)
 
 
-def transcribe_frames():
-    global frames
-    if not frames:
-        return ""
-    # Write to temp wav
-    fd, tmp_path = tempfile.mkstemp(suffix=".wav")
-    os.close(fd)
-    try:
-        wf = wave.open(tmp_path, 'wb')
-        wf.setnchannels(CHANNELS)
-        wf.setsampwidth(audio.get_sample_size(FORMAT))
-        wf.setframerate(RATE)
-        wf.writeframes(b''.join(frames))
-        wf.close()
-
-        # Use optimal transcription parameters for maximum accuracy
-        # beam_size=5: Balance between speed and accuracy (higher = more accurate but slower)
-        # temperature=0: Deterministic results (no randomness)
-        # best_of=5: Generate 5 candidates and pick best (better quality)
-        # vad_filter=True: Voice Activity Detection removes silence for better accuracy
-        segments, _ = model.transcribe(
-            tmp_path,
-            beam_size=5,
-            temperature=0,
-            best_of=5,
-            vad_filter=True,
-            vad_parameters=dict(min_silence_duration_ms=500)
-        )
-        text = "".join([seg.text for seg in segments]).strip()
+def options_for(role):
+    """Decode settings for a role; partials get the governor's beam width."""
+    profile = DECODE_PROFILES[decode_profiles[role]]
+    if role == "partial":
+        return decode_options(decode_profiles[role], governor.beam(profile["beam_size"]))
+    return decode_options(decode_profiles[role])
+
+
+def observe_decode(role, samples, options, started):
+    if role == "partial":
+        governor.observe(samples.size / RATE, time.time() - started, options["beam_size"])
+
+
+def transcribe_audio(samples, role="final", segments_out=None):
+    """Transcribe a float32 mono 16 kHz array in memory.
+
+    With ``segments_out``, appends ``{"text", "start_ms", "end_ms"}`` per segment
+    (times relative to ``samples``).
+    """
+    # Finals default to beam_size=5/best_of=5 with VAD; partials to a cheaper profile
+    options = options_for(role)
+    started = time.time()
+    segments, _ = model_for(role).transcribe(samples, **options)
+    parts = []
+    for seg in segments:
+        parts.append(seg.text)
+        if segments_out is not None:
+            segments_out.append({"text": seg.text.strip(), "start_ms": round(seg.start * 1000),
+                                 "end_ms": round(seg.end * 1000)})
+        # Segments decode lazily: give a waiting final the chance to preempt us
+        inference.check_preempted()
+    observe_decode(role, samples, options, started)
+    return "".join(parts).strip()
+
+
+def transcribe_words(samples, prompt=None, role="final"):
+    """Transcribe with word timestamps for the streaming decoder: [(word, start_s, end_s), ...]"""
+    options = options_for(role)
+    started = time.time()
+    segments, _ = model_for(role).transcribe(
+        samples,
+        word_timestamps=True,
+        initial_prompt=prompt,
+        condition_on_previous_text=False,
+        **options
+    )
+    words = []
+    for seg in segments:
+        for w in (seg.words or []):
+            words.append((w.word, w.start, w.end))
+        inference.check_preempted()
+    observe_decode(role, samples, options, started)
+    return words
+
+
+streamer = LocalAgreementDecoder(
+    lambda samples, prompt: transcribe_words(samples, prompt, role="partial"),
+    RATE,
+    final_transcribe=transcribe_words
+)
+
+
+def final_transcript(meta=None):
+    """Final text for the utterance that just ended, decoded ahead of any partial.
+
+    ``meta`` (optional dict) receives the segment list and decode timestamps.
+    """
+    segments = []
+
+    def decode_final(job):
+        utterance_times["decode_start"] = monotonic_ms()
+        if decoder_mode == "streaming" and draft_model is None:
+            # Only the audio after the committed prefix is decoded again
+            text = streamer.finish(pcm_ring.span_since)
+            start = pcm_ring.recording_start
+            segments.extend(
+                {"text": word.strip(), "start_ms": round((begin - start) * 1000 / RATE),
+                 "end_ms": round((end - start) * 1000 / RATE)}
+                for word, begin, end in streamer.committed_words
+            )
+            unit = "word"
+        else:
+            # In cascade mode the committed prefix came from the draft model, so the
+            # final model decodes the whole recording
+            text = transcribe_frames(segments)
+            unit = "segment"
+        utterance_times["decode_end"] = monotonic_ms()
+        if meta is not None:
+            meta["segments"] = segments
+            meta["segment_unit"] = unit
+            meta["decoder"] = decoder_mode
+            meta["model"] = model_size
         return text
-    finally:
-        try:
-            os.remove(tmp_path)
-        except Exception:
-            pass
+    return inference.run(PRIORITY_FINAL, decode_final)
 
-def transcribe_recent_seconds(local_frames, seconds=3):
-    if not local_frames:
-        return ""
-    # number of chunks to use from tail
-    chunks_per_sec = int(RATE / CHUNK)  # ~15
-    use_chunks = max(1, min(len(local_frames), seconds * chunks_per_sec))
-    tail = local_frames[-use_chunks:]
-    fd, tmp_path = tempfile.mkstemp(suffix=".wav")
-    os.close(fd)
-    try:
-        wf = wave.open(tmp_path, 'wb')
-        wf.setnchannels(CHANNELS)
-        wf.setsampwidth(audio.get_sample_size(FORMAT))
-        wf.setframerate(RATE)
-        wf.writeframes(b''.join(tail))
-        wf.close()
-        # Use same optimal parameters for partials as final transcription
-        # This ensures consistency and accuracy
-        segments, _ = model.transcribe(
-            tmp_path,
-            beam_size=5,
-            temperature=0,
-            best_of=5,
-            vad_filter=True,
-            vad_parameters=dict(min_silence_duration_ms=500)
-        )
-        text = "".join([seg.text for seg in segments]).strip()
+
+def timed_words_ms(words, origin):
+    """``[word, start_ms, end_ms]`` from the recording start, for main.js to align corrections."""
+    return [[text.strip(), (begin - origin) * 1000 // RATE, (end - origin) * 1000 // RATE]
+            for text, begin, end in words if text.strip()]
+
+
+def partial_job(utterance):
+    """Decode a live partial; dropped if the utterance ended or a newer partial replaced it."""
+    def decode_partial(job):
+        decode_start = monotonic_ms()
+        words = None
+        if decoder_mode == "streaming":
+            # Decode only the uncommitted tail; show committed + tentative words
+            committed, tentative = streamer.update(pcm_ring.span_since)
+            text = f"{committed} {tentative}".strip()
+            words = timed_words_ms(streamer.timed_words(), pcm_ring.recording_start)
+        else:
+            # For hold mode, use recent seconds for live preview
+            # For toggle mode, also generate partials for live preview
+            text = transcribe_recent_seconds(seconds=governor.window_seconds, role="partial")
+        with lock:
+            if job.cancelled or not recording_flag or utterance != utterance_id:
+                return None
+            if not text or text == last_partial_text:
+                return None
+            globals()['last_partial_text'] = text
+            request_id = utterance_request_id
+        extra = {"words": words} if words else {}
+        ipc.partial(text, request_id=request_id, utterance=utterance,
+                    decode_ms=round(monotonic_ms() - decode_start, 1), **extra)
         return text
-    finally:
-        try:
-            os.remove(tmp_path)
-        except Exception:
-            pass
+    return decode_partial
+
+
+def warm_up_model(job):
+    """Run one tiny decode at background priority so the first dictation skips lazy init."""
+    segments, _ = model.transcribe(np.zeros(RATE, dtype=np.float32), beam_size=1, vad_filter=False)
+    for _ in segments:
+        inference.check_preempted()
+
+
+inference = InferenceScheduler()
+
+
+def transcribe_frames(segments_out=None):
+    samples = pcm_ring.recording()
+    if samples.size == 0:
+        return ""
+    return transcribe_audio(samples, segments_out=segments_out)
+
+def transcribe_recent_seconds(seconds=3, role="final"):
+    # Tail of the ring as a view - no copy of the recording is made
+    samples = pcm_ring.tail(seconds)
+    if samples.size == 0:
+        return ""
+    return transcribe_audio(samples, role=role)
 
 
 def main():
@@ -266,7 +646,8 @@ def main():
         # Pre-initialize audio stream on startup for instant dictation (like Wispr Flow)
         # This ensures zero delay when user presses hotkey
         start_stream()
-        t = threading.Thread(target=audio_capture_loop, daemon=True)
+        capture_loop = release_watch_loop if CAPTURE_MODE == "callback" else audio_capture_loop
+        t = threading.Thread(target=capture_loop, daemon=True)
         t.start()
     except Exception as e:
         sys.stderr.write(f"Failed to start audio stream: {e}\n")
@@ -275,43 +656,41 @@ def main():
 
     def live_transcribe_loop():
         while True:
-            time.sleep(1.2)
+            # Idle until a recording starts, then tick at the governor's cadence (STOP wakes us early)
+            with recording_changed:
+                while not recording_flag:
+                    recording_changed.wait()
+                recording_changed.wait(timeout=governor.cadence())
             try:
                 with lock:
                     active = recording_flag
-                    hm = hold_mode
-                    local_frames = list(frames)
-                    prev = last_partial_text
+                    utterance = utterance_id
                 # CRITICAL: Generate partials for BOTH hold and toggle modes for consistency
-                # Use more audio (5 seconds instead of 3) for better accuracy
-                if active and len(local_frames) > 20:  # Need at least 20 chunks (~1.3 seconds)
-                    # For hold mode, use recent seconds for live preview
-                    # For toggle mode, also generate partials for live preview
-                    text = transcribe_recent_seconds(local_frames, seconds=5)  # Increased from 3 to 5 for better accuracy
-                    if text and text != prev:
-                        with lock:
-                            globals()['last_partial_text'] = text
-                        sys.stdout.write("PARTIAL: " + text + "\n")
-                        sys.stdout.flush()
+                if active and not output_busy and pcm_ring.recording_length() > 20 * CHUNK:  # Need at least 20 chunks (~1.3 seconds)
+                    # Queued, not awaited: if decoding falls behind, the newest partial replaces the queued one
+                    inference.submit(PRIORITY_PARTIAL, partial_job(utterance), key="partial")
             except Exception:
                 pass
 
     threading.Thread(target=live_transcribe_loop, daemon=True).start()
+    # Runs only while idle; a final submitted meanwhile preempts it
+    inference.submit(PRIORITY_BACKGROUND, warm_up_model)
+    if cascade_requested:
+        set_cascade(True)
 
-    for line in sys.stdin:
+    for line, request_id in read_commands(IPC_FRAMED):
         cmd = line.strip().upper()
-        if cmd == "START":
-            # Ensure stream is started
-            start_stream()
-            with lock:
-                frames = []
-                globals()['frames'] = frames
-                globals()['recording_flag'] = True
-                globals()['last_partial_text'] = ""
+        if cmd == "START" or cmd.startswith("START "):
+            # Optional argument: Electron's hotkey timestamp (epoch ms) for latency reporting
+            hotkey_ms = None
+            try:
+                hotkey_ms = float(cmd.split(" ", 1)[1])
+            except (IndexError, ValueError):
+                pass
+            begin_recording(hotkey_ms, request_id)
             continue
         if cmd == "STOP":
-            with lock:
-                globals()['recording_flag'] = False
+            set_recording(False)
             # CRITICAL: For instant output (like Wispr Flow), send last partial IMMEDIATELY
             # This must happen before transcription to give instant feedback
             instant_partial = None
@@ -320,29 +699,78 @@ def main():
                     instant_partial = last_partial_text
                 if instant_partial and instant_partial.strip():
                     # Send partial IMMEDIATELY for instant typing (before transcription)
-                    sys.stdout.write(f"PARTIAL: {instant_partial}\n")
-                    sys.stdout.flush()
+                    ipc.partial(instant_partial, request_id=utterance_request_id,
+                                utterance=utterance_id, release=True)
             except Exception:
                 pass
             
-            # Transcribe final text in background (may take a moment)
-            # This happens after partial is sent for instant output
-            text = transcribe_frames()
-            # Fallback to last partial if final transcription is empty
-            if not text:
-                try:
+            # Transcribe final text (may take a moment); the partial above already went out.
+            # The final may be the same as the partial, that's fine
+            emit_final(request_id)
+            continue
+        if cmd.startswith("SET_PREROLL_MS"):
+            try:
+                value = int(float(cmd.split(" ", 1)[1]))
+                with recording_changed:
+                    globals()['preroll_ms'] = max(0, min(MAX_PREROLL_MS, value))
+                    recording_changed.notify_all()
+            except Exception as e:
+                sys.stderr.write(f"✗ Invalid pre-roll value: {e}\n")
+                sys.stderr.flush()
+            continue
+        if cmd.startswith("SET_DECODER"):
+            # e.g., SET_DECODER STREAMING or SET_DECODER WINDOW
+            try:
+                value = cmd.split(" ", 1)[1].strip().lower()
+                if value in ("streaming", "window"):
                     with lock:
-                        text = last_partial_text
-                except Exception:
-                    pass
-            with lock:
-                frames = []
-                globals()['frames'] = frames
-                globals()['last_partial_text'] = ""
-            if text:
-                # Send final transcription to Electron (may be same as partial, that's fine)
-                sys.stdout.write(text + "\n")
-                sys.stdout.flush()
+                        globals()['decoder_mode'] = value
+            except Exception:
+                pass
+            continue
+        if cmd.startswith("SET_PROFILE"):
+            # e.g., SET_PROFILE PARTIAL FAST or SET_PROFILE FINAL ACCURATE
+            try:
+                _, role, name = cmd.lower().split()
+                if role in decode_profiles and name in DECODE_PROFILES:
+                    with lock:
+                        decode_profiles[role] = name
+            except Exception:
+                pass
+            continue
+        if cmd.startswith("LOAD_MODEL"):
+            # e.g., LOAD_MODEL small - swaps the model without restarting the service
+            try:
+                name = line.strip().split(" ", 1)[1].strip()
+                if name:
+                    threading.Thread(target=load_model, args=(name,), daemon=True).start()
+            except Exception:
+                pass
+            continue
+        if cmd.startswith("SET_CASCADE"):
+            # e.g., SET_CASCADE ON or SET_CASCADE OFF
+            try:
+                value = cmd.split(" ", 1)[1].strip()
+                set_cascade(value in ("ON", "1", "TRUE"))
+            except Exception:
+                pass
+            continue
+        if cmd.startswith("SET_GOVERNOR"):
+            # e.g., SET_GOVERNOR ON or SET_GOVERNOR OFF
+            try:
+                value = cmd.split(" ", 1)[1].strip()
+                governor.enabled = value in ("ON", "1", "TRUE")
+            except Exception:
+                pass
+            continue
+        if cmd.startswith("SET_OUTPUT_BUSY"):
+            # e.g., SET_OUTPUT_BUSY ON while main.js still has text waiting to be typed
+            try:
+                value = cmd.split(" ", 1)[1].strip()
+                with lock:
+                    globals()['output_busy'] = value in ("ON", "1", "TRUE")
+            except Exception:
+                pass
             continue
         if cmd.startswith("SET_MODE"):
             # e.g., SET_MODE HOLD or SET_MODE TOGGLE